@@ -70,9 +70,10 @@ public:
 
     /**
      * @brief getFileName returns the loaded script file name
-     * @return the script file name
+     * @return the script file name, which lives as long as the plug-in
+     * (e.g. it can be given as the source file of the checks)
      */
-    std::string getFileName();
+    const std::string& getFileName();
 
     /**
      * @brief setTestName set the test case name
@@ -99,6 +100,11 @@ private:
     static int testReport(lua_State* L);
     static int testFail(lua_State* L);
     static int testCheck(lua_State* L);
+    static int testCheckArrayNear(lua_State* L);
+    static int testCheckArrayUlp(lua_State* L);
+    static int testCheckArrayNorm(lua_State* L);
+    static int testCheckArrayDistance(lua_State* L);
+    static int testCheckArrayFinite(lua_State* L);
     static int getTestEnvironment(lua_State* L);
 
 private:
@@ -19,12 +19,15 @@
  */
 
 
+#include <robottestingframework/ArrayCheck.h>
 #include <robottestingframework/Asserter.h>
 #include <robottestingframework/TestAssert.h>
 #include <robottestingframework/dll/Plugin.h>
 #include <robottestingframework/lua/LuaPluginLoader.h>
 #include <robottestingframework/lua/impl/LuaPluginLoader_impl.h>
 
+#include <vector>
+
 using namespace std;
 using namespace robottestingframework;
 using namespace robottestingframework::plugin;
@@ -50,6 +53,11 @@ const struct luaL_reg LuaPluginLoaderImpl::luaPluginLib[] = {
     { "testReport", LuaPluginLoaderImpl::testReport },
     { "testFail", LuaPluginLoaderImpl::testFail },
     { "testCheck", LuaPluginLoaderImpl::testCheck },
+    { "testCheckArrayNear", LuaPluginLoaderImpl::testCheckArrayNear },
+    { "testCheckArrayUlp", LuaPluginLoaderImpl::testCheckArrayUlp },
+    { "testCheckArrayNorm", LuaPluginLoaderImpl::testCheckArrayNorm },
+    { "testCheckArrayDistance", LuaPluginLoaderImpl::testCheckArrayDistance },
+    { "testCheckArrayFinite", LuaPluginLoaderImpl::testCheckArrayFinite },
     { "getEnvironment", LuaPluginLoaderImpl::getTestEnvironment },
     { nullptr, nullptr }
 };
@@ -154,7 +162,7 @@ std::string LuaPluginLoaderImpl::getLastError()
     return error;
 }
 
-std::string LuaPluginLoaderImpl::getFileName()
+const std::string& LuaPluginLoaderImpl::getFileName()
 {
     return filename;
 }
@@ -343,6 +351,101 @@ int LuaPluginLoaderImpl::testCheck(lua_State* L)
     return 0;
 }
 
+/**
+ * Returns the TestCase which runs the lua script.
+ */
+static LuaPluginLoaderImpl* script_owner(lua_State* L)
+{
+    lua_getglobal(L, "TestCase_Owner");
+    if (!lua_islightuserdata(L, -1)) {
+        lua_pop(L, 1);
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("Cannot get TestCase_Owner");
+    }
+    auto* owner = static_cast<LuaPluginLoaderImpl*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(owner != nullptr, "A null instance of TestCase_Owner");
+    return owner;
+}
+
+/**
+ * Copies the array of numbers at the given index of the stack.
+ */
+static std::vector<double> script_array(lua_State* L, int index)
+{
+    luaL_checktype(L, index, LUA_TTABLE);
+#if LUA_VERSION_NUM > 501
+    size_t size = lua_rawlen(L, index);
+#else
+    size_t size = lua_objlen(L, index);
+#endif
+    std::vector<double> values(size);
+    for (size_t i = 0; i < size; i++) {
+        lua_rawgeti(L, index, static_cast<int>(i + 1));
+        values[i] = lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+    return values;
+}
+
+static void check_script_array(lua_State* L, const ArrayCheck& check, const char* summary, const char* message)
+{
+    LuaPluginLoaderImpl* owner = script_owner(L);
+    Asserter::testArray(check, summary, [&]() { return std::string(message); },
+                        owner->getFileName().c_str(), 0, static_cast<TestCase*>(owner));
+}
+
+int LuaPluginLoaderImpl::testCheckArrayNear(lua_State* L)
+{
+    std::vector<double> actual = script_array(L, 1);
+    std::vector<double> expected = script_array(L, 2);
+    double absTolerance = luaL_checknumber(L, 3);
+    double relTolerance = luaL_checknumber(L, 4);
+    const char* message = luaL_checkstring(L, 5);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(actual.size() == expected.size(), "testCheckArrayNear called with arrays of different sizes");
+    check_script_array(L, ArrayCheck::closeTo(actual.data(), expected.data(), actual.size(), absTolerance, relTolerance), "checking array near", message);
+    return 0;
+}
+
+int LuaPluginLoaderImpl::testCheckArrayUlp(lua_State* L)
+{
+    std::vector<double> actual = script_array(L, 1);
+    std::vector<double> expected = script_array(L, 2);
+    auto maxUlps = static_cast<uint64_t>(luaL_checknumber(L, 3));
+    const char* message = luaL_checkstring(L, 4);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(actual.size() == expected.size(), "testCheckArrayUlp called with arrays of different sizes");
+    check_script_array(L, ArrayCheck::withinUlps(actual.data(), expected.data(), actual.size(), maxUlps), "checking array ulp", message);
+    return 0;
+}
+
+int LuaPluginLoaderImpl::testCheckArrayNorm(lua_State* L)
+{
+    std::vector<double> values = script_array(L, 1);
+    double minNorm = luaL_checknumber(L, 2);
+    double maxNorm = luaL_checknumber(L, 3);
+    const char* message = luaL_checkstring(L, 4);
+    check_script_array(L, ArrayCheck::normWithin(values.data(), values.size(), minNorm, maxNorm), "checking array norm", message);
+    return 0;
+}
+
+int LuaPluginLoaderImpl::testCheckArrayDistance(lua_State* L)
+{
+    std::vector<double> actual = script_array(L, 1);
+    std::vector<double> expected = script_array(L, 2);
+    double maxNorm = luaL_checknumber(L, 3);
+    const char* message = luaL_checkstring(L, 4);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(actual.size() == expected.size(), "testCheckArrayDistance called with arrays of different sizes");
+    check_script_array(L, ArrayCheck::distanceWithin(actual.data(), expected.data(), actual.size(), maxNorm), "checking array distance", message);
+    return 0;
+}
+
+int LuaPluginLoaderImpl::testCheckArrayFinite(lua_State* L)
+{
+    std::vector<double> values = script_array(L, 1);
+    const char* message = luaL_checkstring(L, 2);
+    check_script_array(L, ArrayCheck::allFinite(values.data(), values.size()), "checking array finite", message);
+    return 0;
+}
+
 int LuaPluginLoaderImpl::getTestEnvironment(lua_State* L)
 {
     lua_getglobal(L, "TestCase_Owner");
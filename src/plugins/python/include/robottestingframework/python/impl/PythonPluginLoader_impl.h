@@ -70,9 +70,10 @@ public:
 
     /**
      * @brief getFileName returns the loaded script file name
-     * @return the script file name
+     * @return the script file name, which lives as long as the plug-in
+     * (e.g. it can be given as the source file of the checks)
      */
-    std::string getFileName();
+    const std::string& getFileName();
 
     /**
      * @brief setTestName set the test case name
@@ -92,6 +93,11 @@ public:
     static PyObject* assertFail(PyObject* self, PyObject* args);
     static PyObject* testReport(PyObject* self, PyObject* args);
     static PyObject* testCheck(PyObject* self, PyObject* args);
+    static PyObject* testCheckArrayNear(PyObject* self, PyObject* args);
+    static PyObject* testCheckArrayUlp(PyObject* self, PyObject* args);
+    static PyObject* testCheckArrayNorm(PyObject* self, PyObject* args);
+    static PyObject* testCheckArrayDistance(PyObject* self, PyObject* args);
+    static PyObject* testCheckArrayFinite(PyObject* self, PyObject* args);
 
     static PyMethodDef testPythonMethods[];
 
@@ -21,6 +21,8 @@ Example::
             robottestingframework.testReport("Done.")
 """
 
+from typing import Sequence
+
 def setName(name: str) -> None:
     """Set the test case name reported by the framework.
 
@@ -70,3 +72,69 @@ def testCheck(condition: bool, message: str) -> None:
         message:   Description shown in the report for this check.
     """
     ...
+
+def testCheckArrayNear(actual: Sequence[float], expected: Sequence[float],
+                       abs_tolerance: float, rel_tolerance: float, message: str) -> None:
+    """Check that each actual value is close to the expected one.
+
+    A value is close if ``|actual - expected| <= abs_tolerance +
+    rel_tolerance * |expected|``. All the mismatches are reported in one
+    failure with their count, the worst and the first ones. Contiguous
+    buffers of floats or doubles (e.g. numpy arrays) are checked in place.
+
+    Args:
+        actual:        The actual values.
+        expected:      The expected values (of the same length).
+        abs_tolerance: The absolute tolerance.
+        rel_tolerance: The tolerance relative to the expected values.
+        message:       Description shown in the report for this check.
+    """
+    ...
+
+def testCheckArrayUlp(actual: Sequence[float], expected: Sequence[float],
+                      max_ulps: int, message: str) -> None:
+    """Check that each actual value is within ``max_ulps`` units in the
+    last place from the expected one.
+
+    Args:
+        actual:   The actual values.
+        expected: The expected values (of the same length).
+        max_ulps: The maximum distance in units in the last place.
+        message:  Description shown in the report for this check.
+    """
+    ...
+
+def testCheckArrayNorm(values: Sequence[float], min_norm: float, max_norm: float,
+                       message: str) -> None:
+    """Check that the euclidean norm of the values is within
+    ``[min_norm, max_norm]``.
+
+    Args:
+        values:   The values.
+        min_norm: The minimum norm.
+        max_norm: The maximum norm.
+        message:  Description shown in the report for this check.
+    """
+    ...
+
+def testCheckArrayDistance(actual: Sequence[float], expected: Sequence[float],
+                           max_norm: float, message: str) -> None:
+    """Check that the euclidean norm of ``actual - expected`` is not greater
+    than ``max_norm``.
+
+    Args:
+        actual:   The actual values.
+        expected: The expected values (of the same length).
+        max_norm: The maximum norm of the difference.
+        message:  Description shown in the report for this check.
+    """
+    ...
+
+def testCheckArrayFinite(values: Sequence[float], message: str) -> None:
+    """Check that all the values are finite (neither infinite nor NaN).
+
+    Args:
+        values:  The values.
+        message: Description shown in the report for this check.
+    """
+    ...
@@ -19,6 +19,7 @@
  */
 
 
+#include <robottestingframework/ArrayCheck.h>
 #include <robottestingframework/Asserter.h>
 #include <robottestingframework/TestAssert.h>
 #include <robottestingframework/dll/Plugin.h>
@@ -31,6 +32,9 @@
 #    include <libgen.h>
 #endif
 
+#include <cstring>
+#include <vector>
+
 using namespace std;
 using namespace robottestingframework;
 using namespace robottestingframework::plugin;
@@ -71,10 +75,121 @@ PyMethodDef PythonPluginLoaderImpl::testPythonMethods[] = {
     { "assertFail", PythonPluginLoaderImpl::assertFail, METH_VARARGS, "Failure assertion." },
     { "testReport", PythonPluginLoaderImpl::testReport, METH_VARARGS, "report a test message." },
     { "testCheck",  PythonPluginLoaderImpl::testCheck,  METH_VARARGS, "report failure message with condition." },
+    { "testCheckArrayNear", PythonPluginLoaderImpl::testCheckArrayNear, METH_VARARGS, "check that two arrays are close within tolerances." },
+    { "testCheckArrayUlp", PythonPluginLoaderImpl::testCheckArrayUlp, METH_VARARGS, "check the ULP distance of two arrays." },
+    { "testCheckArrayNorm", PythonPluginLoaderImpl::testCheckArrayNorm, METH_VARARGS, "check the norm of an array." },
+    { "testCheckArrayDistance", PythonPluginLoaderImpl::testCheckArrayDistance, METH_VARARGS, "check the distance of two arrays." },
+    { "testCheckArrayFinite", PythonPluginLoaderImpl::testCheckArrayFinite, METH_VARARGS, "check that all the values of an array are finite." },
     { nullptr, nullptr, 0, nullptr }
 };
 
 
+// ---------------------------------------------------------------------------
+// Numeric arrays of the array checks
+// ---------------------------------------------------------------------------
+
+namespace {
+
+/**
+ * A numeric array passed to the array checks. A contiguous buffer of floats
+ * or doubles (e.g., a numpy array or an array.array) is checked in place;
+ * any other sequence of numbers is copied to doubles.
+ */
+class PyArray
+{
+public:
+    PyArray() :
+            hasView(false),
+            data(nullptr),
+            length(0),
+            isFloat(false)
+    {
+    }
+
+    ~PyArray()
+    {
+        if (hasView) {
+            PyBuffer_Release(&view);
+        }
+    }
+
+    PyArray(const PyArray&) = delete;
+    PyArray& operator=(const PyArray&) = delete;
+
+    bool parse(PyObject* object)
+    {
+        if (PyObject_CheckBuffer(object) && PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+            hasView = true;
+            const char* format = (view.format != nullptr) ? view.format : "B";
+            if (format[0] == '@' || format[0] == '=') {
+                format++;
+            }
+            if ((strcmp(format, "d") == 0 || strcmp(format, "f") == 0) && view.ndim <= 1) {
+                isFloat = (format[0] == 'f');
+                data = view.buf;
+                length = static_cast<size_t>(view.len / view.itemsize);
+                return true;
+            }
+            PyBuffer_Release(&view);
+            hasView = false;
+        }
+        PyObject* sequence = PySequence_Fast(object, "an array of numbers is expected");
+        if (sequence == nullptr) {
+            PyErr_Clear();
+            return false;
+        }
+        length = static_cast<size_t>(PySequence_Fast_GET_SIZE(sequence));
+        copy.resize(length);
+        for (size_t i = 0; i < length; i++) {
+            copy[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(sequence, i));
+        }
+        Py_DECREF(sequence);
+        if (PyErr_Occurred() != nullptr) {
+            PyErr_Clear();
+            return false;
+        }
+        data = copy.data();
+        return true;
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+    bool floats() const
+    {
+        return isFloat;
+    }
+
+    const float* asFloats() const
+    {
+        return static_cast<const float*>(data);
+    }
+
+    // the floats are converted when they are checked against doubles
+    const double* asDoubles()
+    {
+        if (isFloat) {
+            copy.assign(asFloats(), asFloats() + length);
+            data = copy.data();
+            isFloat = false;
+        }
+        return static_cast<const double*>(data);
+    }
+
+private:
+    Py_buffer view;
+    bool hasView;
+    const void* data;
+    size_t length;
+    bool isFloat;
+    std::vector<double> copy;
+};
+
+} // namespace
+
+
 // ---------------------------------------------------------------------------
 // PythonPluginLoaderImpl
 // ---------------------------------------------------------------------------
@@ -377,7 +492,7 @@ std::string PythonPluginLoaderImpl::getLastError()
     return error;
 }
 
-std::string PythonPluginLoaderImpl::getFileName()
+const std::string& PythonPluginLoaderImpl::getFileName()
 {
     return filename;
 }
@@ -559,6 +674,121 @@ PyObject* PythonPluginLoaderImpl::testCheck(PyObject* self, PyObject* args)
     Py_RETURN_NONE;
 }
 
+PyObject* PythonPluginLoaderImpl::testCheckArrayNear(PyObject* self, PyObject* args)
+{
+    const char* message = nullptr;
+    PyObject* pyActual = nullptr;
+    PyObject* pyExpected = nullptr;
+    double absTolerance = 0;
+    double relTolerance = 0;
+    PyArray actual;
+    PyArray expected;
+    auto* impl = getImpl(self);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl != nullptr,
+        "testCheckArrayNear cannot find the instance of PythonPluginLoaderImpl");
+    if (!PyArg_ParseTuple(args, "OOdds", &pyActual, &pyExpected, &absTolerance, &relTolerance, &message)
+        || !actual.parse(pyActual) || !expected.parse(pyExpected) || actual.size() != expected.size()) {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(
+            Asserter::format("testCheckArrayNear() called with wrong parameters."));
+    }
+    ArrayCheck check = (actual.floats() && expected.floats())
+        ? ArrayCheck::closeTo(actual.asFloats(), expected.asFloats(), actual.size(), absTolerance, relTolerance)
+        : ArrayCheck::closeTo(actual.asDoubles(), expected.asDoubles(), actual.size(), absTolerance, relTolerance);
+    Asserter::testArray(check, "checking array near", [&]() { return std::string(message); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+    Py_RETURN_NONE;
+}
+
+PyObject* PythonPluginLoaderImpl::testCheckArrayUlp(PyObject* self, PyObject* args)
+{
+    const char* message = nullptr;
+    PyObject* pyActual = nullptr;
+    PyObject* pyExpected = nullptr;
+    unsigned long long maxUlps = 0;
+    PyArray actual;
+    PyArray expected;
+    auto* impl = getImpl(self);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl != nullptr,
+        "testCheckArrayUlp cannot find the instance of PythonPluginLoaderImpl");
+    if (!PyArg_ParseTuple(args, "OOKs", &pyActual, &pyExpected, &maxUlps, &message)
+        || !actual.parse(pyActual) || !expected.parse(pyExpected) || actual.size() != expected.size()) {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(
+            Asserter::format("testCheckArrayUlp() called with wrong parameters."));
+    }
+    ArrayCheck check = (actual.floats() && expected.floats())
+        ? ArrayCheck::withinUlps(actual.asFloats(), expected.asFloats(), actual.size(), maxUlps)
+        : ArrayCheck::withinUlps(actual.asDoubles(), expected.asDoubles(), actual.size(), maxUlps);
+    Asserter::testArray(check, "checking array ulp", [&]() { return std::string(message); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+    Py_RETURN_NONE;
+}
+
+PyObject* PythonPluginLoaderImpl::testCheckArrayNorm(PyObject* self, PyObject* args)
+{
+    const char* message = nullptr;
+    PyObject* pyValues = nullptr;
+    double minNorm = 0;
+    double maxNorm = 0;
+    PyArray values;
+    auto* impl = getImpl(self);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl != nullptr,
+        "testCheckArrayNorm cannot find the instance of PythonPluginLoaderImpl");
+    if (!PyArg_ParseTuple(args, "Odds", &pyValues, &minNorm, &maxNorm, &message) || !values.parse(pyValues)) {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(
+            Asserter::format("testCheckArrayNorm() called with wrong parameters."));
+    }
+    ArrayCheck check = values.floats()
+        ? ArrayCheck::normWithin(values.asFloats(), values.size(), minNorm, maxNorm)
+        : ArrayCheck::normWithin(values.asDoubles(), values.size(), minNorm, maxNorm);
+    Asserter::testArray(check, "checking array norm", [&]() { return std::string(message); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+    Py_RETURN_NONE;
+}
+
+PyObject* PythonPluginLoaderImpl::testCheckArrayDistance(PyObject* self, PyObject* args)
+{
+    const char* message = nullptr;
+    PyObject* pyActual = nullptr;
+    PyObject* pyExpected = nullptr;
+    double maxNorm = 0;
+    PyArray actual;
+    PyArray expected;
+    auto* impl = getImpl(self);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl != nullptr,
+        "testCheckArrayDistance cannot find the instance of PythonPluginLoaderImpl");
+    if (!PyArg_ParseTuple(args, "OOds", &pyActual, &pyExpected, &maxNorm, &message)
+        || !actual.parse(pyActual) || !expected.parse(pyExpected) || actual.size() != expected.size()) {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(
+            Asserter::format("testCheckArrayDistance() called with wrong parameters."));
+    }
+    ArrayCheck check = (actual.floats() && expected.floats())
+        ? ArrayCheck::distanceWithin(actual.asFloats(), expected.asFloats(), actual.size(), maxNorm)
+        : ArrayCheck::distanceWithin(actual.asDoubles(), expected.asDoubles(), actual.size(), maxNorm);
+    Asserter::testArray(check, "checking array distance", [&]() { return std::string(message); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+    Py_RETURN_NONE;
+}
+
+PyObject* PythonPluginLoaderImpl::testCheckArrayFinite(PyObject* self, PyObject* args)
+{
+    const char* message = nullptr;
+    PyObject* pyValues = nullptr;
+    PyArray values;
+    auto* impl = getImpl(self);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl != nullptr,
+        "testCheckArrayFinite cannot find the instance of PythonPluginLoaderImpl");
+    if (!PyArg_ParseTuple(args, "Os", &pyValues, &message) || !values.parse(pyValues)) {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR(
+            Asserter::format("testCheckArrayFinite() called with wrong parameters."));
+    }
+    ArrayCheck check = values.floats()
+        ? ArrayCheck::allFinite(values.asFloats(), values.size())
+        : ArrayCheck::allFinite(values.asDoubles(), values.size());
+    Asserter::testArray(check, "checking array finite", [&]() { return std::string(message); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+    Py_RETURN_NONE;
+}
+
 
 // ---------------------------------------------------------------------------
 // PythonPluginLoader (pimpl wrapper)
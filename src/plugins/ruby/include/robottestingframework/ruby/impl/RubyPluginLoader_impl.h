@@ -70,9 +70,10 @@ public:
 
     /**
      * @brief getFileName returns the loaded script file name
-     * @return the script file name
+     * @return the script file name, which lives as long as the plug-in
+     * (e.g. it can be given as the source file of the checks)
      */
-    std::string getFileName();
+    const std::string& getFileName();
 
     /**
      * @brief setTestName set the test case name
@@ -106,9 +107,16 @@ private:
     static VALUE assertFail(VALUE self, VALUE obj);
     static VALUE testReport(VALUE self, VALUE obj);
     static VALUE testCheck(VALUE self, VALUE cond, VALUE message);
+    static VALUE testCheckArrayNear(VALUE self, VALUE actual, VALUE expected, VALUE absTolerance, VALUE relTolerance, VALUE message);
+    static VALUE testCheckArrayUlp(VALUE self, VALUE actual, VALUE expected, VALUE maxUlps, VALUE message);
+    static VALUE testCheckArrayNorm(VALUE self, VALUE values, VALUE minNorm, VALUE maxNorm, VALUE message);
+    static VALUE testCheckArrayDistance(VALUE self, VALUE actual, VALUE expected, VALUE maxNorm, VALUE message);
+    static VALUE testCheckArrayFinite(VALUE self, VALUE values, VALUE message);
 
 private:
     std::string filename;
+    // the base name of filename, returned by getFileName()
+    std::string basename;
     std::string error;
     VALUE testcase;
     VALUE RobotTestingFrameworkModule;
@@ -19,12 +19,15 @@
  */
 
 
+#include <robottestingframework/ArrayCheck.h>
 #include <robottestingframework/Asserter.h>
 #include <robottestingframework/TestAssert.h>
 #include <robottestingframework/dll/Plugin.h>
 #include <robottestingframework/ruby/RubyPluginLoader.h>
 #include <robottestingframework/ruby/impl/RubyPluginLoader_impl.h>
 
+#include <vector>
+
 using namespace std;
 using namespace robottestingframework;
 using namespace robottestingframework::plugin;
@@ -122,10 +125,10 @@ VALUE RubyPluginLoaderImpl::protectedTearDown(VALUE testcase, ID id, RubyPluginL
 TestCase* RubyPluginLoaderImpl::open(const std::string filename)
 {
     this->filename = filename;
-    string bname = extractFileName(filename);
+    basename = extractFileName(filename);
     RUBY_INIT_STACK;
     ruby_init();
-    ruby_script(bname.c_str());
+    ruby_script(basename.c_str());
     ruby_init_loadpath();
 
     // add robottestingframework module functions
@@ -135,6 +138,11 @@ TestCase* RubyPluginLoaderImpl::open(const std::string filename)
     rb_define_module_function(RobotTestingFrameworkModule, "assertFail", (VALUE(*)(...))RubyPluginLoaderImpl::assertFail, 1);
     rb_define_module_function(RobotTestingFrameworkModule, "testReport", (VALUE(*)(...))RubyPluginLoaderImpl::testReport, 1);
     rb_define_module_function(RobotTestingFrameworkModule, "testCheck", (VALUE(*)(...))RubyPluginLoaderImpl::testCheck, 2);
+    rb_define_module_function(RobotTestingFrameworkModule, "testCheckArrayNear", (VALUE(*)(...))RubyPluginLoaderImpl::testCheckArrayNear, 5);
+    rb_define_module_function(RobotTestingFrameworkModule, "testCheckArrayUlp", (VALUE(*)(...))RubyPluginLoaderImpl::testCheckArrayUlp, 4);
+    rb_define_module_function(RobotTestingFrameworkModule, "testCheckArrayNorm", (VALUE(*)(...))RubyPluginLoaderImpl::testCheckArrayNorm, 4);
+    rb_define_module_function(RobotTestingFrameworkModule, "testCheckArrayDistance", (VALUE(*)(...))RubyPluginLoaderImpl::testCheckArrayDistance, 4);
+    rb_define_module_function(RobotTestingFrameworkModule, "testCheckArrayFinite", (VALUE(*)(...))RubyPluginLoaderImpl::testCheckArrayFinite, 2);
 
     // load the ruby script
     int state = 0;
@@ -152,7 +160,7 @@ TestCase* RubyPluginLoaderImpl::open(const std::string filename)
     rb_define_const(cls, "TESTCASE_IMPL", Data_Wrap_Struct(cls, 0, 0, this));
     testcase = rb_class_new_instance(0, nullptr, cls);
 
-    setTestName(bname);
+    setTestName(basename);
     return this;
 }
 
@@ -166,9 +174,9 @@ std::string RubyPluginLoaderImpl::getLastError()
     return error;
 }
 
-std::string RubyPluginLoaderImpl::getFileName()
+const std::string& RubyPluginLoaderImpl::getFileName()
 {
-    return extractFileName(filename);
+    return basename;
 }
 
 //TODO: check the return value!!!
@@ -244,6 +252,69 @@ VALUE RubyPluginLoaderImpl::testCheck(VALUE self, VALUE cond, VALUE message)
 }
 
 
+/**
+ * Copies a ruby array of numbers.
+ */
+static std::vector<double> to_doubles(VALUE array)
+{
+    Check_Type(array, T_ARRAY);
+    std::vector<double> values(RARRAY_LEN(array));
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = NUM2DBL(rb_ary_entry(array, static_cast<long>(i)));
+    }
+    return values;
+}
+
+static void check_array(RubyPluginLoaderImpl* impl, const ArrayCheck& check, const char* summary, VALUE message)
+{
+    char* msg = StringValueCStr(message);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(impl, "error in RubyPluginLoaderImpl::getImpFromRuby()");
+    Asserter::testArray(check, summary, [&]() { return std::string(msg); },
+                        impl->getFileName().c_str(), 0, static_cast<TestCase*>(impl));
+}
+
+VALUE RubyPluginLoaderImpl::testCheckArrayNear(VALUE self, VALUE actual, VALUE expected, VALUE absTolerance, VALUE relTolerance, VALUE message)
+{
+    std::vector<double> a = to_doubles(actual);
+    std::vector<double> e = to_doubles(expected);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(a.size() == e.size(), "testCheckArrayNear called with arrays of different sizes");
+    check_array(getImpFromRuby(), ArrayCheck::closeTo(a.data(), e.data(), a.size(), NUM2DBL(absTolerance), NUM2DBL(relTolerance)), "checking array near", message);
+    return self;
+}
+
+VALUE RubyPluginLoaderImpl::testCheckArrayUlp(VALUE self, VALUE actual, VALUE expected, VALUE maxUlps, VALUE message)
+{
+    std::vector<double> a = to_doubles(actual);
+    std::vector<double> e = to_doubles(expected);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(a.size() == e.size(), "testCheckArrayUlp called with arrays of different sizes");
+    check_array(getImpFromRuby(), ArrayCheck::withinUlps(a.data(), e.data(), a.size(), NUM2ULL(maxUlps)), "checking array ulp", message);
+    return self;
+}
+
+VALUE RubyPluginLoaderImpl::testCheckArrayNorm(VALUE self, VALUE values, VALUE minNorm, VALUE maxNorm, VALUE message)
+{
+    std::vector<double> v = to_doubles(values);
+    check_array(getImpFromRuby(), ArrayCheck::normWithin(v.data(), v.size(), NUM2DBL(minNorm), NUM2DBL(maxNorm)), "checking array norm", message);
+    return self;
+}
+
+VALUE RubyPluginLoaderImpl::testCheckArrayDistance(VALUE self, VALUE actual, VALUE expected, VALUE maxNorm, VALUE message)
+{
+    std::vector<double> a = to_doubles(actual);
+    std::vector<double> e = to_doubles(expected);
+    ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(a.size() == e.size(), "testCheckArrayDistance called with arrays of different sizes");
+    check_array(getImpFromRuby(), ArrayCheck::distanceWithin(a.data(), e.data(), a.size(), NUM2DBL(maxNorm)), "checking array distance", message);
+    return self;
+}
+
+VALUE RubyPluginLoaderImpl::testCheckArrayFinite(VALUE self, VALUE values, VALUE message)
+{
+    std::vector<double> v = to_doubles(values);
+    check_array(getImpFromRuby(), ArrayCheck::allFinite(v.data(), v.size()), "checking array finite", message);
+    return self;
+}
+
+
 RubyPluginLoaderImpl* RubyPluginLoaderImpl::getImpFromRuby()
 {
     VALUE cls = rb_const_get(rb_cObject, rb_intern("TestCase"));
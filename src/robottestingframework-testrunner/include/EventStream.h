@@ -0,0 +1,321 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_EVENTSTREAM_H
+#define ROBOTTESTINGFRAMEWORK_EVENTSTREAM_H
+
+#include <robottestingframework/Test.h>
+#include <robottestingframework/TestListener.h>
+#include <robottestingframework/TestMessage.h>
+#include <robottestingframework/TestResult.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * \brief StreamEvent is a single test event as it is transferred
+ * between two processes by an EventStreamWriter and an EventStreamReader.
+ * The tests are identified by an opaque id which is unique within the
+ * writer process; their name and description are only transferred
+ * with the start events and their durations and statistics with
+ * the end events.
+ */
+struct StreamEvent
+{
+    enum Kind
+    {
+        Report = 1,
+        Error,
+        Failure,
+        StartTest,
+        EndTest,
+        StartSuite,
+        EndSuite,
+        Timeout
+    };
+
+    Kind kind;
+    uint64_t id;
+    bool succeeded;
+    std::string name;
+    std::string description;
+    TestMessage msg;
+    double elapsed;
+    double timestamp;
+    double duration;
+    Test::DurationContainer durations;
+    Test::StatisticContainer statistics;
+};
+
+
+/**
+ * \brief Class EventStreamWriter is a TestListener which encodes
+ * the test events and writes them to a file descriptor (e.g., a pipe).
+ * Every event is written with a single call, so that the stream stays
+ * consistent up to the last event if the writer process crashes.
+ */
+class EventStreamWriter : public TestListener
+{
+public:
+    /**
+     * @brief EventStreamWriter constructor
+     * @param fd the file descriptor to write to. It is not closed
+     * by the writer.
+     */
+    EventStreamWriter(int fd);
+
+    void addReport(const Test* test, TestMessage msg) override;
+    void addError(const Test* test, TestMessage msg) override;
+    void addFailure(const Test* test, TestMessage msg) override;
+    void addTimeout(const Test* test, TestMessage msg, double elapsed) override;
+    void startTest(const Test* test) override;
+    void endTest(const Test* test) override;
+    void startTestSuite(const Test* test) override;
+    void endTestSuite(const Test* test) override;
+
+private:
+    void write(StreamEvent::Kind kind,
+               const Test* test,
+               const TestMessage& msg = TestMessage(),
+               double elapsed = 0);
+
+private:
+    int fd;
+};
+
+
+/**
+ * \brief Class EventStreamReader decodes the test events written
+ * by an EventStreamWriter.
+ */
+class EventStreamReader
+{
+public:
+    /**
+     * @brief EventStreamReader constructor
+     * @param fd the file descriptor to read from. It is not closed
+     * by the reader.
+     */
+    EventStreamReader(int fd);
+
+    /**
+     * @brief read blocks until the next event is available
+     * @param event the decoded event
+     * @return false if the stream is closed or corrupted
+     */
+    bool read(StreamEvent& event);
+
+private:
+    int fd;
+};
+
+
+/**
+ * \brief RemoteTest stands for a test whose events are replayed from
+ * an event stream or log (e.g., a test created within the process of an
+ * isolated test). Its outcome, durations and statistics are updated by
+ * its end events.
+ */
+class RemoteTest : public Test
+{
+public:
+    RemoteTest(const std::string& name, const std::string& description);
+
+    void run(TestResult& result) override;
+
+    bool succeeded() const override;
+
+    /**
+     * @brief update sets the state of the test from an end event
+     * @param event the end event of the test
+     */
+    void update(const StreamEvent& event);
+
+private:
+    bool successful;
+};
+
+
+/**
+ * @brief replayEvent delivers a decoded event to a TestResult at the
+ * time at which it has been issued
+ * @param result the TestResult to deliver the event to
+ * @param test the test which stands for the one which issued the event
+ * @param event the decoded event
+ */
+void replayEvent(TestResult& result, Test* test, const StreamEvent& event);
+
+
+/**
+ * \brief Class EventLogWriter is a TestListener which records the test
+ * events in a compact binary log file (\c .rtfbin), so that they can be
+ * replayed later (see EventLogReader). The file starts with the \c RTFBIN
+ * magic and a version byte and it is followed by records prefixed by their
+ * length. The strings (names, messages, file names, ...) are interned: each
+ * one is written once in a string record and then referred to by its
+ * index. The integers are variable-length encoded and the timestamps are
+ * stored as differences (in microseconds) from the previous event.
+ *
+ * The records are only appended and the file is flushed at the end of each
+ * test, so that the log can be read up to the last finished test even if
+ * the run is killed.
+ */
+class EventLogWriter : public TestListener
+{
+public:
+    EventLogWriter();
+
+    ~EventLogWriter() override;
+
+    /**
+     * @brief open creates the log file
+     * @param filename the name of the file
+     * @param errorMsg a pointer to a TestMessage to return the error message
+     * in case of failure. It can be left unassigned if it is not required.
+     * @return true or false uppoun success or failure
+     */
+    bool open(const std::string& filename, TestMessage* errorMsg = nullptr);
+
+    /**
+     * @brief close flushes and closes the log file
+     */
+    void close();
+
+    void addReport(const Test* test, TestMessage msg) override;
+    void addError(const Test* test, TestMessage msg) override;
+    void addFailure(const Test* test, TestMessage msg) override;
+    void addTimeout(const Test* test, TestMessage msg, double elapsed) override;
+    void startTest(const Test* test) override;
+    void endTest(const Test* test) override;
+    void startTestSuite(const Test* test) override;
+    void endTestSuite(const Test* test) override;
+    void endTestRunner() override;
+
+private:
+    void write(StreamEvent::Kind kind,
+               const Test* test,
+               const TestMessage& msg = TestMessage(),
+               double elapsed = 0);
+    void putString(const std::string& str);
+
+private:
+    std::FILE* file;
+    std::string record;
+    std::unordered_map<std::string, uint64_t> strings;
+    std::unordered_map<const Test*, uint64_t> ids;
+    uint64_t lastId;
+    int64_t lastTime;
+};
+
+
+/**
+ * \brief Class EventLogReader decodes the test events recorded by an
+ * EventLogWriter. The file is mapped in memory when the platform allows
+ * it. A truncated record at the end of the file (e.g., if the recording
+ * run has been killed) is ignored.
+ */
+class EventLogReader
+{
+public:
+    EventLogReader();
+
+    ~EventLogReader();
+
+    /**
+     * @brief open opens a log file and checks its header
+     * @param filename the name of the file
+     * @param errorMsg a pointer to a TestMessage to return the error message
+     * in case of failure. It can be left unassigned if it is not required.
+     * @return true or false uppoun success or failure
+     */
+    bool open(const std::string& filename, TestMessage* errorMsg = nullptr);
+
+    /**
+     * @brief read decodes the next event. The tests are identified by an
+     * id which is unique within the log; their name and description are
+     * given by their start events.
+     * @param event the decoded event
+     * @return false at the end of the log or if it is corrupted
+     */
+    bool read(StreamEvent& event);
+
+private:
+    bool getString(const char*& pos, const char* end, std::string& str) const;
+    void unmap();
+
+private:
+    const char* data;
+    std::size_t size;
+    std::size_t offset;
+    bool mapped;
+    std::vector<char> buffer;
+    std::vector<std::string> strings;
+    int64_t lastTime;
+};
+
+
+/**
+ * \brief Class EventLogPlayer replays the events of a log to a TestResult,
+ * as if the tests were running, either as fast as possible or at the pace
+ * at which they have been recorded. The events keep their original time.
+ */
+class EventLogPlayer
+{
+public:
+    /**
+     * @brief EventLogPlayer constructor
+     * @param reader the reader of the log
+     */
+    EventLogPlayer(EventLogReader& reader);
+
+    /**
+     * @brief play replays all the events of the log, between the start
+     * and the end of the test runner
+     * @param result the TestResult to deliver the events to
+     * @param realtime whether the events are delayed as when they have
+     * been recorded
+     */
+    void play(TestResult& result, bool realtime = false);
+
+    /**
+     * @brief interrupt stops the replay. It only raises a flag, so that
+     * it can be called from a signal handler.
+     */
+    void interrupt();
+
+private:
+    EventLogReader& reader;
+    std::atomic<bool> interrupted;
+    std::map<uint64_t, RemoteTest*> remotes;
+    std::vector<std::unique_ptr<RemoteTest>> remoteTests;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_EVENTSTREAM_H
@@ -0,0 +1,106 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_ISOLATEDTEST_H
+#define ROBOTTESTINGFRAMEWORK_ISOLATEDTEST_H
+
+#include <robottestingframework/TestCase.h>
+#include <robottestingframework/TestResult.h>
+
+#include <EventStream.h>
+#include <Zygote.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * \brief Class IsolatedTest runs a test case in a child process forked from
+ * a Zygote and replays the events streamed back by the child to the
+ * TestResult. A crash of the child is reported as an error of the test,
+ * together with the signal which terminated it. If the test case has a
+ * timeout and it does not stop within the grace period after being
+ * interrupted, the child is killed.
+ *
+ * If the zygote is not running, the test is run within the testrunner
+ * process as usual.
+ */
+class IsolatedTest : public Test
+{
+public:
+    /**
+     * @brief IsolatedTest constructor
+     * @param test the test case to be isolated
+     * @param zygote the zygote to fork the child from
+     */
+    IsolatedTest(TestCase* test, Zygote& zygote);
+
+    /**
+     * @brief ~IsolatedTest destructor
+     */
+    virtual ~IsolatedTest();
+
+    /**
+     * @brief run runs the test in a child process
+     * @param result an instance of a TestResult
+     * to collect the result of the test.
+     */
+    void run(TestResult& result) override;
+
+    /**
+     * @brief interrupt interrupts the test running in the child process
+     */
+    void interrupt() override;
+
+    /**
+     * @brief succeeded
+     * @return true or false representing whether the test
+     * was successful or not.
+     */
+    bool succeeded() const override;
+
+    /**
+     * @brief getTest
+     * @return the isolated test case
+     */
+    TestCase* getTest() const;
+
+private:
+    Test* resolve(const StreamEvent& event);
+    void runInProcess(TestResult& result);
+
+private:
+    TestCase* test;
+    Zygote& zygote;
+    std::atomic<bool> successful;
+    std::atomic<bool> inProcess;
+    std::mutex mutex;
+    int controlFd;
+    std::map<uint64_t, Test*> remotes;
+    std::vector<std::unique_ptr<Test>> remoteTests;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_ISOLATEDTEST_H
@@ -33,6 +33,7 @@ namespace robottestingframework {
 /**
  * \brief Class JSONOutputter saves the results of the test collected by
  * a TestResultCollector in a JSON file.
+ * To write them while the tests are running, see JSONStreamOutputter.
  */
 class JSONOutputter
 {
@@ -0,0 +1,78 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_JSONSTREAMOUTPUTTER_H
+#define ROBOTTESTINGFRAMEWORK_JSONSTREAMOUTPUTTER_H
+
+
+#include <robottestingframework/StreamOutputter.h>
+
+#include <memory>
+#include <string>
+
+namespace json {
+class JSON;
+}
+
+namespace robottestingframework {
+
+/**
+ * \brief Class JSONStreamOutputter writes the results of the test in a
+ * JSON file while the tests are running. Each test case is appended to the
+ * \c tests array when it is finished, followed by the \c suites array and
+ * the \c summary object, which are rewritten at the end of the file.
+ */
+class JSONStreamOutputter : public StreamOutputter
+{
+public:
+    /**
+     * @brief JSONStreamOutputter constructor.
+     * @param verbose enables the verbose mode. If \c true, the line number
+     * where the messages are issued by the tests will be written to the
+     * output file. The verbose mode is disabled by default.
+     */
+    JSONStreamOutputter(bool verbose = false);
+
+    /**
+     * @brief ~JSONStreamOutputter destructor
+     */
+    ~JSONStreamOutputter() override;
+
+protected:
+    void begin() override;
+    void handle(ResultEvent::Kind kind,
+                const Test* test,
+                const TestMessage& msg,
+                double elapsed) override;
+    std::string trailer() const override;
+
+private:
+    void addMessage(const char* type, const std::string& msg, double elapsed = -1);
+
+private:
+    std::unique_ptr<json::JSON> test;
+    std::unique_ptr<json::JSON> suites;
+    bool firstTest;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_JSONSTREAMOUTPUTTER_H
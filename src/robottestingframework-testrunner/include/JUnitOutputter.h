@@ -33,6 +33,7 @@ namespace robottestingframework {
 /**
  * \brief Class JUnitOutputter saves the results of the test collected by
  * a TestResultCollector in a JUnit XML file.
+ * To write them while the tests are running, see JUnitStreamOutputter.
  */
 class JUnitOutputter
 {
@@ -0,0 +1,85 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_JUNITSTREAMOUTPUTTER_H
+#define ROBOTTESTINGFRAMEWORK_JUNITSTREAMOUTPUTTER_H
+
+
+#include <robottestingframework/StreamOutputter.h>
+
+#include <string>
+
+namespace robottestingframework {
+
+/**
+ * \brief Class JUnitStreamOutputter writes the results of the test in a
+ * JUnit XML file while the tests are running. Each test case is written
+ * when it is finished, followed by the closing tags of the document. The
+ * \c testsuite tag is written with its first test case and gets its \c time
+ * attribute when the suite is finished, while the attributes of the
+ * \c testsuites tag are written when the document is closed.
+ * The test cases which are not run by a test suite are written in a
+ * \c default suite.
+ */
+class JUnitStreamOutputter : public StreamOutputter
+{
+public:
+    /**
+     * @brief JUnitStreamOutputter constructor.
+     * @param verbose enables the verbose mode. If \c true, the source file and
+     * the line number where the messages are issued by the tests will be written to
+     * the output file. The verbose mode is disabled by default.
+     */
+    JUnitStreamOutputter(bool verbose = false);
+
+    /**
+     * @brief ~JUnitStreamOutputter destructor
+     */
+    ~JUnitStreamOutputter() override;
+
+protected:
+    void begin() override;
+    void handle(ResultEvent::Kind kind,
+                const Test* test,
+                const TestMessage& msg,
+                double elapsed) override;
+    void finish() override;
+    std::string trailer() const override;
+
+private:
+    void openSuite(const std::string& name);
+    void closeSuite(double time);
+
+private:
+    std::string classname;
+    bool suiteOpen;
+    bool suiteWritten;
+    bool defaultSuite;
+    std::streamoff rootOffset;
+    std::streamoff suiteOffset;
+    std::string errorMessages;
+    std::string failureMessages;
+    std::string reportsMessages;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_JUNITSTREAMOUTPUTTER_H
@@ -26,7 +26,12 @@
 #include <robottestingframework/TestCase.h>
 #include <robottestingframework/TestRunner.h>
 
+#include <IsolatedTest.h>
+#include <TestFilter.h>
+#include <Zygote.h>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -61,7 +66,9 @@ public:
 
     /**
      * @brief loadSinglePlugin loads all plugins from the
-     * given path
+     * given path. Only the plugins which are selected by the filter
+     * (see setFilter) and, if the tests are sharded (see setShard),
+     * only those of the selected shard are loaded.
      * @param path the path to the plugin files
      * @param recursive loads from subfolders if true
      * @return true or false upon success or failure
@@ -81,20 +88,252 @@ public:
      */
     const std::string& getPythonVenv() const;
 
+    /**
+     * @brief setIsolated enables running each test case in a separate
+     * process forked from a zygote (see robottestingframework::Zygote).
+     * It must be set before loading the plugins.
+     * @param isolated whether the test cases should be isolated
+     */
+    void setIsolated(bool isolated);
+
+    /**
+     * @brief isIsolated
+     * @return true if the test cases are run in separate processes
+     */
+    bool isIsolated() const;
+
+    /**
+     * @brief startIsolation starts the zygote process. It must be called
+     * after loading the plugins and before starting any thread (e.g., the
+     * web listener). If the zygote cannot be started, the isolated tests
+     * are run within the testrunner process.
+     * @return true or false upon success or failure
+     */
+    bool startIsolation();
+
+    /**
+     * @brief setTimeout sets the default timeout of the test cases
+     * which are loaded afterwards (see TestCase::setTimeout).
+     * @param timeout the timeout in seconds. Zero disables the timeout.
+     */
+    void setTimeout(double timeout);
+
+    /**
+     * @brief getTimeout returns the default timeout of the test cases
+     * @return the timeout in seconds
+     */
+    double getTimeout() const;
+
+    /**
+     * @brief setBenchmark enables the benchmark mode of the test cases
+     * which are loaded afterwards (see TestCase::setBenchmark).
+     * @param enabled whether the benchmark mode is enabled
+     * @param warmup the number of warm-up iterations
+     */
+    void setBenchmark(bool enabled, unsigned int warmup = 0);
+
+    /**
+     * @brief isBenchmark
+     * @return true if the benchmark mode is enabled by default
+     */
+    bool isBenchmark() const;
+
+    /**
+     * @brief getWarmup returns the default number of warm-up iterations
+     * @return the number of warm-up iterations
+     */
+    unsigned int getWarmup() const;
+
+    /**
+     * @brief setCheckAggregation enables the aggregation of the checks of
+     * the test cases which are loaded afterwards
+     * (see TestCase::setCheckAggregation).
+     * @param enabled whether the checks are aggregated
+     * @param keep the number of the first and of the last passing checks
+     * which are reported for each call site
+     */
+    void setCheckAggregation(bool enabled, unsigned int keep = 1);
+
+    /**
+     * @brief isCheckAggregation
+     * @return true if the checks are aggregated by default
+     */
+    bool isCheckAggregation() const;
+
+    /**
+     * @brief getCheckKeep returns the default number of the reported
+     * passing checks of each aggregated call site
+     * @return the number of the reported passing checks
+     */
+    unsigned int getCheckKeep() const;
+
+    /**
+     * @brief setFilter sets the filter which selects the tests and suites
+     * to be loaded afterwards from a folder or a suite. The plugins of the
+     * tests which are not selected are never opened.
+     * @param filter the test filter
+     */
+    void setFilter(const TestFilter& filter);
+
+    /**
+     * @brief getFilter
+     * @return the test filter
+     */
+    const TestFilter& getFilter() const;
+
+    /**
+     * @brief setShard partitions the tests and suites which are loaded
+     * afterwards from a folder into \c count shards and selects the shard
+     * to be loaded. The partition is deterministic: the runners with the
+     * same tests and durations (see loadDurations) and a different
+     * \c index load disjoint sets of tests. Therefore all the shards must
+     * load the same durations file, which they only read.
+     * @param index the index of the selected shard (from 0 to count - 1)
+     * @param count the number of shards
+     */
+    void setShard(unsigned int index, unsigned int count);
+
+    /**
+     * @brief getShardIndex
+     * @return the index of the selected shard
+     */
+    unsigned int getShardIndex() const;
+
+    /**
+     * @brief getShardCount
+     * @return the number of shards
+     */
+    unsigned int getShardCount() const;
+
+    /**
+     * @brief loadDurations loads the expected durations of the tests and
+     * suites, which are used to balance the shards by the expected run time
+     * rather than by the number of tests. Each line of the file holds the
+     * duration in seconds and the path of a plugin or suite file, relative
+     * to the folder it has been loaded from. The file is only read and a
+     * missing file is not an error.
+     * @param filename the durations file
+     * @return true or false upon success or failure
+     */
+    bool loadDurations(const std::string& filename);
+
+    /**
+     * @brief saveDurations writes the durations of the tests and suites
+     * which have been run to a new file. It cannot be the file given to
+     * loadDurations: the files written by the shards are combined with it
+     * by mergeDurations.
+     * @param filename the output durations file
+     * @return true or false upon success or failure
+     */
+    bool saveDurations(const std::string& filename);
+
+    /**
+     * @brief mergeDurations merges durations files into a single one.
+     * The files are read in the given order and the duration of a test or
+     * suite recorded in several files is taken from the last one, so the
+     * previous durations file is given first followed by the files written
+     * by the shards.
+     * @param filenames the durations files to be merged. The missing ones
+     * are skipped.
+     * @param output the merged durations file. It can be one of the
+     * merged files.
+     * @return true or false upon success or failure
+     */
+    static bool mergeDurations(const std::vector<std::string>& filenames,
+                               const std::string& output);
+
+    /**
+     * @brief getPlan
+     * @return the names of the loaded tests and suites with their expected
+     * durations in seconds: the recorded ones (see loadDurations), the
+     * average of the recorded ones if unknown, or -1 if none is recorded.
+     */
+    std::vector<std::pair<std::string, double>> getPlan() const;
+
     /**
      * Clear the test list
      */
     void reset();
 
+protected:
+    /**
+     * @brief selectShard selects the files of the current shard. The files
+     * are assigned, from the longest to the shortest, to the shard with the
+     * smallest expected run time.
+     * @param filenames the plugin or suite files
+     * @return the sorted files of the current shard
+     */
+    std::vector<std::string> selectShard(std::vector<std::string> filenames);
+
+    /**
+     * @brief addDurationKey associates a test with the file it has been
+     * loaded from, so that its duration is saved by saveDurations.
+     * @param test the test
+     * @param filename the plugin or suite file
+     */
+    void addDurationKey(const robottestingframework::Test* test,
+                        const std::string& filename);
+
+    /**
+     * @brief setDurationRoot sets the folder from which the files are
+     * loaded afterwards, e.g. by loadMultiplePlugins
+     * @param path the folder, or empty for the files loaded one by one
+     */
+    void setDurationRoot(const std::string& path);
+
+    /**
+     * @brief durationKey
+     * @param filename a plugin or suite file
+     * @return the name under which the duration of the file is recorded:
+     * its path relative to the folder set by setDurationRoot, or its name
+     * if it is not loaded from a folder
+     */
+    std::string durationKey(const std::string& filename) const;
+
+    /**
+     * @brief averageDuration
+     * @return the average of the recorded durations, or -1 if none is
+     * recorded
+     */
+    double averageDuration() const;
+
+    /**
+     * @brief isolate wraps the given test case in an IsolatedTest if
+     * the isolation is enabled.
+     * @param test the test case
+     * @return the test to be added to the runner or to a suite
+     */
+    robottestingframework::Test* isolate(robottestingframework::TestCase* test);
+
 protected:
     std::vector<robottestingframework::plugin::PluginLoader*> dllLoaders;
 
 private:
-    bool loadPluginsFromPath(std::string path);
+    bool findPlugins(std::string path, bool recursive, std::vector<std::string>& filenames);
+    static bool readDurations(const std::string& filename,
+                              std::map<std::string, double>& durations);
+    static bool writeDurations(const std::string& filename,
+                               const std::map<std::string, double>& durations);
 
 private:
     bool verbose;
+    bool isolated;
+    double timeout;
+    bool benchmark;
+    unsigned int warmup;
+    bool aggregation;
+    unsigned int checkKeep;
     std::string pythonVenv;
+    TestFilter filter;
+    robottestingframework::Zygote zygote;
+    std::vector<robottestingframework::IsolatedTest*> isolatedTests;
+    unsigned int shardIndex;
+    unsigned int shardCount;
+    std::vector<double> shardLoads;
+    std::map<std::string, double> durations;
+    std::string durationsFile;
+    std::string durationRoot;
+    std::vector<std::pair<const robottestingframework::Test*, std::string>> durationKeys;
 };
 
 #endif // ROBOTTESTINGFRAMEWORK_PLUGINRUNNER_H
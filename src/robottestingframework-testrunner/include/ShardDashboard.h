@@ -0,0 +1,209 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_SHARDDASHBOARD_H
+#define ROBOTTESTINGFRAMEWORK_SHARDDASHBOARD_H
+
+#include <robottestingframework/TestListener.h>
+#include <robottestingframework/TestMessage.h>
+
+#include <EventStream.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * @brief ShardPlan holds the names of the top level tests and suites
+ * of a shard with their expected durations in seconds (negative if
+ * unknown).
+ */
+typedef std::vector<std::pair<std::string, double>> ShardPlan;
+
+
+/**
+ * \brief Class ShardPublisher publishes the test events of a shard to a
+ * ShardDashboard through a local (UNIX domain) socket. The connection
+ * starts with a text header which holds the name and the plan of the
+ * shard, followed by the events encoded by an EventStreamWriter.
+ *
+ * A dashboard which stops does not stop the shard: the events are
+ * dropped from then on.
+ */
+class ShardPublisher
+{
+public:
+    /**
+     * @brief ShardPublisher constructor
+     */
+    ShardPublisher();
+
+    /**
+     * @brief ~ShardPublisher destructor. It closes the connection, which
+     * marks the end of the shard for the dashboard.
+     */
+    virtual ~ShardPublisher();
+
+    /**
+     * @brief connect connects to a dashboard and announces the shard
+     * @param path the path of the socket of the dashboard
+     * @param name the name of the shard
+     * @param plan the tests and suites which the shard is expected to run
+     * @param errorMsg a pointer to a TestMessage to return the error message
+     * in case of failure. It can be left unassigned if it is not required.
+     * @return true or false upon success or failure
+     */
+    bool connect(const std::string& path,
+                 const std::string& name,
+                 const ShardPlan& plan,
+                 TestMessage* errorMsg = nullptr);
+
+    /**
+     * @brief getListener
+     * @return the listener which publishes the events, or nullptr if the
+     * publisher is not connected
+     */
+    TestListener* getListener();
+
+private:
+    int fd;
+    std::unique_ptr<EventStreamWriter> writer;
+};
+
+
+/**
+ * \brief Class ShardDashboard collects the test events published by the
+ * shards of a run (see ShardPublisher) on a local (UNIX domain) socket.
+ * The events of each shard are replayed to its own TestResult, to which
+ * the listener created for the shard is added, so that a single process
+ * (e.g. a web reporter) follows all the shards run in parallel.
+ *
+ * A shard which closes the connection in the middle of a test is reported
+ * as an error of the test. The dashboard is only available on POSIX
+ * systems.
+ */
+class ShardDashboard
+{
+public:
+    /**
+     * @brief ListenerFactory creates the listener of a shard from its
+     * name and plan. The listener is owned by the dashboard.
+     */
+    typedef std::function<TestListener*(const std::string& name, const ShardPlan& plan)> ListenerFactory;
+
+    /**
+     * @brief ShardDashboard constructor
+     * @param factory the factory of the listeners of the shards. It is
+     * called by one shard at a time.
+     */
+    ShardDashboard(ListenerFactory factory);
+
+    /**
+     * @brief ~ShardDashboard destructor. It stops serving and removes
+     * the socket.
+     */
+    virtual ~ShardDashboard();
+
+    /**
+     * @brief listen creates the socket to which the shards connect. A
+     * stale socket at the same path is replaced.
+     * @param path the path of the socket
+     * @param errorMsg a pointer to a TestMessage to return the error message
+     * in case of failure. It can be left unassigned if it is not required.
+     * @return true or false upon success or failure
+     */
+    bool listen(const std::string& path, TestMessage* errorMsg = nullptr);
+
+    /**
+     * @brief serve replays the events of the shards until the given
+     * number of shards has finished or the dashboard is interrupted
+     * @param count the number of the expected shards
+     */
+    void serve(unsigned int count);
+
+    /**
+     * @brief interrupt stops serving. The shards which are still
+     * connected are disconnected by serve(). It only raises a flag, so
+     * that it can be called from a signal handler.
+     */
+    void interrupt();
+
+    /**
+     * @brief shardCount
+     * @return the number of the shards which have finished
+     */
+    unsigned int shardCount() const;
+
+    /**
+     * @brief testCount
+     * @return the number of the test cases run by the shards
+     */
+    unsigned int testCount() const;
+
+    /**
+     * @brief failedCount
+     * @return the number of the failed test cases
+     */
+    unsigned int failedCount() const;
+
+    /**
+     * @brief suiteCount
+     * @return the number of the test suites run by the shards
+     */
+    unsigned int suiteCount() const;
+
+    /**
+     * @brief failedSuiteCount
+     * @return the number of the failed test suites
+     */
+    unsigned int failedSuiteCount() const;
+
+private:
+    void receive(int conn);
+    bool readHeader(int conn, std::string& name, ShardPlan& plan);
+    void disconnect(int conn);
+    void disconnectAll();
+
+private:
+    ListenerFactory factory;
+    std::string path;
+    int sock;
+    std::atomic<bool> interrupted;
+    std::atomic<unsigned int> finished;
+    std::atomic<unsigned int> tests;
+    std::atomic<unsigned int> failedTests;
+    std::atomic<unsigned int> suites;
+    std::atomic<unsigned int> failedSuites;
+    std::mutex mutex;
+    std::vector<int> connections;
+    std::vector<std::thread> receivers;
+    std::vector<std::unique_ptr<TestListener>> listeners;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_SHARDDASHBOARD_H
@@ -22,13 +22,18 @@
 #ifndef ROBOTTESTINGFRAMEWORK_SuiteRunner_H
 #define ROBOTTESTINGFRAMEWORK_SuiteRunner_H
 
+#include <robottestingframework/SharedFixture.h>
 #include <robottestingframework/TestSuite.h>
 #include <robottestingframework/dll/DllFixturePluginLoader.h>
 
 #include <PluginRunner.h>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+class TiXmlElement;
+
 /**
  * class SuiteRunner
  */
@@ -47,7 +52,10 @@ public:
     virtual ~SuiteRunner();
 
     /**
-     * @brief loadSuite loads a single test suite (xml file)
+     * @brief loadSuite loads a single test suite (xml file).
+     * The fixtures with the same plugin and param are shared among
+     * all the loaded suites (see SharedFixture): they are set up once
+     * and torn down after the last suite which uses them.
      * @param filename the xml file name
      * @return true or false upon success or failure
      */
@@ -55,25 +63,48 @@ public:
 
     /**
      * @brief loadMultipleSuites loads all test suites from the
-     * given path
+     * given path. The suites are selected by the filter (see setFilter)
+     * and, if they are sharded (see setShard), only the selected suites
+     * of the selected shard are loaded.
      * @param path the path to the test suites xml files
      * @param recursive loads from subfolders if true
      * @return true or false upon success or failure
      */
     bool loadMultipleSuites(std::string path, bool recursive = false);
 
+    /**
+     * @brief setMonitorPeriod sets the default period of the fixture
+     * monitor of the suites which are loaded afterwards
+     * (see TestSuite::setMonitorPeriod).
+     * @param period the monitor period in seconds. Zero disables the
+     * monitor and the fixtures are checked before each test.
+     */
+    void setMonitorPeriod(double period);
+
+    /**
+     * @brief getMonitorPeriod returns the default period of the fixture monitor
+     * @return the monitor period in seconds
+     */
+    double getMonitorPeriod() const;
+
     /**
      * Clear the test list
      */
     void reset();
 
 private:
-    bool loadSuitesFromPath(std::string path);
+    bool findSuites(std::string path, bool recursive, std::vector<std::string>& filenames);
+    bool selectsSuite(const std::string& filename, TiXmlElement* root) const;
+    bool selectsTest(TiXmlElement* root, TiXmlElement* test, bool suiteSelected) const;
+    bool isSuiteSelected(const std::string& filename) const;
+    static std::vector<std::string> suiteNames(const std::string& filename, TiXmlElement* root);
 
 private:
     bool verbose;
+    double monitorPeriod;
     std::vector<robottestingframework::TestSuite*> suites;
     std::vector<robottestingframework::plugin::DllFixturePluginLoader*> fixtureLoaders;
+    std::map<std::pair<std::string, std::string>, robottestingframework::SharedFixture*> sharedFixtures;
 };
 
 #endif // ROBOTTESTINGFRAMEWORK_SuiteRunner_H
@@ -0,0 +1,134 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TESTFILTER_H
+#define ROBOTTESTINGFRAMEWORK_TESTFILTER_H
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * class TestFilter selects the tests and suites to be loaded by their
+ * names and tags, before their plugins are opened.
+ * The patterns are comma separated lists of glob patterns (e.g., "Fixture*")
+ * or of regular expressions prefixed by "re:" (e.g., "re:^My.*Test$").
+ */
+class TestFilter
+{
+public:
+    /**
+     * TestFilter constructor
+     */
+    TestFilter();
+
+    /**
+     * @brief setFilter sets the patterns of the names to be selected
+     * @param patterns comma separated patterns. An empty string selects
+     * all the names.
+     * @return false if any regular expression is invalid
+     */
+    bool setFilter(const std::string& patterns);
+
+    /**
+     * @brief setExclude sets the patterns of the names to be excluded
+     * @param patterns comma separated patterns
+     * @return false if any regular expression is invalid
+     */
+    bool setExclude(const std::string& patterns);
+
+    /**
+     * @brief setTags sets the tags to be selected
+     * @param tags comma separated tags. An empty string selects
+     * all the tests, also those without any tag.
+     */
+    void setTags(const std::string& tags);
+
+    /**
+     * @brief isEnabled
+     * @return true if any pattern or tag is set
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief selects
+     * @param names the names of a test or a suite
+     * @return true if any of the names matches a filter pattern
+     */
+    bool selects(const std::vector<std::string>& names) const;
+
+    /**
+     * @brief excludes
+     * @param names the names of a test or a suite
+     * @return true if any of the names matches an exclude pattern
+     */
+    bool excludes(const std::vector<std::string>& names) const;
+
+    /**
+     * @brief selectsTags
+     * @param tags the comma separated tags of a test
+     * @return true if any of the tags is selected
+     */
+    bool selectsTags(const std::string& tags) const;
+
+    /**
+     * @brief fileNames
+     * @param path a plugin or suite file
+     * @return the names which are matched for the file, i.e. its
+     * name with and without the folder and the extension
+     */
+    static std::vector<std::string> fileNames(const std::string& path);
+
+    /**
+     * @brief split splits a comma separated list
+     * @param list the comma separated list
+     * @return the trimmed, non empty items of the list
+     */
+    static std::vector<std::string> split(const std::string& list);
+
+    /**
+     * @brief glob matches a name against a glob pattern
+     * which may contain '*' and '?' wildcards
+     * @param pattern the glob pattern
+     * @param name the name
+     * @return true if the name matches the pattern
+     */
+    static bool glob(const char* pattern, const char* name);
+
+private:
+    class Pattern
+    {
+    public:
+        std::string text;
+        std::shared_ptr<std::regex> regex;
+        bool match(const std::string& name) const;
+    };
+    static bool parse(const std::string& patterns, std::vector<Pattern>& parsed);
+    static bool match(const std::vector<Pattern>& patterns, const std::vector<std::string>& names);
+
+private:
+    std::vector<Pattern> filters;
+    std::vector<Pattern> exclusions;
+    std::vector<std::string> tags;
+};
+
+#endif // ROBOTTESTINGFRAMEWORK_TESTFILTER_H
@@ -0,0 +1,115 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_ZYGOTE_H
+#define ROBOTTESTINGFRAMEWORK_ZYGOTE_H
+
+#include <robottestingframework/Test.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace robottestingframework {
+
+/**
+ * \brief Class Zygote keeps a pre-forked copy of the testrunner process
+ * in which all the test plugins are already loaded. Each isolated test
+ * is run in a child forked from the zygote, so that a crash or a hang
+ * of the test cannot take the whole run down, while the cost of spawning
+ * a test stays as low as a fork().
+ *
+ * The zygote must be started after loading the plugins and before any
+ * thread is created by the testrunner (e.g., the worker pool or the web
+ * listener). The isolation is only available on POSIX systems.
+ */
+class Zygote
+{
+public:
+    /**
+     * @brief Zygote constructor
+     */
+    Zygote();
+
+    /**
+     * @brief ~Zygote destructor. It stops the zygote process.
+     */
+    virtual ~Zygote();
+
+    /**
+     * @brief start forks the zygote process
+     * @return true or false upon success or failure
+     */
+    bool start();
+
+    /**
+     * @brief stop stops the zygote and kills any running child
+     */
+    void stop();
+
+    /**
+     * @brief isRunning
+     * @return true if the zygote process is running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief spawn forks a child from the zygote to run the given test.
+     * The child writes its events to \c eventFd (see EventStreamWriter)
+     * and interrupts the test whenever a byte is read from \c controlFd.
+     * @param test the test to run. It must have been created before
+     * the zygote was started.
+     * @param eventFd the write end of the event pipe
+     * @param controlFd the read end of the control pipe
+     * @return the process id of the child or -1 on failure
+     */
+    long spawn(Test* test, int eventFd, int controlFd);
+
+    /**
+     * @brief wait blocks until the given child is terminated
+     * @param pid the process id of the child
+     * @return the wait status of the child (see waitpid())
+     * or -1 if it is not available
+     */
+    int wait(long pid);
+
+private:
+    void receive();
+
+private:
+    int sock;
+    long pid;
+    std::atomic<bool> running;
+    uint64_t seq;
+    std::map<uint64_t, long> spawned;
+    std::map<long, int> exited;
+    std::mutex mutex;
+    std::mutex sendMutex;
+    std::condition_variable cond;
+    std::thread reader;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_ZYGOTE_H
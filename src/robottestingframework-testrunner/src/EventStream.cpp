@@ -0,0 +1,865 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestListenerAdapter.h>
+#include <robottestingframework/TestResult.h>
+
+#include <EventStream.h>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#    include <io.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+// Each event is encoded as a record prefixed by its length:
+//   u32 length | u8 kind | u64 id | u8 succeeded |
+//   str name | str description | str message | str detail | str file | u32 line |
+//   u64 elapsed | u64 timestamp | u64 duration | u32 count | (str phase | u64 duration) * count |
+//   u32 count | (str name | f64 value) * count
+// where str is a u32 length followed by the bytes, the times are in
+// microseconds and f64 is an IEEE 754 double. All integers are little-endian.
+
+static const uint32_t maxRecordSize = 64 * 1024 * 1024;
+
+static void put_u32(string& buf, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        buf.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void put_u64(string& buf, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) {
+        buf.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void put_f64(string& buf, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_u64(buf, bits);
+}
+
+static void put_str(string& buf, const string& str)
+{
+    put_u32(buf, static_cast<uint32_t>(str.size()));
+    buf.append(str);
+}
+
+static bool get_u32(const vector<char>& buf, size_t& pos, uint32_t& value)
+{
+    if (pos + 4 > buf.size()) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(buf[pos++])) << (8 * i);
+    }
+    return true;
+}
+
+static bool get_u64(const vector<char>& buf, size_t& pos, uint64_t& value)
+{
+    if (pos + 8 > buf.size()) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(buf[pos++])) << (8 * i);
+    }
+    return true;
+}
+
+static bool get_f64(const vector<char>& buf, size_t& pos, double& value)
+{
+    uint64_t bits;
+    if (!get_u64(buf, pos, bits)) {
+        return false;
+    }
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+static bool get_str(const vector<char>& buf, size_t& pos, string& str)
+{
+    uint32_t size;
+    if (!get_u32(buf, pos, size) || pos + size > buf.size()) {
+        return false;
+    }
+    str.assign(buf.data() + pos, size);
+    pos += size;
+    return true;
+}
+
+static bool write_all(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, char* data, size_t size)
+{
+    while (size > 0) {
+        auto n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+
+EventStreamWriter::EventStreamWriter(int fd) :
+        fd(fd)
+{
+}
+
+void EventStreamWriter::write(StreamEvent::Kind kind,
+                              const Test* test,
+                              const TestMessage& msg,
+                              double elapsed)
+{
+    bool start = (kind == StreamEvent::StartTest || kind == StreamEvent::StartSuite);
+    bool end = (kind == StreamEvent::EndTest || kind == StreamEvent::EndSuite);
+    // the outcome taken when the test ended
+    TestOutcome outcome = end ? TestListenerAdapter::outcomeOf(test) : TestOutcome();
+    string record;
+    put_u32(record, 0);
+    record.push_back(static_cast<char>(kind));
+    put_u64(record, reinterpret_cast<uintptr_t>(test));
+    record.push_back(static_cast<char>((end ? outcome.succeeded() : test->succeeded()) ? 1 : 0));
+    put_str(record, start ? test->getName() : string());
+    put_str(record, start ? test->getDescription() : string());
+    TestMessage message(msg);
+    put_str(record, message.getMessage());
+    put_str(record, message.getDetail());
+    put_str(record, message.getSourceFileName());
+    put_u32(record, message.getSourceLineNumber());
+    put_u64(record, static_cast<uint64_t>(elapsed * 1e6));
+    put_u64(record, static_cast<uint64_t>(TestResult::eventTime() * 1e6));
+    put_u64(record, static_cast<uint64_t>(outcome.getDuration() * 1e6));
+    put_u32(record, static_cast<uint32_t>(outcome.getDurations().size()));
+    if (end) {
+        for (const auto& phase : outcome.getDurations()) {
+            put_str(record, phase.first);
+            put_u64(record, static_cast<uint64_t>(phase.second * 1e6));
+        }
+    }
+    put_u32(record, static_cast<uint32_t>(outcome.getStatistics().size()));
+    if (end) {
+        for (const auto& statistic : outcome.getStatistics()) {
+            put_str(record, statistic.first);
+            put_f64(record, statistic.second);
+        }
+    }
+
+    // fill the record length
+    auto size = static_cast<uint32_t>(record.size() - 4);
+    for (int i = 0; i < 4; i++) {
+        record[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+    write_all(fd, record.data(), record.size());
+}
+
+void EventStreamWriter::addReport(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Report, test, msg);
+}
+
+void EventStreamWriter::addError(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Error, test, msg);
+}
+
+void EventStreamWriter::addFailure(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Failure, test, msg);
+}
+
+void EventStreamWriter::addTimeout(const Test* test, TestMessage msg, double elapsed)
+{
+    write(StreamEvent::Timeout, test, msg, elapsed);
+}
+
+void EventStreamWriter::startTest(const Test* test)
+{
+    write(StreamEvent::StartTest, test);
+}
+
+void EventStreamWriter::endTest(const Test* test)
+{
+    write(StreamEvent::EndTest, test);
+}
+
+void EventStreamWriter::startTestSuite(const Test* test)
+{
+    write(StreamEvent::StartSuite, test);
+}
+
+void EventStreamWriter::endTestSuite(const Test* test)
+{
+    write(StreamEvent::EndSuite, test);
+}
+
+
+EventStreamReader::EventStreamReader(int fd) :
+        fd(fd)
+{
+}
+
+bool EventStreamReader::read(StreamEvent& event)
+{
+    char header[4];
+    if (!read_all(fd, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t size = 0;
+    for (int i = 0; i < 4; i++) {
+        size |= static_cast<uint32_t>(static_cast<unsigned char>(header[i])) << (8 * i);
+    }
+    if (size < 10 || size > maxRecordSize) {
+        return false;
+    }
+    vector<char> buf(size);
+    if (!read_all(fd, buf.data(), size)) {
+        return false;
+    }
+
+    size_t pos = 0;
+    auto kind = static_cast<unsigned char>(buf[pos++]);
+    if (kind < StreamEvent::Report || kind > StreamEvent::Timeout) {
+        return false;
+    }
+    event.kind = static_cast<StreamEvent::Kind>(kind);
+    if (!get_u64(buf, pos, event.id) || pos >= buf.size()) {
+        return false;
+    }
+    event.succeeded = (buf[pos++] != 0);
+
+    string message;
+    string detail;
+    string file;
+    uint32_t line;
+    uint64_t elapsed;
+    uint64_t timestamp;
+    uint64_t duration;
+    uint32_t count;
+    if (!get_str(buf, pos, event.name) || !get_str(buf, pos, event.description) || !get_str(buf, pos, message) || !get_str(buf, pos, detail) || !get_str(buf, pos, file) || !get_u32(buf, pos, line) || !get_u64(buf, pos, elapsed) || !get_u64(buf, pos, timestamp) || !get_u64(buf, pos, duration) || !get_u32(buf, pos, count)) {
+        return false;
+    }
+    event.elapsed = static_cast<double>(elapsed) / 1e6;
+    event.timestamp = static_cast<double>(timestamp) / 1e6;
+    event.duration = static_cast<double>(duration) / 1e6;
+    event.msg = TestMessage(message, detail, file, line);
+    event.durations.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        string phase;
+        uint64_t value;
+        if (!get_str(buf, pos, phase) || !get_u64(buf, pos, value)) {
+            return false;
+        }
+        event.durations.emplace_back(phase, static_cast<double>(value) / 1e6);
+    }
+    event.statistics.clear();
+    if (!get_u32(buf, pos, count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        string name;
+        double value;
+        if (!get_str(buf, pos, name) || !get_f64(buf, pos, value)) {
+            return false;
+        }
+        event.statistics.emplace_back(name, value);
+    }
+    return true;
+}
+
+
+RemoteTest::RemoteTest(const string& name, const string& description) :
+        Test(name, description),
+        successful(true)
+{
+}
+
+void RemoteTest::run(TestResult& /*result*/)
+{
+}
+
+bool RemoteTest::succeeded() const
+{
+    return successful;
+}
+
+void RemoteTest::update(const StreamEvent& event)
+{
+    successful = event.succeeded;
+    setDuration(event.duration);
+    setDurations(event.durations);
+    setStatistics(event.statistics);
+}
+
+
+void robottestingframework::replayEvent(TestResult& result, Test* test, const StreamEvent& event)
+{
+    TestResult::setEventTime(event.timestamp);
+    switch (event.kind) {
+    case StreamEvent::Report:
+        result.addReport(test, event.msg);
+        break;
+    case StreamEvent::Error:
+        result.addError(test, event.msg);
+        break;
+    case StreamEvent::Failure:
+        result.addFailure(test, event.msg);
+        break;
+    case StreamEvent::Timeout:
+        result.addTimeout(test, event.msg, event.elapsed);
+        break;
+    case StreamEvent::StartTest:
+        result.startTest(test);
+        break;
+    case StreamEvent::EndTest:
+        result.endTest(test);
+        break;
+    case StreamEvent::StartSuite:
+        result.startTestSuite(test);
+        break;
+    case StreamEvent::EndSuite:
+        result.endTestSuite(test);
+        break;
+    }
+    TestResult::setEventTime(0);
+}
+
+
+// The log file starts with an 8 bytes header (the "RTFBIN" magic, the
+// version and a reserved byte) followed by records prefixed by their length:
+//   u32 length | u8 type | body
+// A string record (type 0x80) holds the bytes of a string whose index is
+// the number of strings defined before it, plus one. The body of an event
+// record (type = StreamEvent::Kind) is:
+//   var id | svar timestamp | u8 succeeded | kind specific fields
+// start:   ref name | ref description
+// message: ref message | ref detail | ref file | var line [| var elapsed]
+// end:     var duration | var count | (ref phase | var duration) * count |
+//          var count | (ref name | f64 value) * count
+// where var is an unsigned LEB128 integer, svar is a zigzag encoded var
+// holding the difference from the timestamp of the previous event, the
+// times are in microseconds and ref is the index of a string or 0 followed
+// by an inline string (var length and bytes) once the table is full.
+
+static const char logMagic[] = {'R', 'T', 'F', 'B', 'I', 'N', 1, 0};
+static const char stringRecord = static_cast<char>(0x80);
+static const size_t maxLogStrings = 1 << 16;
+
+static void put_var(string& buf, uint64_t value)
+{
+    while (value >= 0x80) {
+        buf.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buf.push_back(static_cast<char>(value));
+}
+
+static bool get_var(const char*& pos, const char* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        auto byte = static_cast<unsigned char>(*pos++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t to_micros(double seconds)
+{
+    return (seconds > 0) ? static_cast<uint64_t>(llround(seconds * 1e6)) : 0;
+}
+
+
+EventLogWriter::EventLogWriter() :
+        file(nullptr),
+        lastId(0),
+        lastTime(0)
+{
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    close();
+}
+
+bool EventLogWriter::open(const string& filename, TestMessage* errorMsg)
+{
+    close();
+    file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr || std::fwrite(logMagic, sizeof(logMagic), 1, file) != 1) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot open the file " + filename + " for writing");
+        }
+        close();
+        return false;
+    }
+    strings.clear();
+    ids.clear();
+    lastId = 0;
+    lastTime = 0;
+    return true;
+}
+
+void EventLogWriter::close()
+{
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+void EventLogWriter::putString(const string& str)
+{
+    auto itr = strings.find(str);
+    if (itr != strings.end()) {
+        put_var(record, itr->second);
+        return;
+    }
+    if (strings.size() >= maxLogStrings) {
+        put_var(record, 0);
+        put_var(record, str.size());
+        record.append(str);
+        return;
+    }
+
+    // the string record must precede the event which refers to it
+    string definition;
+    put_u32(definition, static_cast<uint32_t>(str.size() + 1));
+    definition.push_back(stringRecord);
+    definition.append(str);
+    std::fwrite(definition.data(), 1, definition.size(), file);
+    uint64_t index = strings.size() + 1;
+    strings.emplace(str, index);
+    put_var(record, index);
+}
+
+void EventLogWriter::write(StreamEvent::Kind kind,
+                           const Test* test,
+                           const TestMessage& msg,
+                           double elapsed)
+{
+    if (file == nullptr) {
+        return;
+    }
+
+    // the pointers of the tests can be reused: each start gets a new id
+    bool start = (kind == StreamEvent::StartTest || kind == StreamEvent::StartSuite);
+    bool end = (kind == StreamEvent::EndTest || kind == StreamEvent::EndSuite);
+    auto itr = ids.find(test);
+    if (itr == ids.end() || start) {
+        itr = ids.insert(std::make_pair(test, 0)).first;
+        itr->second = ++lastId;
+    }
+    uint64_t id = itr->second;
+    if (end) {
+        ids.erase(itr);
+    }
+
+    auto time = static_cast<int64_t>(to_micros(TestResult::eventTime()));
+    int64_t delta = time - lastTime;
+    lastTime = time;
+
+    record.clear();
+    put_u32(record, 0);
+    record.push_back(static_cast<char>(kind));
+    put_var(record, id);
+    put_var(record, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+    // the outcome taken when the test ended
+    TestOutcome outcome = end ? TestListenerAdapter::outcomeOf(test) : TestOutcome();
+    record.push_back(static_cast<char>((end ? outcome.succeeded() : test->succeeded()) ? 1 : 0));
+    switch (kind) {
+    case StreamEvent::StartTest:
+    case StreamEvent::StartSuite:
+        putString(test->getName());
+        putString(test->getDescription());
+        break;
+    case StreamEvent::Report:
+    case StreamEvent::Error:
+    case StreamEvent::Failure:
+    case StreamEvent::Timeout:
+        putString(msg.getMessage());
+        putString(msg.getDetail());
+        putString(msg.getSourceFileName());
+        put_var(record, msg.getSourceLineNumber());
+        if (kind == StreamEvent::Timeout) {
+            put_var(record, to_micros(elapsed));
+        }
+        break;
+    case StreamEvent::EndTest:
+    case StreamEvent::EndSuite:
+        put_var(record, to_micros(outcome.getDuration()));
+        put_var(record, outcome.getDurations().size());
+        for (const auto& phase : outcome.getDurations()) {
+            putString(phase.first);
+            put_var(record, to_micros(phase.second));
+        }
+        put_var(record, outcome.getStatistics().size());
+        for (const auto& statistic : outcome.getStatistics()) {
+            putString(statistic.first);
+            put_f64(record, statistic.second);
+        }
+        break;
+    }
+
+    // fill the record length
+    auto size = static_cast<uint32_t>(record.size() - 4);
+    for (int i = 0; i < 4; i++) {
+        record[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+    std::fwrite(record.data(), 1, record.size(), file);
+    if (end) {
+        std::fflush(file);
+    }
+}
+
+void EventLogWriter::addReport(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Report, test, msg);
+}
+
+void EventLogWriter::addError(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Error, test, msg);
+}
+
+void EventLogWriter::addFailure(const Test* test, TestMessage msg)
+{
+    write(StreamEvent::Failure, test, msg);
+}
+
+void EventLogWriter::addTimeout(const Test* test, TestMessage msg, double elapsed)
+{
+    write(StreamEvent::Timeout, test, msg, elapsed);
+}
+
+void EventLogWriter::startTest(const Test* test)
+{
+    write(StreamEvent::StartTest, test);
+}
+
+void EventLogWriter::endTest(const Test* test)
+{
+    write(StreamEvent::EndTest, test);
+}
+
+void EventLogWriter::startTestSuite(const Test* test)
+{
+    write(StreamEvent::StartSuite, test);
+}
+
+void EventLogWriter::endTestSuite(const Test* test)
+{
+    write(StreamEvent::EndSuite, test);
+}
+
+void EventLogWriter::endTestRunner()
+{
+    if (file != nullptr) {
+        std::fflush(file);
+    }
+}
+
+
+EventLogReader::EventLogReader() :
+        data(nullptr),
+        size(0),
+        offset(0),
+        mapped(false),
+        lastTime(0)
+{
+}
+
+EventLogReader::~EventLogReader()
+{
+    unmap();
+}
+
+void EventLogReader::unmap()
+{
+#if !defined(_WIN32)
+    if (mapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    offset = 0;
+    mapped = false;
+    buffer.clear();
+    strings.clear();
+    lastTime = 0;
+}
+
+bool EventLogReader::open(const string& filename, TestMessage* errorMsg)
+{
+    unmap();
+#if !defined(_WIN32)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* addr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            data = static_cast<const char*>(addr);
+            size = static_cast<size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+    if (!mapped) {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        if (file.is_open()) {
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data = buffer.data();
+            size = buffer.size();
+        }
+    }
+
+    if (size < sizeof(logMagic) || memcmp(data, logMagic, sizeof(logMagic)) != 0) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot read the event log " + filename);
+        }
+        unmap();
+        return false;
+    }
+    offset = sizeof(logMagic);
+    return true;
+}
+
+bool EventLogReader::getString(const char*& pos, const char* end, string& str) const
+{
+    uint64_t index;
+    if (!get_var(pos, end, index)) {
+        return false;
+    }
+    if (index > 0) {
+        if (index > strings.size()) {
+            return false;
+        }
+        str = strings[index - 1];
+        return true;
+    }
+    uint64_t length;
+    if (!get_var(pos, end, length) || length > static_cast<uint64_t>(end - pos)) {
+        return false;
+    }
+    str.assign(pos, length);
+    pos += length;
+    return true;
+}
+
+bool EventLogReader::read(StreamEvent& event)
+{
+    while (offset + 5 <= size) {
+        uint32_t length = 0;
+        for (int i = 0; i < 4; i++) {
+            length |= static_cast<uint32_t>(static_cast<unsigned char>(data[offset + i])) << (8 * i);
+        }
+        if (length == 0 || length > size - offset - 4) {
+            // truncated by the end of the recording
+            return false;
+        }
+        const char* pos = data + offset + 4;
+        const char* end = pos + length;
+        offset += 4 + length;
+
+        auto type = *pos++;
+        if (type == stringRecord) {
+            strings.emplace_back(pos, end - pos);
+            continue;
+        }
+        if (type < StreamEvent::Report || type > StreamEvent::Timeout) {
+            return false;
+        }
+        event.kind = static_cast<StreamEvent::Kind>(type);
+
+        uint64_t delta;
+        if (!get_var(pos, end, event.id) || !get_var(pos, end, delta) || pos >= end) {
+            return false;
+        }
+        lastTime += static_cast<int64_t>(delta >> 1) ^ -static_cast<int64_t>(delta & 1);
+        event.timestamp = static_cast<double>(lastTime) / 1e6;
+        event.succeeded = (*pos++ != 0);
+        event.name.clear();
+        event.description.clear();
+        event.msg = TestMessage();
+        event.elapsed = 0;
+        event.duration = 0;
+        event.durations.clear();
+        event.statistics.clear();
+
+        switch (event.kind) {
+        case StreamEvent::StartTest:
+        case StreamEvent::StartSuite:
+            if (!getString(pos, end, event.name) || !getString(pos, end, event.description)) {
+                return false;
+            }
+            break;
+        case StreamEvent::Report:
+        case StreamEvent::Error:
+        case StreamEvent::Failure:
+        case StreamEvent::Timeout: {
+            string message;
+            string detail;
+            string file;
+            uint64_t line;
+            if (!getString(pos, end, message) || !getString(pos, end, detail) || !getString(pos, end, file) || !get_var(pos, end, line)) {
+                return false;
+            }
+            event.msg = TestMessage(message, detail, file, static_cast<unsigned int>(line));
+            if (event.kind == StreamEvent::Timeout) {
+                uint64_t elapsed;
+                if (!get_var(pos, end, elapsed)) {
+                    return false;
+                }
+                event.elapsed = static_cast<double>(elapsed) / 1e6;
+            }
+        } break;
+        case StreamEvent::EndTest:
+        case StreamEvent::EndSuite: {
+            uint64_t duration;
+            uint64_t count;
+            if (!get_var(pos, end, duration) || !get_var(pos, end, count)) {
+                return false;
+            }
+            event.duration = static_cast<double>(duration) / 1e6;
+            for (uint64_t i = 0; i < count; i++) {
+                string phase;
+                uint64_t value;
+                if (!getString(pos, end, phase) || !get_var(pos, end, value)) {
+                    return false;
+                }
+                event.durations.emplace_back(phase, static_cast<double>(value) / 1e6);
+            }
+            if (!get_var(pos, end, count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; i++) {
+                string name;
+                uint64_t bits = 0;
+                if (!getString(pos, end, name) || end - pos < 8) {
+                    return false;
+                }
+                for (int j = 0; j < 8; j++) {
+                    bits |= static_cast<uint64_t>(static_cast<unsigned char>(*pos++)) << (8 * j);
+                }
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                event.statistics.emplace_back(name, value);
+            }
+        } break;
+        }
+        return true;
+    }
+    return false;
+}
+
+
+EventLogPlayer::EventLogPlayer(EventLogReader& reader) :
+        reader(reader),
+        interrupted(false)
+{
+}
+
+void EventLogPlayer::play(TestResult& result, bool realtime)
+{
+    result.startTestRunner();
+    auto origin = std::chrono::steady_clock::now();
+    double first = -1;
+    StreamEvent event;
+    while (!interrupted && reader.read(event)) {
+        if (realtime) {
+            if (first < 0) {
+                first = event.timestamp;
+            }
+            auto due = origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(event.timestamp - first));
+            // sleep by short steps to be interruptible
+            while (!interrupted && std::chrono::steady_clock::now() < due) {
+                std::this_thread::sleep_until(std::min(due, std::chrono::steady_clock::now() + std::chrono::milliseconds(100)));
+            }
+        }
+
+        bool begin = (event.kind == StreamEvent::StartTest || event.kind == StreamEvent::StartSuite);
+        auto itr = remotes.find(event.id);
+        RemoteTest* test;
+        if (itr == remotes.end() || begin) {
+            remoteTests.emplace_back(new RemoteTest(event.name, event.description));
+            test = remoteTests.back().get();
+            remotes[event.id] = test;
+        } else {
+            test = itr->second;
+        }
+        if (event.kind == StreamEvent::EndTest || event.kind == StreamEvent::EndSuite) {
+            test->update(event);
+        }
+        replayEvent(result, test, event);
+    }
+    result.endTestRunner();
+}
+
+void EventLogPlayer::interrupt()
+{
+    interrupted = true;
+}
@@ -0,0 +1,272 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/Asserter.h>
+
+#include <IsolatedTest.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#    include <csignal>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+
+#if !defined(_WIN32)
+static string describe_status(int status)
+{
+    if (status == -1) {
+        return "The test process has been terminated abnormally!";
+    }
+    if (WIFSIGNALED(status)) {
+        return Asserter::format("The test process has been terminated by signal %d (%s)!",
+                                WTERMSIG(status),
+                                strsignal(WTERMSIG(status)));
+    }
+    return Asserter::format("The test process exited with code %d before the end of the test!",
+                            WEXITSTATUS(status));
+}
+#endif
+
+
+IsolatedTest::IsolatedTest(TestCase* test, Zygote& zygote) :
+        Test(test->getName(), test->getDescription()),
+        test(test),
+        zygote(zygote),
+        successful(true),
+        inProcess(false),
+        controlFd(-1)
+{
+}
+
+
+IsolatedTest::~IsolatedTest() = default;
+
+
+TestCase* IsolatedTest::getTest() const
+{
+    return test;
+}
+
+
+bool IsolatedTest::succeeded() const
+{
+    return successful;
+}
+
+
+void IsolatedTest::interrupt()
+{
+    if (inProcess) {
+        test->interrupt();
+        return;
+    }
+#if !defined(_WIN32)
+    std::lock_guard<std::mutex> lock(mutex);
+    if (controlFd >= 0) {
+        char c = 1;
+        (void)::write(controlFd, &c, 1);
+    }
+#endif
+}
+
+
+void IsolatedTest::runInProcess(TestResult& result)
+{
+    inProcess = true;
+    test->run(result);
+    successful = test->succeeded();
+    setDuration(test->getDuration());
+    setDurations(test->getDurations());
+    setStatistics(test->getStatistics());
+    inProcess = false;
+}
+
+
+Test* IsolatedTest::resolve(const StreamEvent& event)
+{
+    if (event.id == reinterpret_cast<uintptr_t>(test)) {
+        return this;
+    }
+    bool start = (event.kind == StreamEvent::StartTest || event.kind == StreamEvent::StartSuite);
+    auto itr = remotes.find(event.id);
+    if (itr == remotes.end() || start) {
+        // the ids of the tests created within the child can be reused
+        remoteTests.emplace_back(new RemoteTest(event.name, event.description));
+        remotes[event.id] = remoteTests.back().get();
+        return remoteTests.back().get();
+    }
+    return itr->second;
+}
+
+
+void IsolatedTest::run(TestResult& result)
+{
+#if defined(_WIN32)
+    runInProcess(result);
+#else
+    if (!zygote.isRunning()) {
+        runInProcess(result);
+        return;
+    }
+
+    successful = true;
+    setDuration(0);
+    setDurations(DurationContainer());
+    setStatistics(StatisticContainer());
+    int events[2];
+    int control[2];
+    if (pipe(events) != 0) {
+        runInProcess(result);
+        return;
+    }
+    if (pipe(control) != 0) {
+        close(events[0]);
+        close(events[1]);
+        runInProcess(result);
+        return;
+    }
+
+    long pid = zygote.spawn(test, events[1], control[0]);
+    close(events[1]);
+    close(control[0]);
+    if (pid < 0) {
+        close(events[0]);
+        close(control[1]);
+        successful = false;
+        result.startTest(this);
+        result.addError(this, TestMessage("asserts error with exception",
+                                          "Cannot spawn the isolated test process!",
+                                          ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                          ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        result.endTest(this);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        controlFd = control[1];
+    }
+
+    // the child interrupts the test when its timeout expires; kill it
+    // if it does not stop within the grace period
+    auto start = std::chrono::steady_clock::now();
+    std::mutex watchMutex;
+    std::condition_variable watchCond;
+    bool done = false;
+    bool killed = false;
+    std::thread watchdog;
+    if (test->getTimeout() > 0) {
+        watchdog = std::thread([&]() {
+            std::unique_lock<std::mutex> lock(watchMutex);
+            auto deadline = std::chrono::duration<double>(test->getTimeout() + test->getTimeoutGrace());
+            if (!watchCond.wait_for(lock, deadline, [&]() { return done; })) {
+                killed = true;
+                ::kill(static_cast<pid_t>(pid), SIGKILL);
+            }
+        });
+    }
+
+    // replay the events of the child until it closes the stream,
+    // keeping the time at which they have been issued
+    bool started = false;
+    bool ended = false;
+    bool timedOut = false;
+    remotes.clear();
+    EventStreamReader reader(events[0]);
+    StreamEvent event;
+    while (reader.read(event)) {
+        Test* owner = resolve(event);
+        if (owner != this && (event.kind == StreamEvent::EndTest || event.kind == StreamEvent::EndSuite)) {
+            static_cast<RemoteTest*>(owner)->update(event);
+        }
+        if (owner == this) {
+            started |= (event.kind == StreamEvent::StartTest);
+            timedOut |= (event.kind == StreamEvent::Timeout);
+            if (event.kind == StreamEvent::EndTest) {
+                successful = event.succeeded;
+                setDuration(event.duration);
+                setDurations(event.durations);
+                setStatistics(event.statistics);
+                ended = true;
+            }
+        }
+        replayEvent(result, owner, event);
+    }
+    close(events[0]);
+
+    if (watchdog.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(watchMutex);
+            done = true;
+        }
+        watchCond.notify_all();
+        watchdog.join();
+    }
+
+    int status = zygote.wait(pid);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        close(controlFd);
+        controlFd = -1;
+    }
+
+    if (!ended) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        successful = false;
+        setDuration(elapsed);
+        if (!started) {
+            result.startTest(this);
+        }
+        if (killed) {
+            if (!timedOut) {
+                result.addTimeout(this,
+                                  TestMessage("timeout",
+                                              Asserter::format("The test exceeded its timeout of %.3f s after %.3f s",
+                                                               test->getTimeout(),
+                                                               elapsed),
+                                              ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                              ROBOTTESTINGFRAMEWORK_SOURCELINE()),
+                                  elapsed);
+            }
+            result.addError(this,
+                            TestMessage("timeout",
+                                        Asserter::format("The test did not stop within %.3f s after being interrupted. The test process has been killed!",
+                                                         test->getTimeoutGrace()),
+                                        ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                        ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        } else {
+            result.addError(this, TestMessage("asserts error with exception",
+                                              describe_status(status),
+                                              ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                              ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        }
+        result.endTest(this);
+    }
+#endif
+}
@@ -0,0 +1,192 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestListenerAdapter.h>
+
+#include <JSONStreamOutputter.h>
+#include <json.hpp>
+
+using namespace robottestingframework;
+using namespace std;
+using namespace json;
+
+#define MSG_ERROR "ERROR"
+#define MSG_FAIL "FAIL"
+#define MSG_REPORT "INFO"
+
+JSONStreamOutputter::JSONStreamOutputter(bool verbose) :
+        StreamOutputter(verbose),
+        test(new JSON()),
+        suites(new JSON(Array())),
+        firstTest(true)
+{
+}
+
+JSONStreamOutputter::~JSONStreamOutputter()
+{
+    close();
+}
+
+void JSONStreamOutputter::begin()
+{
+    append("{\n  \"tests\" : [", false);
+}
+
+void JSONStreamOutputter::handle(ResultEvent::Kind kind,
+                                 const Test* t,
+                                 const TestMessage& msg,
+                                 double elapsed)
+{
+    switch (kind) {
+    case ResultEvent::Kind::EndSuite: {
+        TestOutcome outcome = TestListenerAdapter::outcomeOf(t);
+        JSON suite;
+        if (outcome.succeeded()) {
+            suite["result"] = "passed!";
+        } else {
+            suite["result"] = "failed!";
+        }
+        suite["name"] = t->getName();
+        suite["duration"] = outcome.getDuration();
+        // the empty objects are omitted
+        if (!outcome.getDurations().empty()) {
+            suite["durations"] = Object();
+            for (const auto& phase : outcome.getDurations()) {
+                suite["durations"][phase.first] = phase.second;
+            }
+        }
+        suites->append(suite);
+        // the trailer holds the suites
+        append("");
+        break;
+    }
+
+    // start test
+    case ResultEvent::Kind::StartTest: {
+        *test = Object();
+        (*test)["reports"] = Array();
+        (*test)["timestamp"] = this->elapsed();
+        break;
+    }
+    case ResultEvent::Kind::EndTest: {
+        TestOutcome outcome = TestListenerAdapter::outcomeOf(t);
+        if (outcome.succeeded()) {
+            (*test)["result"] = "passed!";
+        } else {
+            (*test)["result"] = "failed!";
+        }
+        (*test)["name"] = t->getName();
+        (*test)["duration"] = outcome.getDuration();
+        // the empty objects are omitted
+        if (!outcome.getDurations().empty()) {
+            (*test)["durations"] = Object();
+            for (const auto& phase : outcome.getDurations()) {
+                (*test)["durations"][phase.first] = phase.second;
+            }
+        }
+        if (!outcome.getStatistics().empty()) {
+            (*test)["statistics"] = Object();
+            for (const auto& statistic : outcome.getStatistics()) {
+                (*test)["statistics"][statistic.first] = statistic.second;
+            }
+        }
+        append((firstTest ? "" : ", ") + test->dump(3));
+        firstTest = false;
+        *test = JSON();
+        break;
+    }
+
+    // report event
+    case ResultEvent::Kind::Report: {
+        if (msg.getDetail() != " ") {
+            string text = msg.getMessage() + ": " + msg.getDetail();
+            if (verbose && msg.getSourceLineNumber() != 0) {
+                text += Asserter::format(" at %d.", msg.getSourceLineNumber());
+            }
+            addMessage(MSG_REPORT, text);
+        }
+        break;
+    }
+
+    // failure event
+    case ResultEvent::Kind::Failure: {
+        string text = msg.getMessage() + ": " + msg.getDetail();
+        if (verbose && msg.getSourceLineNumber() != 0) {
+            text += Asserter::format(" at %d.", msg.getSourceLineNumber());
+        }
+        addMessage(MSG_FAIL, text);
+        break;
+    }
+
+    // error event
+    case ResultEvent::Kind::Error:
+    case ResultEvent::Kind::Timeout: {
+        string text = msg.getMessage() + ": " + msg.getDetail();
+        if (verbose && msg.getSourceLineNumber() != 0) {
+            text += Asserter::format(" at %d.", msg.getSourceLineNumber());
+        }
+        addMessage(MSG_ERROR, text, (kind == ResultEvent::Kind::Timeout) ? elapsed : -1);
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+std::string JSONStreamOutputter::trailer() const
+{
+    JSON summary = Object();
+    if (nTestSuites) {
+        summary["suite_total_count"] = nTestSuites;
+        summary["suite_count_passed"] = nSuitePasses;
+        summary["suite_count_failed"] = nSuiteFailures;
+    }
+    summary["tests_total_count"] = nTests;
+    summary["tests_count_passed"] = nPasses;
+    summary["tests_count_failed"] = nFailures;
+    summary["duration"] = duration();
+
+    string text = "],\n";
+    if (nTestSuites) {
+        text += "  \"suites\" : " + suites->dump(2) + ",\n";
+    }
+    text += "  \"summary\" : " + summary.dump(2) + "\n}\n";
+    return text;
+}
+
+void JSONStreamOutputter::addMessage(const char* type, const std::string& msg, double elapsed)
+{
+    // the messages issued out of a test case are not written
+    if (test->JSONType() != JSON::Class::Object) {
+        return;
+    }
+    JSON report;
+    report["type"] = type;
+    report["msg"] = msg;
+    report["timestamp"] = this->elapsed();
+    // the time elapsed since the test was started, for a timeout
+    if (elapsed >= 0) {
+        report["elapsed"] = elapsed;
+    }
+    (*test)["reports"].append(report);
+}
@@ -0,0 +1,246 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestListenerAdapter.h>
+
+#include <JUnitStreamOutputter.h>
+
+using namespace robottestingframework;
+using namespace std;
+
+#define MSG_ERROR "[ERROR] ("
+#define MSG_FAIL "[FAIL]  ("
+#define MSG_REPORT "[INFO]  ("
+
+// escapes the text as TinyXML does
+static string escape(const string& text)
+{
+    string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '&':
+            escaped += "&amp;";
+            break;
+        case '<':
+            escaped += "&lt;";
+            break;
+        case '>':
+            escaped += "&gt;";
+            break;
+        case '"':
+            escaped += "&quot;";
+            break;
+        case '\'':
+            escaped += "&apos;";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 32) {
+                escaped += Asserter::format("&#x%02X;", static_cast<unsigned int>(c));
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped;
+}
+
+static string format_message(const TestMessage& msg, bool verbose)
+{
+    if (verbose) {
+        return Asserter::format("%s : %s (%s at %d) <br>",
+                                msg.getMessage().c_str(),
+                                msg.getDetail().c_str(),
+                                msg.getSourceFileName().c_str(),
+                                msg.getSourceLineNumber());
+    }
+    return msg.getMessage() + ": " + msg.getDetail() + "\n";
+}
+
+JUnitStreamOutputter::JUnitStreamOutputter(bool verbose) :
+        StreamOutputter(verbose),
+        suiteOpen(false),
+        suiteWritten(false),
+        defaultSuite(false),
+        rootOffset(0),
+        suiteOffset(0)
+{
+}
+
+JUnitStreamOutputter::~JUnitStreamOutputter()
+{
+    close();
+}
+
+void JUnitStreamOutputter::begin()
+{
+    // the attributes are inserted before the '>' once they are known
+    append("<testsuites>\n", false);
+    rootOffset = position() - 2;
+}
+
+void JUnitStreamOutputter::handle(ResultEvent::Kind kind,
+                                  const Test* test,
+                                  const TestMessage& msg,
+                                  double elapsed)
+{
+    switch (kind) {
+    // start suite
+    case ResultEvent::Kind::StartSuite:
+        if (suiteOpen) {
+            closeSuite(this->elapsed());
+        }
+        openSuite(test->getName());
+        break;
+
+    // end suite
+    case ResultEvent::Kind::EndSuite:
+        if (suiteOpen) {
+            closeSuite(TestListenerAdapter::outcomeOf(test).getDuration());
+        }
+        break;
+
+    // start test case
+    case ResultEvent::Kind::StartTest:
+        // If there is not any test suite, add one!
+        if (!suiteOpen) {
+            openSuite("default");
+            defaultSuite = true;
+        }
+        errorMessages.clear();
+        failureMessages.clear();
+        reportsMessages.clear();
+        break;
+
+    // end test case
+    case ResultEvent::Kind::EndTest: {
+        TestOutcome outcome = TestListenerAdapter::outcomeOf(test);
+        // the suite is written with its first test case
+        string record;
+        if (!suiteWritten) {
+            record = "    <testsuite name=\"" + escape(classname) + "\">\n";
+            suiteOffset = position() + static_cast<streamoff>(record.size()) - 2;
+            suiteWritten = true;
+        }
+        record += "        <testcase name=\"" + escape(test->getName())
+            + "\" classname=\"" + escape(classname + "." + test->getName())
+            + "\" time=\"" + Asserter::format("%.3f", outcome.getDuration()) + "\"";
+        if (outcome.getStatistics().empty() && failureMessages.empty()
+            && errorMessages.empty() && reportsMessages.empty()) {
+            record += " />\n";
+        } else {
+            record += ">\n";
+
+            // adding statistics (e.g., of a benchmark)
+            if (!outcome.getStatistics().empty()) {
+                record += "            <properties>\n";
+                for (const auto& statistic : outcome.getStatistics()) {
+                    record += "                <property name=\"" + escape(statistic.first)
+                        + "\" value=\"" + Asserter::format("%.9g", statistic.second) + "\" />\n";
+                }
+                record += "            </properties>\n";
+            }
+
+            // adding falures
+            if (failureMessages.size()) {
+                record += "            <failure message=\"Something went wrong. See Stacktrace for detail.\">"
+                    + escape(failureMessages) + "</failure>\n";
+            }
+
+            // adding errors
+            if (errorMessages.size()) {
+                record += "            <error message=\"Something went wrong. See Stacktrace for detail.\">"
+                    + escape(errorMessages) + "</error>\n";
+            }
+
+            // adding reports
+            if (reportsMessages.size()) {
+                record += "            <system-out message=\"See Standard Output for detail.\">"
+                    + escape(reportsMessages) + "</system-out>\n";
+            }
+            record += "        </testcase>\n";
+        }
+        errorMessages.clear();
+        failureMessages.clear();
+        reportsMessages.clear();
+        append(record);
+        break;
+    }
+
+    // failure event
+    case ResultEvent::Kind::Failure: {
+        string text = format_message(msg, verbose);
+        failureMessages += text;
+        reportsMessages += MSG_FAIL + test->getName() + ") " + text;
+        break;
+    }
+
+    // error event
+    case ResultEvent::Kind::Error:
+    case ResultEvent::Kind::Timeout: {
+        string text = format_message(msg, verbose);
+        errorMessages += text;
+        reportsMessages += MSG_ERROR + test->getName() + ") " + text;
+        break;
+    }
+
+    // report event
+    case ResultEvent::Kind::Report:
+        reportsMessages += MSG_REPORT + test->getName() + ") " + format_message(msg, verbose);
+        break;
+    }
+}
+
+void JUnitStreamOutputter::finish()
+{
+    // the default suite lasts as the whole run
+    if (suiteOpen) {
+        closeSuite(defaultSuite ? duration() : elapsed());
+    }
+    replace(rootOffset, 0, Asserter::format(" suites=\"%u\" tests=\"%u\" failures=\"%u\" time=\"%.3f\"", nTestSuites, nTests, nFailures, duration()));
+}
+
+std::string JUnitStreamOutputter::trailer() const
+{
+    return suiteWritten ? "    </testsuite>\n</testsuites>\n" : "</testsuites>\n";
+}
+
+void JUnitStreamOutputter::openSuite(const std::string& name)
+{
+    // the suite is written with its first test case or when it is closed
+    classname = name;
+    suiteOpen = true;
+}
+
+void JUnitStreamOutputter::closeSuite(double time)
+{
+    string attributes = " time=\"" + Asserter::format("%.3f", time) + "\"";
+    suiteOpen = false;
+    defaultSuite = false;
+    if (suiteWritten) {
+        replace(suiteOffset, 0, attributes);
+        suiteWritten = false;
+        append("    </testsuite>\n");
+    } else {
+        append("    <testsuite name=\"" + escape(classname) + "\"" + attributes + " />\n");
+    }
+}
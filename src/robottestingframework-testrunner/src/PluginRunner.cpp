@@ -26,14 +26,25 @@
 #include <PluginFactory.h>
 #include <PluginRunner.h>
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <numeric>
+#include <sstream>
 
 using namespace std;
 using namespace robottestingframework;
 using namespace robottestingframework::plugin;
 
 PluginRunner::PluginRunner(bool verbose) :
-        verbose(verbose)
+        verbose(verbose),
+        isolated(false),
+        timeout(0),
+        benchmark(false),
+        warmup(0),
+        aggregation(false),
+        checkKeep(1),
+        shardIndex(0),
+        shardCount(1)
 {
 }
 
@@ -47,11 +58,21 @@ void PluginRunner::reset()
     // first reset the TestRunner
     TestRunner::reset();
 
+    // stop the zygote and delete the isolated tests
+    zygote.stop();
+    for (auto& isolatedTest : isolatedTests) {
+        delete isolatedTest;
+    }
+    isolatedTests.clear();
+
     // delete all the plugin loader which was created
     for (auto& dllLoader : dllLoaders) {
         delete dllLoader;
     }
     dllLoaders.clear();
+
+    shardLoads.clear();
+    durationKeys.clear();
 }
 
 
@@ -65,6 +86,271 @@ const std::string& PluginRunner::getPythonVenv() const
     return pythonVenv;
 }
 
+void PluginRunner::setIsolated(bool isolated)
+{
+    this->isolated = isolated;
+}
+
+bool PluginRunner::isIsolated() const
+{
+    return isolated;
+}
+
+void PluginRunner::setTimeout(double timeout)
+{
+    this->timeout = timeout;
+}
+
+double PluginRunner::getTimeout() const
+{
+    return timeout;
+}
+
+void PluginRunner::setBenchmark(bool enabled, unsigned int warmup)
+{
+    benchmark = enabled;
+    this->warmup = warmup;
+}
+
+bool PluginRunner::isBenchmark() const
+{
+    return benchmark;
+}
+
+unsigned int PluginRunner::getWarmup() const
+{
+    return warmup;
+}
+
+void PluginRunner::setCheckAggregation(bool enabled, unsigned int keep)
+{
+    aggregation = enabled;
+    checkKeep = keep;
+}
+
+bool PluginRunner::isCheckAggregation() const
+{
+    return aggregation;
+}
+
+unsigned int PluginRunner::getCheckKeep() const
+{
+    return checkKeep;
+}
+
+void PluginRunner::setFilter(const TestFilter& filter)
+{
+    this->filter = filter;
+}
+
+const TestFilter& PluginRunner::getFilter() const
+{
+    return filter;
+}
+
+void PluginRunner::setShard(unsigned int index, unsigned int count)
+{
+    shardIndex = index;
+    shardCount = (count > 0) ? count : 1;
+    shardLoads.clear();
+}
+
+unsigned int PluginRunner::getShardIndex() const
+{
+    return shardIndex;
+}
+
+unsigned int PluginRunner::getShardCount() const
+{
+    return shardCount;
+}
+
+void PluginRunner::setDurationRoot(const std::string& path)
+{
+    durationRoot = path;
+    if (durationRoot.size() && durationRoot.rfind(PATH_SEPERATOR) != durationRoot.size() - 1) {
+        durationRoot += PATH_SEPERATOR;
+    }
+}
+
+std::string PluginRunner::durationKey(const std::string& filename) const
+{
+    string key;
+    if (durationRoot.size() && filename.compare(0, durationRoot.size(), durationRoot) == 0) {
+        key = filename.substr(durationRoot.size());
+    } else {
+        size_t pos = filename.find_last_of("/\\");
+        key = (pos == string::npos) ? filename : filename.substr(pos + 1);
+    }
+    // the same key on every platform
+    std::replace(key.begin(), key.end(), '\\', '/');
+    return key;
+}
+
+bool PluginRunner::readDurations(const std::string& filename,
+                                 std::map<std::string, double>& durations)
+{
+    ifstream file(filename);
+    if (!file.is_open()) {
+        return true;
+    }
+
+    string line;
+    unsigned int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        if (line.empty()) {
+            continue;
+        }
+        istringstream entry(line);
+        double duration;
+        string key;
+        if (!(entry >> duration) || !getline(entry >> ws, key) || key.empty() || duration < 0) {
+            ErrorLogger::Instance().addError(Asserter::format("Invalid entry in the durations file '%s' at line %u",
+                                                              filename.c_str(),
+                                                              lineNumber));
+            return false;
+        }
+        durations[key] = duration;
+    }
+    return true;
+}
+
+bool PluginRunner::writeDurations(const std::string& filename,
+                                  const std::map<std::string, double>& durations)
+{
+    ofstream file(filename);
+    if (!file.is_open()) {
+        ErrorLogger::Instance().addError("cannot write the durations file " + filename);
+        return false;
+    }
+    for (auto& duration : durations) {
+        file << Asserter::format("%.6f", duration.second) << " " << duration.first << endl;
+    }
+    return true;
+}
+
+bool PluginRunner::loadDurations(const std::string& filename)
+{
+    durationsFile = filename;
+    return readDurations(filename, durations);
+}
+
+bool PluginRunner::saveDurations(const std::string& filename)
+{
+    // the shards balanced on the loaded file must keep seeing the same one
+    if (filename == durationsFile) {
+        ErrorLogger::Instance().addError("the durations file " + filename + " is only read, the measured durations must be saved to another file");
+        return false;
+    }
+
+    map<string, double> measured;
+    for (auto& durationKey : durationKeys) {
+        if (durationKey.first->getDuration() > 0) {
+            measured[durationKey.second] = durationKey.first->getDuration();
+        }
+    }
+    return writeDurations(filename, measured);
+}
+
+bool PluginRunner::mergeDurations(const std::vector<std::string>& filenames,
+                                  const std::string& output)
+{
+    map<string, double> merged;
+    for (auto& filename : filenames) {
+        if (!readDurations(filename, merged)) {
+            return false;
+        }
+    }
+    return writeDurations(output, merged);
+}
+
+std::vector<std::pair<std::string, double>> PluginRunner::getPlan() const
+{
+    double average = averageDuration();
+    vector<pair<string, double>> plan;
+    for (auto& durationKey : durationKeys) {
+        auto duration = durations.find(durationKey.second);
+        plan.emplace_back(durationKey.first->getName(), (duration != durations.end()) ? duration->second : average);
+    }
+    return plan;
+}
+
+double PluginRunner::averageDuration() const
+{
+    if (durations.empty()) {
+        return -1;
+    }
+    return std::accumulate(durations.begin(), durations.end(), 0.0, [](double sum, const std::pair<const string, double>& duration) {
+               return sum + duration.second;
+           })
+         / durations.size();
+}
+
+void PluginRunner::addDurationKey(const Test* test, const std::string& filename)
+{
+    durationKeys.emplace_back(test, durationKey(filename));
+}
+
+std::vector<std::string> PluginRunner::selectShard(std::vector<std::string> filenames)
+{
+    std::sort(filenames.begin(), filenames.end());
+    if (shardCount <= 1) {
+        return filenames;
+    }
+
+    // the files without a recorded duration are expected to last
+    // as the average of the recorded ones
+    double average = averageDuration();
+    if (average < 0) {
+        average = 1.0;
+    }
+    vector<pair<double, string>> weighted;
+    for (auto& filename : filenames) {
+        auto duration = durations.find(durationKey(filename));
+        weighted.emplace_back((duration != durations.end()) ? duration->second : average, filename);
+    }
+
+    // assign the longest files first to the least loaded shard
+    std::stable_sort(weighted.begin(), weighted.end(), [](const pair<double, string>& a, const pair<double, string>& b) {
+        return a.first > b.first;
+    });
+    shardLoads.resize(shardCount, 0);
+    vector<string> selected;
+    for (auto& file : weighted) {
+        auto shard = static_cast<unsigned int>(std::min_element(shardLoads.begin(), shardLoads.end()) - shardLoads.begin());
+        shardLoads[shard] += file.first;
+        if (shard == shardIndex) {
+            selected.push_back(file.second);
+        }
+    }
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
+
+bool PluginRunner::startIsolation()
+{
+    if (!zygote.start()) {
+#if defined(_WIN32)
+        ErrorLogger::Instance().addWarning("the test isolation is not supported on this platform");
+#else
+        ErrorLogger::Instance().addWarning("cannot start the zygote process for the test isolation");
+#endif
+        return false;
+    }
+    return true;
+}
+
+Test* PluginRunner::isolate(TestCase* test)
+{
+    if (!isolated) {
+        return test;
+    }
+    auto* isolatedTest = new IsolatedTest(test, zygote);
+    isolatedTests.push_back(isolatedTest);
+    return isolatedTest;
+}
+
 bool PluginRunner::loadPlugin(std::string filename,
                               const unsigned int repetition,
                               const std::string param,
@@ -86,9 +372,14 @@ bool PluginRunner::loadPlugin(std::string filename,
     test->setParam(param);
     test->setEnvironment(environment);
     test->setRepetition(repetition);
+    test->setTimeout(timeout);
+    test->setBenchmark(benchmark, warmup);
+    test->setCheckAggregation(aggregation, checkKeep);
 
     // add the test case to the TestRunner
-    addTest(test);
+    Test* runnable = isolate(test);
+    addTest(runnable);
+    addDurationKey(runnable, filename);
 
     // keep track of what have been created
     dllLoaders.push_back(loader);
@@ -99,35 +390,30 @@ bool PluginRunner::loadPlugin(std::string filename,
 bool PluginRunner::loadMultiplePlugins(std::string path,
                                        bool recursive)
 {
-    if (!recursive) {
-        return loadPluginsFromPath(path);
-    }
-
-    // load from subfolders
-    if ((path.rfind(PATH_SEPERATOR) == string::npos) || (path.rfind(PATH_SEPERATOR) != path.size() - 1)) {
-        path = path + string(PATH_SEPERATOR);
-    }
-
-    DIR* dir;
-    struct dirent* entry;
-    if ((dir = opendir(path.c_str())) == nullptr) {
-        ErrorLogger::Instance().addError("cannot access " + path);
+    vector<string> filenames;
+    if (!findPlugins(path, recursive, filenames)) {
         return false;
     }
 
-    loadPluginsFromPath(path);
+    // select the plugins by their file names before opening them
+    auto unselected = [this](const string& filename) {
+        vector<string> names = TestFilter::fileNames(filename);
+        return !filter.selects(names) || filter.excludes(names) || !filter.selectsTags("");
+    };
+    filenames.erase(std::remove_if(filenames.begin(), filenames.end(), unselected), filenames.end());
 
-    while ((entry = readdir(dir)) != nullptr) {
-        if ((entry->d_type == DT_DIR) && (string(entry->d_name) != string(".")) && (string(entry->d_name) != string(".."))) {
-            string name = path + string(entry->d_name);
-            loadMultiplePlugins(name, recursive);
-        }
+    // load only the plugins of the current shard
+    setDurationRoot(path);
+    for (auto& filename : selectShard(filenames)) {
+        loadPlugin(filename, 0);
     }
-    closedir(dir);
+    setDurationRoot("");
     return true;
 }
 
-bool PluginRunner::loadPluginsFromPath(std::string path)
+bool PluginRunner::findPlugins(std::string path,
+                               bool recursive,
+                               std::vector<std::string>& filenames)
 {
     if (verbose) {
         cout << "Loading plug-ins from " << path << endl;
@@ -146,16 +432,21 @@ bool PluginRunner::loadPluginsFromPath(std::string path)
 
     while ((entry = readdir(dir)) != nullptr) {
         string name = entry->d_name;
+        // search into subfolders
+        if (recursive && (entry->d_type == DT_DIR) && (name != string(".")) && (name != string(".."))) {
+            findPlugins(path + name, recursive, filenames);
+            continue;
+        }
         if (name.size() > 4) {
             // check for windows .dll
             string ext = name.substr(name.size() - 4, 4);
             if (PluginFactory::compare(ext.c_str(), ".dll")) {
-                loadPlugin(path + name, 0);
+                filenames.push_back(path + name);
             }
             // check for .lua plugin files
 #ifdef ENABLE_LUA_PLUGIN
             if (PluginFactory::compare(ext.c_str(), ".lua")) {
-                loadPlugin(path + name, 0);
+                filenames.push_back(path + name);
             }
 #endif
         }
@@ -163,7 +454,7 @@ bool PluginRunner::loadPluginsFromPath(std::string path)
             // check for unix .so
             string ext = name.substr(name.size() - 3, 3);
             if (PluginFactory::compare(ext.c_str(), ".so")) {
-                loadPlugin(path + name, 0);
+                filenames.push_back(path + name);
             }
         }
 #ifdef ENABLE_PYTHON_PLUGIN
@@ -171,7 +462,7 @@ bool PluginRunner::loadPluginsFromPath(std::string path)
         if (name.size() > 2) {
             string ext = name.substr(name.size() - 3, 3);
             if (PluginFactory::compare(ext.c_str(), ".py")) {
-                loadPlugin(path + name, 0);
+                filenames.push_back(path + name);
             }
         }
 #endif
@@ -180,7 +471,7 @@ bool PluginRunner::loadPluginsFromPath(std::string path)
         if (name.size() > 2) {
             string ext = name.substr(name.size() - 3, 3);
             if (PluginFactory::compare(ext.c_str(), ".rb")) {
-                loadPlugin(path + name, 0);
+                filenames.push_back(path + name);
             }
         }
 #endif
@@ -0,0 +1,441 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestResult.h>
+
+#include <ShardDashboard.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#if !defined(_WIN32)
+#    include <cerrno>
+#    include <csignal>
+#    include <poll.h>
+#    include <sys/socket.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+
+// The header sent by a shard before its events:
+//   RTFSHARD 1
+//   name <name>
+//   plan <expected duration> <name>    (one line per planned test or suite)
+//   <empty line>
+static const char shardMagic[] = "RTFSHARD 1";
+static const size_t maxHeaderSize = 1 << 20;
+
+
+#if !defined(_WIN32)
+static bool unix_address(const string& path, struct sockaddr_un& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+static bool send_all(int fd, const char* data, size_t size)
+{
+    while (size > 0) {
+        auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+#endif
+
+// the names are sent one per line
+static string single_line(string text)
+{
+    for (auto& c : text) {
+        if (c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+    return text;
+}
+
+
+ShardPublisher::ShardPublisher() :
+        fd(-1)
+{
+}
+
+ShardPublisher::~ShardPublisher()
+{
+    writer.reset();
+#if !defined(_WIN32)
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+}
+
+bool ShardPublisher::connect(const string& path,
+                             const string& name,
+                             const ShardPlan& plan,
+                             TestMessage* errorMsg)
+{
+#if defined(_WIN32)
+    if (errorMsg != nullptr) {
+        errorMsg->setMessage("Cannot publish the events to " + path);
+        errorMsg->setDetail("The dashboard is not supported on this platform");
+    }
+    return false;
+#else
+    struct sockaddr_un addr;
+    int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conn < 0 || !unix_address(path, addr) || ::connect(conn, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot connect to the dashboard " + path);
+            errorMsg->setDetail(strerror(errno));
+        }
+        if (conn >= 0) {
+            close(conn);
+        }
+        return false;
+    }
+
+    string header = string(shardMagic) + "\nname " + single_line(name) + "\n";
+    for (const auto& item : plan) {
+        header += Asserter::format("plan %.6f ", item.second) + single_line(item.first) + "\n";
+    }
+    header += "\n";
+    // a dashboard which stops must not kill the shard
+    signal(SIGPIPE, SIG_IGN);
+    if (!send_all(conn, header.data(), header.size())) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot announce the shard to the dashboard " + path);
+            errorMsg->setDetail(strerror(errno));
+        }
+        close(conn);
+        return false;
+    }
+    fd = conn;
+    writer.reset(new EventStreamWriter(fd));
+    return true;
+#endif
+}
+
+TestListener* ShardPublisher::getListener()
+{
+    return writer.get();
+}
+
+
+ShardDashboard::ShardDashboard(ListenerFactory factory) :
+        factory(std::move(factory)),
+        sock(-1),
+        interrupted(false),
+        finished(0),
+        tests(0),
+        failedTests(0),
+        suites(0),
+        failedSuites(0)
+{
+}
+
+ShardDashboard::~ShardDashboard()
+{
+    interrupt();
+    disconnectAll();
+    for (auto& receiver : receivers) {
+        receiver.join();
+    }
+#if !defined(_WIN32)
+    if (sock >= 0) {
+        close(sock);
+        unlink(path.c_str());
+    }
+#endif
+}
+
+bool ShardDashboard::listen(const string& path, TestMessage* errorMsg)
+{
+#if defined(_WIN32)
+    if (errorMsg != nullptr) {
+        errorMsg->setMessage("Cannot listen to " + path);
+        errorMsg->setDetail("The dashboard is not supported on this platform");
+    }
+    return false;
+#else
+    struct sockaddr_un addr;
+    if (!unix_address(path, addr)) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot listen to " + path);
+            errorMsg->setDetail("Invalid socket path");
+        }
+        return false;
+    }
+    unlink(path.c_str());
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0 || bind(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(sock, 16) != 0) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot listen to " + path);
+            errorMsg->setDetail(strerror(errno));
+        }
+        if (sock >= 0) {
+            close(sock);
+            sock = -1;
+        }
+        return false;
+    }
+    this->path = path;
+    return true;
+#endif
+}
+
+void ShardDashboard::serve(unsigned int count)
+{
+#if !defined(_WIN32)
+    // accept the shards by short steps to be interruptible
+    while (!interrupted && finished < count && sock >= 0) {
+        struct pollfd pfd;
+        pfd.fd = sock;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 200) <= 0 || (pfd.revents & POLLIN) == 0) {
+            continue;
+        }
+        int conn = accept(sock, nullptr, nullptr);
+        if (conn < 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.push_back(conn);
+        receivers.emplace_back(&ShardDashboard::receive, this, conn);
+    }
+    // the shards which are still connected are stopped once interrupted
+    if (interrupted) {
+        disconnectAll();
+    }
+    for (auto& receiver : receivers) {
+        receiver.join();
+    }
+    receivers.clear();
+#endif
+}
+
+void ShardDashboard::interrupt()
+{
+    interrupted = true;
+}
+
+void ShardDashboard::disconnectAll()
+{
+#if !defined(_WIN32)
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int conn : connections) {
+        shutdown(conn, SHUT_RDWR);
+    }
+#endif
+}
+
+unsigned int ShardDashboard::shardCount() const
+{
+    return finished;
+}
+
+unsigned int ShardDashboard::testCount() const
+{
+    return tests;
+}
+
+unsigned int ShardDashboard::failedCount() const
+{
+    return failedTests;
+}
+
+unsigned int ShardDashboard::suiteCount() const
+{
+    return suites;
+}
+
+unsigned int ShardDashboard::failedSuiteCount() const
+{
+    return failedSuites;
+}
+
+bool ShardDashboard::readHeader(int conn, string& name, ShardPlan& plan)
+{
+#if defined(_WIN32)
+    return false;
+#else
+    // read up to the empty line, without reading any event
+    string header;
+    char c;
+    while (header.size() < maxHeaderSize) {
+        auto n = ::read(conn, &c, 1);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        header.push_back(c);
+        if (header.size() >= 2 && header.compare(header.size() - 2, 2, "\n\n") == 0) {
+            break;
+        }
+    }
+
+    istringstream lines(header);
+    string line;
+    if (!getline(lines, line) || line != shardMagic) {
+        return false;
+    }
+    while (getline(lines, line) && !line.empty()) {
+        if (line.compare(0, 5, "name ") == 0) {
+            name = line.substr(5);
+        } else if (line.compare(0, 5, "plan ") == 0) {
+            istringstream entry(line.substr(5));
+            double expected;
+            string item;
+            if (!(entry >> expected) || !getline(entry >> ws, item)) {
+                return false;
+            }
+            plan.emplace_back(item, expected);
+        }
+    }
+    return true;
+#endif
+}
+
+void ShardDashboard::receive(int conn)
+{
+    string name;
+    ShardPlan plan;
+    if (!readHeader(conn, name, plan)) {
+        cout << "[robottestingframework-testrunner] ignoring an invalid shard connection" << endl;
+        disconnect(conn);
+        return;
+    }
+
+    TestResult result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        TestListener* listener = factory(name, plan);
+        if (listener != nullptr) {
+            listeners.emplace_back(listener);
+            result.addListener(listener);
+        }
+        cout << "[robottestingframework-testrunner] " << name << " connected" << endl;
+    }
+
+    // replay the events of the shard as in EventLogPlayer
+    result.startTestRunner();
+    EventStreamReader reader(conn);
+    StreamEvent event;
+    map<uint64_t, RemoteTest*> remotes;
+    vector<unique_ptr<RemoteTest>> remoteTests;
+    vector<pair<RemoteTest*, bool>> running;
+    while (reader.read(event)) {
+        bool begin = (event.kind == StreamEvent::StartTest || event.kind == StreamEvent::StartSuite);
+        bool end = (event.kind == StreamEvent::EndTest || event.kind == StreamEvent::EndSuite);
+        auto itr = remotes.find(event.id);
+        RemoteTest* test;
+        if (itr == remotes.end() || begin) {
+            remoteTests.emplace_back(new RemoteTest(event.name, event.description));
+            test = remoteTests.back().get();
+            remotes[event.id] = test;
+        } else {
+            test = itr->second;
+        }
+        if (begin) {
+            running.emplace_back(test, event.kind == StreamEvent::StartSuite);
+        }
+        if (end) {
+            test->update(event);
+            for (auto it = running.rbegin(); it != running.rend(); ++it) {
+                if (it->first == test) {
+                    running.erase(std::next(it).base());
+                    break;
+                }
+            }
+            if (event.kind == StreamEvent::EndTest) {
+                tests++;
+                failedTests += event.succeeded ? 0 : 1;
+            } else {
+                suites++;
+                failedSuites += event.succeeded ? 0 : 1;
+            }
+        }
+        replayEvent(result, test, event);
+    }
+
+    // the tests which are still running have been stopped with the shard
+    bool lost = !running.empty();
+    while (!running.empty()) {
+        RemoteTest* test = running.back().first;
+        bool suite = running.back().second;
+        running.pop_back();
+        result.addError(test, TestMessage("asserts error with exception",
+                                          "The shard has been disconnected before the end of the test!",
+                                          ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                          ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        StreamEvent failed;
+        failed.kind = suite ? StreamEvent::EndSuite : StreamEvent::EndTest;
+        failed.succeeded = false;
+        failed.duration = 0;
+        test->update(failed);
+        if (suite) {
+            suites++;
+            failedSuites++;
+            result.endTestSuite(test);
+        } else {
+            tests++;
+            failedTests++;
+            result.endTest(test);
+        }
+    }
+    result.endTestRunner();
+
+    disconnect(conn);
+    std::lock_guard<std::mutex> lock(mutex);
+    cout << "[robottestingframework-testrunner] " << name << (lost ? " disconnected" : " finished") << endl;
+    finished++;
+}
+
+void ShardDashboard::disconnect(int conn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    connections.erase(std::remove(connections.begin(), connections.end(), conn), connections.end());
+#if !defined(_WIN32)
+    close(conn);
+#endif
+}
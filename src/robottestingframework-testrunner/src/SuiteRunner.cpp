@@ -26,6 +26,7 @@
 #include <PlatformDir.h>
 #include <PluginFactory.h>
 #include <SuiteRunner.h>
+#include <algorithm>
 #include <tinyxml.h>
 
 using namespace std;
@@ -34,7 +35,8 @@ using namespace robottestingframework::plugin;
 
 SuiteRunner::SuiteRunner(bool verbose) :
         PluginRunner(verbose),
-        verbose(verbose)
+        verbose(verbose),
+        monitorPeriod(0)
 {
 }
 
@@ -54,6 +56,12 @@ void SuiteRunner::reset()
     }
     suites.clear();
 
+    // tear down the shared fixtures which are still set up
+    for (auto& sharedFixture : sharedFixtures) {
+        delete sharedFixture.second;
+    }
+    sharedFixtures.clear();
+
     // delete all the fixture plugin loader which was created
     for (auto& fixtureLoader : fixtureLoaders) {
         delete fixtureLoader;
@@ -61,6 +69,16 @@ void SuiteRunner::reset()
     fixtureLoaders.clear();
 }
 
+void SuiteRunner::setMonitorPeriod(double period)
+{
+    monitorPeriod = period;
+}
+
+double SuiteRunner::getMonitorPeriod() const
+{
+    return monitorPeriod;
+}
+
 bool SuiteRunner::loadSuite(std::string filename)
 {
     if (verbose) {
@@ -113,8 +131,38 @@ bool SuiteRunner::loadSuite(std::string filename)
 
     std::string environment;
     std::string name = (root->Attribute("name")) != nullptr ? root->Attribute("name") : "unknown";
+
+    // select the suite and its tests before loading any plugin
+    if (!selectsSuite(filename, root)) {
+        if (verbose) {
+            cout << "Skipping the suite " << filename << " (no test is selected)" << endl;
+        }
+        return true;
+    }
+    bool suiteSelected = getFilter().selects(suiteNames(filename, root));
+    auto selected = [&](TiXmlElement* test) {
+        return selectsTest(root, test, suiteSelected);
+    };
+
     TestSuite* suite = new TestSuite(name);
 
+    // set the period of the fixture monitor
+    suite->setMonitorPeriod(monitorPeriod);
+    if (root->Attribute("monitor") != nullptr) {
+        char* endptr;
+        double period = strtod(root->Attribute("monitor"), &endptr);
+        if (strlen(endptr) == 0 && period >= 0) {
+            suite->setMonitorPeriod(period);
+        } else {
+            string error = Asserter::format("Invalid monitor attribute '%s' while loading '%s'",
+                                            root->Attribute("monitor"),
+                                            filename.c_str());
+            logger.addError(error);
+            delete suite;
+            return false;
+        }
+    }
+
     // retrieving test cases
     for (TiXmlElement* test = root->FirstChildElement(); test != nullptr;
          test = test->NextSiblingElement()) {
@@ -127,18 +175,31 @@ bool SuiteRunner::loadSuite(std::string filename)
                 environment = test->GetText();
             }
         } else if (PluginFactory::compare(test->Value(), "fixture") && test->GetText() != nullptr) {
-            // load the fixture manager plugin
-            auto* loader = new DllFixturePluginLoader();
             std::string pluginName = test->GetText();
+            std::string param = (test->Attribute("param") != nullptr) ? test->Attribute("param") : "";
+
+            // the fixtures with the same plugin and param are shared
+            // among the suites, whatever the spaces around the plugin name
+            size_t first = pluginName.find_first_not_of(" \t\n\r");
+            if (first != std::string::npos) {
+                pluginName = pluginName.substr(first, pluginName.find_last_not_of(" \t\n\r") - first + 1);
+            }
+            auto shared = sharedFixtures.find(make_pair(pluginName, param));
+            if (shared != sharedFixtures.end()) {
+                suite->addFixtureManager(shared->second->share());
+                continue;
+            }
 
+            // load the fixture manager plugin
+            auto* loader = new DllFixturePluginLoader();
             FixtureManager* fixture = loader->open(pluginName);
             if (fixture != nullptr) {
                 // set the fixture manager param
-                if (test->Attribute("param") != nullptr) {
-                    fixture->setParam(test->Attribute("param"));
-                }
+                fixture->setParam(param);
                 // set the fixture manager for the current suite
-                suite->addFixtureManager(fixture);
+                auto* sharedFixture = new SharedFixture(fixture);
+                sharedFixtures[make_pair(pluginName, param)] = sharedFixture;
+                suite->addFixtureManager(sharedFixture->share());
                 // keep track of the created plugin loaders
                 fixtureLoaders.push_back(loader);
             } else {
@@ -149,6 +210,10 @@ bool SuiteRunner::loadSuite(std::string filename)
                 return false;
             }
         } else if (PluginFactory::compare(test->Value(), "test") && test->GetText() != nullptr) {
+            // skip the tests which are not selected
+            if (!selected(test)) {
+                continue;
+            }
 
             PluginLoader* loader;
             std::string pluginName = test->GetText();
@@ -171,6 +236,22 @@ bool SuiteRunner::loadSuite(std::string filename)
                 if (test->Attribute("param") != nullptr) {
                     testcase->setParam(test->Attribute("param"));
                 }
+                // set the test case timeout
+                testcase->setTimeout(getTimeout());
+                if (test->Attribute("timeout") != nullptr) {
+                    char* endptr;
+                    double timeout = strtod(test->Attribute("timeout"), &endptr);
+                    if (strlen(endptr) == 0 && timeout >= 0) {
+                        testcase->setTimeout(timeout);
+                    } else {
+                        string error = Asserter::format("Invalid timeout attribute '%s' while loading '%s'",
+                                                        test->Attribute("timeout"),
+                                                        filename.c_str());
+                        logger.addError(error);
+                        delete loader;
+                        continue;
+                    }
+                }
                 // set the test case repetition
                 if (test->Attribute("repetition") != nullptr) {
                     char* endptr;
@@ -186,8 +267,38 @@ bool SuiteRunner::loadSuite(std::string filename)
                         continue;
                     }
                 }
+                // set the test case benchmark mode
+                testcase->setBenchmark(isBenchmark(), getWarmup());
+                if (test->Attribute("benchmark") != nullptr) {
+                    bool enabled = PluginFactory::compare(test->Attribute("benchmark"), "true");
+                    if (!enabled && !PluginFactory::compare(test->Attribute("benchmark"), "false")) {
+                        string error = Asserter::format("Invalid benchmark attribute '%s' while loading '%s'",
+                                                        test->Attribute("benchmark"),
+                                                        filename.c_str());
+                        logger.addError(error);
+                        delete loader;
+                        continue;
+                    }
+                    testcase->setBenchmark(enabled, testcase->getWarmup());
+                }
+                if (test->Attribute("warmup") != nullptr) {
+                    char* endptr;
+                    long warmup = strtol(test->Attribute("warmup"), &endptr, 10);
+                    if (strlen(endptr) == 0 && warmup >= 0) {
+                        testcase->setBenchmark(testcase->isBenchmark(), static_cast<unsigned int>(warmup));
+                    } else {
+                        string error = Asserter::format("Invalid warmup attribute '%s' while loading '%s'",
+                                                        test->Attribute("warmup"),
+                                                        filename.c_str());
+                        logger.addError(error);
+                        delete loader;
+                        continue;
+                    }
+                }
+                // set the test case check aggregation
+                testcase->setCheckAggregation(isCheckAggregation(), getCheckKeep());
                 // add the test to the suite
-                suite->addTest(testcase);
+                suite->addTest(isolate(testcase));
                 // keep track of the created plugin loaders
                 dllLoaders.push_back(loader);
             } else {
@@ -199,6 +310,7 @@ bool SuiteRunner::loadSuite(std::string filename)
 
     // add the test suite to the TestRunner
     addTest(suite);
+    addDurationKey(suite, filename);
     // keep tracks of the created suites
     suites.push_back(suite);
     return true;
@@ -207,35 +319,88 @@ bool SuiteRunner::loadSuite(std::string filename)
 bool SuiteRunner::loadMultipleSuites(std::string path,
                                      bool recursive)
 {
-    if (!recursive) {
-        return loadSuitesFromPath(path);
+    vector<string> filenames;
+    if (!findSuites(path, recursive, filenames)) {
+        return false;
     }
 
-    // load from subfolders
-    if ((path.rfind(PATH_SEPERATOR) == string::npos) || (path.rfind(PATH_SEPERATOR) != path.size() - 1)) {
-        path = path + string(PATH_SEPERATOR);
+    // select the suites before sharding them, so that the shards
+    // partition only the selected ones
+    if (getFilter().isEnabled()) {
+        auto unselected = [this](const string& filename) {
+            return !isSuiteSelected(filename);
+        };
+        filenames.erase(std::remove_if(filenames.begin(), filenames.end(), unselected), filenames.end());
     }
 
-    DIR* dir;
-    struct dirent* entry;
-    if ((dir = opendir(path.c_str())) == nullptr) {
-        ErrorLogger::Instance().addError("cannot access " + path);
-        return false;
+    // load only the suites of the current shard
+    setDurationRoot(path);
+    for (auto& filename : selectShard(filenames)) {
+        loadSuite(filename);
     }
+    setDurationRoot("");
+    return true;
+}
+
+std::vector<std::string> SuiteRunner::suiteNames(const std::string& filename,
+                                                TiXmlElement* root)
+{
+    std::vector<std::string> names = TestFilter::fileNames(filename);
+    names.push_back((root->Attribute("name") != nullptr) ? root->Attribute("name") : "unknown");
+    return names;
+}
 
-    loadSuitesFromPath(path);
+bool SuiteRunner::selectsTest(TiXmlElement* root,
+                              TiXmlElement* test,
+                              bool suiteSelected) const
+{
+    const TestFilter& filter = getFilter();
+    std::vector<std::string> names = TestFilter::fileNames(test->GetText());
+    std::string tags = ((root->Attribute("tags") != nullptr) ? root->Attribute("tags") : "") + std::string(",") + ((test->Attribute("tags") != nullptr) ? test->Attribute("tags") : "");
+    return (suiteSelected || filter.selects(names)) && !filter.excludes(names) && filter.selectsTags(tags);
+}
 
-    while ((entry = readdir(dir)) != nullptr) {
-        if ((entry->d_type == DT_DIR) && (string(entry->d_name) != string(".")) && (string(entry->d_name) != string(".."))) {
-            string name = path + string(entry->d_name);
-            loadMultipleSuites(name, recursive);
+bool SuiteRunner::selectsSuite(const std::string& filename,
+                               TiXmlElement* root) const
+{
+    const TestFilter& filter = getFilter();
+    if (!filter.isEnabled()) {
+        return true;
+    }
+    std::vector<std::string> names = suiteNames(filename, root);
+    if (filter.excludes(names)) {
+        return false;
+    }
+    bool suiteSelected = filter.selects(names);
+    for (TiXmlElement* test = root->FirstChildElement(); test != nullptr;
+         test = test->NextSiblingElement()) {
+        if (PluginFactory::compare(test->Value(), "test") && test->GetText() != nullptr && selectsTest(root, test, suiteSelected)) {
+            return true;
         }
     }
-    closedir(dir);
-    return true;
+    return false;
+}
+
+bool SuiteRunner::isSuiteSelected(const std::string& filename) const
+{
+    // the files which cannot be parsed are kept and reported by loadSuite
+    TiXmlDocument doc(filename.c_str());
+    bool bOK;
+    try {
+        bOK = doc.LoadFile();
+    } catch (...) {
+        return true;
+    }
+    TiXmlElement* root = doc.RootElement();
+    if (!bOK || root == nullptr || !PluginFactory::compare(root->Value(), "suite")) {
+        return true;
+    }
+    return selectsSuite(filename, root);
 }
 
-bool SuiteRunner::loadSuitesFromPath(std::string path)
+bool SuiteRunner::findSuites(std::string path,
+                             bool recursive,
+                             std::vector<std::string>& filenames)
 {
     if (verbose) {
         cout << "Loading suites from " << path << endl;
@@ -254,11 +419,16 @@ bool SuiteRunner::loadSuitesFromPath(std::string path)
 
     while ((entry = readdir(dir)) != nullptr) {
         string name = entry->d_name;
+        // search into subfolders
+        if (recursive && (entry->d_type == DT_DIR) && (name != string(".")) && (name != string(".."))) {
+            findSuites(path + name, recursive, filenames);
+            continue;
+        }
         if (name.size() > 4) {
             // check for xml file
             string ext = name.substr(name.size() - 4, 4);
             if (PluginFactory::compare(ext.c_str(), ".xml")) {
-                loadSuite(path + name);
+                filenames.push_back(path + name);
             }
         }
     }
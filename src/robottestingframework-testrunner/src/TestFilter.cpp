@@ -0,0 +1,176 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <ErrorLogger.h>
+#include <TestFilter.h>
+
+using namespace std;
+
+TestFilter::TestFilter() = default;
+
+bool TestFilter::Pattern::match(const std::string& name) const
+{
+    if (regex) {
+        return regex_search(name, *regex);
+    }
+    return glob(text.c_str(), name.c_str());
+}
+
+bool TestFilter::parse(const std::string& patterns, std::vector<Pattern>& parsed)
+{
+    parsed.clear();
+    for (auto& item : split(patterns)) {
+        Pattern pattern;
+        pattern.text = item;
+        if (item.compare(0, 3, "re:") == 0) {
+            try {
+                pattern.regex = std::make_shared<std::regex>(item.substr(3));
+            } catch (std::regex_error& e) {
+                ErrorLogger::Instance().addError("invalid regular expression '" + item.substr(3) + "' (" + e.what() + ")");
+                return false;
+            }
+        }
+        parsed.push_back(pattern);
+    }
+    return true;
+}
+
+bool TestFilter::match(const std::vector<Pattern>& patterns, const std::vector<std::string>& names)
+{
+    for (auto& pattern : patterns) {
+        for (auto& name : names) {
+            if (pattern.match(name)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TestFilter::setFilter(const std::string& patterns)
+{
+    return parse(patterns, filters);
+}
+
+bool TestFilter::setExclude(const std::string& patterns)
+{
+    return parse(patterns, exclusions);
+}
+
+void TestFilter::setTags(const std::string& tags)
+{
+    this->tags = split(tags);
+}
+
+bool TestFilter::isEnabled() const
+{
+    return !filters.empty() || !exclusions.empty() || !tags.empty();
+}
+
+bool TestFilter::selects(const std::vector<std::string>& names) const
+{
+    return filters.empty() || match(filters, names);
+}
+
+bool TestFilter::excludes(const std::vector<std::string>& names) const
+{
+    return match(exclusions, names);
+}
+
+bool TestFilter::selectsTags(const std::string& tags) const
+{
+    if (this->tags.empty()) {
+        return true;
+    }
+    for (auto& tag : split(tags)) {
+        for (auto& selected : this->tags) {
+            if (tag == selected) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> TestFilter::fileNames(const std::string& path)
+{
+    vector<string> names;
+    size_t first = path.find_first_not_of(" \t\n\r");
+    if (first == string::npos) {
+        return names;
+    }
+    string filename = path.substr(first, path.find_last_not_of(" \t\n\r") - first + 1);
+    names.push_back(filename);
+    size_t pos = filename.find_last_of("/\\");
+    string basename = (pos == string::npos) ? filename : filename.substr(pos + 1);
+    if (basename != filename) {
+        names.push_back(basename);
+    }
+    pos = basename.rfind('.');
+    if (pos != string::npos && pos > 0) {
+        names.push_back(basename.substr(0, pos));
+    }
+    return names;
+}
+
+std::vector<std::string> TestFilter::split(const std::string& list)
+{
+    vector<string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) {
+            end = list.size();
+        }
+        string item = list.substr(start, end - start);
+        size_t first = item.find_first_not_of(" \t\n\r");
+        if (first != string::npos) {
+            items.push_back(item.substr(first, item.find_last_not_of(" \t\n\r") - first + 1));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+bool TestFilter::glob(const char* pattern, const char* name)
+{
+    // iterative matching which backtracks to the last '*'
+    const char* star = nullptr;
+    const char* retry = nullptr;
+    while (*name != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            retry = name;
+        } else if (*pattern == '?' || *pattern == *name) {
+            pattern++;
+            name++;
+        } else if (star != nullptr) {
+            pattern = star + 1;
+            name = ++retry;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
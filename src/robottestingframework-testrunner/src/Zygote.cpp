@@ -0,0 +1,464 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestCase.h>
+#include <robottestingframework/TestResult.h>
+
+#include <EventStream.h>
+#include <Zygote.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#    include <cerrno>
+#    include <csignal>
+#    include <fcntl.h>
+#    include <poll.h>
+#    include <set>
+#    include <sys/socket.h>
+#    include <sys/types.h>
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+
+#if !defined(_WIN32)
+
+#    if defined(MSG_NOSIGNAL)
+#        define ZYGOTE_SEND_FLAGS MSG_NOSIGNAL
+#    else
+#        define ZYGOTE_SEND_FLAGS 0
+#    endif
+
+namespace {
+
+/**
+ * The messages exchanged between the testrunner and the zygote.
+ * A Spawn request carries the event and control file descriptors.
+ */
+struct Message
+{
+    enum Type : uint32_t
+    {
+        Spawn = 1,
+        Spawned,
+        Exited
+    };
+    uint32_t type;
+    int32_t status;
+    uint64_t seq;
+    int64_t value;
+};
+
+bool send_message(int sock, const Message& msg, const int* fds = nullptr, int nfds = 0)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<Message*>(&msg);
+    iov.iov_len = sizeof(msg);
+
+    struct msghdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    if (nfds > 0) {
+        memset(control, 0, sizeof(control));
+        hdr.msg_control = control;
+        hdr.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), fds, nfds * sizeof(int));
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(sock, &hdr, ZYGOTE_SEND_FLAGS);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    // the rest of the message (if any) is sent without descriptors
+    auto sent = static_cast<size_t>(n);
+    const char* data = reinterpret_cast<const char*>(&msg);
+    while (sent < sizeof(msg)) {
+        n = send(sock, data + sent, sizeof(msg) - sent, ZYGOTE_SEND_FLAGS);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+bool receive_message(int sock, Message& msg, int* fds = nullptr, int nfds = 0)
+{
+    struct iovec iov;
+    iov.iov_base = &msg;
+    iov.iov_len = sizeof(msg);
+
+    struct msghdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(2 * sizeof(int))];
+    if (nfds > 0) {
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+    }
+
+    ssize_t n;
+    do {
+        n = recvmsg(sock, &hdr, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+
+    if (nfds > 0) {
+        int received = 0;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                received = static_cast<int>((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                memcpy(fds, CMSG_DATA(cmsg), std::min(received, nfds) * sizeof(int));
+            }
+        }
+        if (received != nfds) {
+            return false;
+        }
+    }
+
+    // read the rest of the message (if any)
+    auto got = static_cast<size_t>(n);
+    char* data = reinterpret_cast<char*>(&msg);
+    while (got < sizeof(msg)) {
+        n = read(sock, data + got, sizeof(msg) - got);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+
+
+/**
+ * Runs the test within the child process and terminates it.
+ */
+void run_child(Test* test, int eventFd, int controlFd)
+{
+    std::signal(SIGCHLD, SIG_DFL);
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGHUP, SIG_DFL);
+
+    // interrupt the test whenever the testrunner asks for it
+    std::thread([test, controlFd]() {
+        char c;
+        ssize_t n;
+        while ((n = read(controlFd, &c, 1)) > 0 || (n < 0 && errno == EINTR)) {
+            if (n > 0) {
+                test->interrupt();
+            }
+        }
+    }).detach();
+
+    TestResult result;
+    EventStreamWriter writer(eventFd);
+    result.addListener(&writer);
+    test->run(result);
+
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+    _exit(test->succeeded() ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+
+int _sigchldPipe[2] = { -1, -1 };
+
+void zygote_sigchld_handler(int /*unused*/)
+{
+    int saved = errno;
+    char c = 0;
+    (void)write(_sigchldPipe[1], &c, 1);
+    errno = saved;
+}
+
+/**
+ * The main loop of the zygote process. It forks a child for each
+ * request and notifies the testrunner when any of them terminates.
+ */
+void zygote_main(int sock)
+{
+    // keep the zygote and its children away from the terminal signals;
+    // the testrunner interrupts the tests through the control pipes.
+    setpgid(0, 0);
+    std::signal(SIGINT, SIG_IGN);
+    std::signal(SIGHUP, SIG_IGN);
+
+    // the crashes are reported by the testrunner from the exit status
+    TestCase::setCrashHandlerEnabled(false);
+    // the testrunner kills the tests which do not stop after their timeout
+    TestCase::setTimeoutAbortEnabled(false);
+
+    if (pipe(_sigchldPipe) != 0) {
+        _exit(EXIT_FAILURE);
+    }
+    fcntl(_sigchldPipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(_sigchldPipe[1], F_SETFL, O_NONBLOCK);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = zygote_sigchld_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, nullptr);
+
+    std::set<pid_t> children;
+    bool done = false;
+    while (!done) {
+        struct pollfd fds[2];
+        fds[0].fd = sock;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = _sigchldPipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            char buf[64];
+            while (read(_sigchldPipe[0], buf, sizeof(buf)) > 0) {
+            }
+            int status;
+            pid_t child;
+            while ((child = waitpid(-1, &status, WNOHANG)) > 0) {
+                children.erase(child);
+                Message msg{ Message::Exited, status, 0, child };
+                send_message(sock, msg);
+            }
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            Message request;
+            int pipes[2];
+            if (!receive_message(sock, request, pipes, 2)) {
+                done = true;
+                continue;
+            }
+            pid_t child = fork();
+            if (child == 0) {
+                close(sock);
+                close(_sigchldPipe[0]);
+                close(_sigchldPipe[1]);
+                run_child(reinterpret_cast<Test*>(static_cast<uintptr_t>(request.value)), pipes[0], pipes[1]);
+            }
+            close(pipes[0]);
+            close(pipes[1]);
+            if (child > 0) {
+                children.insert(child);
+            }
+            Message reply{ Message::Spawned, 0, request.seq, child };
+            send_message(sock, reply);
+        }
+    }
+
+    // the testrunner is gone; do not leave any orphan test behind
+    for (auto& child : children) {
+        kill(child, SIGKILL);
+    }
+    while (waitpid(-1, nullptr, 0) > 0) {
+    }
+    _exit(EXIT_SUCCESS);
+}
+
+} // namespace
+
+#endif // !defined(_WIN32)
+
+
+Zygote::Zygote() :
+        sock(-1),
+        pid(-1),
+        running(false),
+        seq(0)
+{
+}
+
+
+Zygote::~Zygote()
+{
+    stop();
+}
+
+
+bool Zygote::start()
+{
+#if defined(_WIN32)
+    return false;
+#else
+    if (running) {
+        return true;
+    }
+
+    // do not let the zygote inherit any buffered output
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+        return false;
+    }
+
+    pid_t child = fork();
+    if (child < 0) {
+        close(sv[0]);
+        close(sv[1]);
+        return false;
+    }
+    if (child == 0) {
+        close(sv[0]);
+        zygote_main(sv[1]);
+    }
+
+    close(sv[1]);
+    sock = sv[0];
+    pid = child;
+    running = true;
+    reader = std::thread(&Zygote::receive, this);
+    return true;
+#endif
+}
+
+
+void Zygote::stop()
+{
+#if !defined(_WIN32)
+    if (sock < 0) {
+        return;
+    }
+    shutdown(sock, SHUT_RDWR);
+    if (reader.joinable()) {
+        reader.join();
+    }
+    close(sock);
+    sock = -1;
+    waitpid(static_cast<pid_t>(pid), nullptr, 0);
+    pid = -1;
+    spawned.clear();
+    exited.clear();
+#endif
+}
+
+
+bool Zygote::isRunning() const
+{
+    return running;
+}
+
+
+long Zygote::spawn(Test* test, int eventFd, int controlFd)
+{
+#if defined(_WIN32)
+    return -1;
+#else
+    if (!running) {
+        return -1;
+    }
+
+    Message request{ Message::Spawn, 0, 0, static_cast<int64_t>(reinterpret_cast<uintptr_t>(test)) };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request.seq = ++seq;
+    }
+
+    int fds[2] = { eventFd, controlFd };
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        if (!send_message(sock, request, fds, 2)) {
+            return -1;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&]() { return spawned.count(request.seq) != 0 || !running; });
+    auto itr = spawned.find(request.seq);
+    if (itr == spawned.end()) {
+        return -1;
+    }
+    long child = itr->second;
+    spawned.erase(itr);
+    return child;
+#endif
+}
+
+
+int Zygote::wait(long child)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&]() { return exited.count(child) != 0 || !running; });
+    auto itr = exited.find(child);
+    if (itr == exited.end()) {
+        return -1;
+    }
+    int status = itr->second;
+    exited.erase(itr);
+    return status;
+}
+
+
+void Zygote::receive()
+{
+#if !defined(_WIN32)
+    Message msg;
+    while (receive_message(sock, msg)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (msg.type == Message::Spawned) {
+            spawned[msg.seq] = static_cast<long>(msg.value);
+        } else if (msg.type == Message::Exited) {
+            exited[static_cast<long>(msg.value)] = msg.status;
+        }
+        cond.notify_all();
+    }
+#endif
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+    cond.notify_all();
+}
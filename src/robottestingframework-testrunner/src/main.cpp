@@ -19,19 +19,30 @@
  */
 
 
+#include <robottestingframework/Asserter.h>
 #include <robottestingframework/ConsoleListener.h>
+#include <robottestingframework/TextStreamOutputter.h>
 #include <robottestingframework/TestResult.h>
 #include <robottestingframework/TestResultCollector.h>
 #include <robottestingframework/TextOutputter.h>
 
 #include <ErrorLogger.h>
-#include <JUnitOutputter.h>
-#include <JSONOutputter.h>
+#include <EventStream.h>
+#include <JSONStreamOutputter.h>
+#include <JUnitStreamOutputter.h>
+#include <ShardDashboard.h>
 #include <SuiteRunner.h>
+#include <TestFilter.h>
 #include <Version.h>
+#include <algorithm>
+#include <atomic>
 #include <cmdline.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <vector>
 
 #if defined(ENABLE_WEB_LISTENER)
 #    include <robottestingframework/WebProgressListener.h>
@@ -76,14 +87,38 @@ void addOptions(cmdline::parser& cmd)
 
     cmd.add("no-summary", '\0', "Avoids reporting test summary");
 
-    cmd.add<string>("output", 'o', "The output file to save the result. Default is result.txt", false, "");
-    cmd.add<string>("output-type", '\0', "The output file type (text, json, junit)", false, "text");
+    cmd.add<string>("output", 'o', "The output file to save the result. Default is result.txt (Comma separated files can be given for multiple output types.)", false, "");
+    cmd.add<string>("output-type", '\0', "The output file type (text, json, junit). (Comma separated types write the results in multiple formats.)", false, "text");
 
     cmd.add<string>("param", 'p', "Sets the test case parameters. (Can be used only with --test option.)", false);
     cmd.add<string>("environment", 'e', "Sets the test case environment. (Can be used only with --test option.)", false);
     cmd.add<int>("repetition", '\0', "Sets the test run repetition. (Can be used only with --test option.)", false, 0);
     cmd.add("web-reporter", 'w', "Enables web reporter");
     cmd.add<int>("web-port", '\0', "Sets the web reporter server port. (The default port number is 8080.)", false, 8080);
+    cmd.add<int>("jobs", 'j', "Sets the number of tests (plugins or suites) to be run concurrently. (0 uses all the available cores.)", false, 1);
+    cmd.add<double>("timeout", '\0', "Sets the default timeout of the test cases in seconds. (0 disables the timeout.)", false, 0);
+    cmd.add("bench", '\0', "Runs the test cases as benchmarks: each repetition of the test run is timed and the latency statistics are reported.");
+    cmd.add<int>("warmup", '\0', "Sets the number of warm-up repetitions which are not timed. (Can be used with --bench option.)", false, 0);
+    cmd.add("aggregate", '\0', "Aggregates the checks per call site: only the failures and the first and last passing checks are reported, followed by a summary of each call site.");
+    cmd.add<int>("keep", '\0', "Sets the number of the first and of the last passing checks which are reported for each call site. (Can be used with --aggregate option.)", false, 1);
+    cmd.add<double>("monitor", '\0', "Sets the period in seconds of the fixture monitor which checks the fixtures while the tests are running. (0 checks the fixtures before each test.)", false, 0);
+    cmd.add<int>("async-queue", '\0', "Delivers the test events to the listeners from a separate thread, through a queue of the given size. (0 delivers them from the tests.)", false, 0);
+    cmd.add("drop-reports", '\0', "Drops the test reports instead of waiting when the queue is full. (Can be used with --async-queue option.)");
+    cmd.add<int>("memory-budget", '\0', "Limits the memory used to collect the results to the given number of megabytes: the oldest events are moved to a temporary file. (0 keeps them in memory.)", false, 0);
+    cmd.add<string>("record", '\0', "Records the test events in the given binary log file, which can be replayed with --replay option.", false, "");
+    cmd.add<string>("replay", '\0', "Replays the test events recorded in the given binary log file instead of running the tests, e.g. to write their results in other formats.", false, "");
+    cmd.add("realtime", '\0', "Replays the test events at the pace at which they have been recorded. (Can be used with --replay option.)");
+    cmd.add("isolate", 'i', "Runs each test case in a separate process, so that a crash cannot stop the other tests.");
+    cmd.add<string>("filter", '\0', "Runs only the tests and suites whose names match the given comma separated glob patterns (or regular expressions prefixed by re:).", false, "");
+    cmd.add<string>("exclude", '\0', "Skips the tests and suites whose names match the given comma separated glob patterns (or regular expressions prefixed by re:).", false, "");
+    cmd.add<string>("tags", '\0', "Runs only the tests of the suites which have any of the given comma separated tags.", false, "");
+    cmd.add<int>("shard-index", '\0', "Runs only the tests or suites of the given shard, from 0 to shard-count - 1. (Can be used with --tests or --suites options.)", false, 0);
+    cmd.add<int>("shard-count", '\0', "Sets the number of shards the tests or suites are partitioned into. (Can be used with --tests or --suites options.)", false, 1);
+    cmd.add<string>("durations", '\0', "Balances the shards using the durations of the tests and suites recorded in the given file, which is only read. (All the shards must be given the same file.)", false, "");
+    cmd.add<string>("durations-out", '\0', "Saves the durations of the tests and suites which have been run to the given file, or the merged durations with --merge-durations option.", false, "");
+    cmd.add<string>("merge-durations", '\0', "Merges the comma separated durations files into the file given by --durations-out option, instead of running the tests. (The last file wins for the tests recorded in several files.)", false, "");
+    cmd.add<string>("publish", '\0', "Publishes the test events of the shard to the dashboard listening to the given local socket. (Can be used with --shard-index option.)", false, "");
+    cmd.add<string>("dashboard", '\0', "Runs a dashboard which shows on the web reporter the test events of --shard-count shards published to the given local socket, instead of running the tests.", false, "");
     cmd.add("recursive", 'r', "Searches into subfolders for plugins or XML files. (Can be used with --tests or --suites options.)");
     cmd.add("detail", 'd', "Enables verbose mode of test assertions.");
     cmd.add("verbose", 'v', "Enables verbose mode.");
@@ -93,22 +128,43 @@ void addOptions(cmdline::parser& cmd)
 
 
 static TestRunner* currentRunner = nullptr;
+static EventLogPlayer* currentPlayer = nullptr;
+static ShardDashboard* currentDashboard = nullptr;
+
+// only async-signal-safe calls are made here: the runners just raise their
+// interrupted flag and stop the tests from their own threads
+static void writeMessage(const char* text)
+{
+#if defined(_WIN32)
+    fputs(text, stdout);
+    fflush(stdout);
+#else
+    ssize_t written = write(STDOUT_FILENO, text, strlen(text));
+    (void)written;
+#endif
+}
+
 void signalHandler(int signum)
 {
-    static int interuptCount = 1;
-    cout << endl
-         << "[robottestingframework-testrunner] (" << interuptCount << ") interrupted..." << endl
-         << endl;
-    if (interuptCount++ > 3) {
-        cout << endl
-             << "[robottestingframework-testrunner] killing the tests (interrupted for more than 3 times)!" << endl
-             << endl;
-        exit(EXIT_FAILURE);
+    static std::atomic<int> interuptCount(1);
+    int count = interuptCount++;
+    char text[] = "\n[robottestingframework-testrunner] (0) interrupted...\n\n";
+    *strchr(text, '0') = static_cast<char>('0' + std::min(count, 9));
+    writeMessage(text);
+    if (count > 3) {
+        writeMessage("\n[robottestingframework-testrunner] killing the tests (interrupted for more than 3 times)!\n\n");
+        _Exit(EXIT_FAILURE);
     }
 
     if (currentRunner != nullptr) {
         currentRunner->interrupt();
     }
+    if (currentPlayer != nullptr) {
+        currentPlayer->interrupt();
+    }
+    if (currentDashboard != nullptr) {
+        currentDashboard->interrupt();
+    }
 }
 
 #if defined(_WIN32)
@@ -128,6 +184,67 @@ BOOL CtrlHandler(DWORD fdwCtrlType)
 }
 #endif
 
+int runDashboard(cmdline::parser& cmd)
+{
+#if defined(ENABLE_WEB_LISTENER)
+    if (!cmd.exist("web-reporter")) {
+        cout << "[robottestingframework-testrunner] the dashboard shows the shards on the web reporter (please use --web-reporter option)" << endl;
+        return EXIT_FAILURE;
+    }
+    if (cmd.get<int>("shard-count") < 1) {
+        cout << "[robottestingframework-testrunner] invalid number of shards " << cmd.get<int>("shard-count") << endl;
+        return EXIT_FAILURE;
+    }
+    auto count = static_cast<unsigned int>(cmd.get<int>("shard-count"));
+    unsigned int port = cmd.get<int>("web-port");
+    bool detail = cmd.exist("detail");
+
+    // show the expected shards before they connect
+    vector<unique_ptr<WebProgressListener>> expected;
+    for (unsigned int i = 0; i < count; i++) {
+        expected.emplace_back(new WebProgressListener(Asserter::format("shard %u", i), port, detail));
+    }
+
+    ShardDashboard dashboard([port, detail](const string& name, const ShardPlan& plan) {
+        auto* listener = new WebProgressListener(name, port, detail);
+        listener->setPlan(plan);
+        return listener;
+    });
+    TestMessage msg;
+    if (!dashboard.listen(cmd.get<string>("dashboard"), &msg)) {
+        cout << "[robottestingframework-testrunner] " << msg.getMessage() << ". " << msg.getDetail() << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "[robottestingframework-testrunner] waiting for " << count << " shards on " << cmd.get<string>("dashboard") << endl;
+    currentDashboard = &dashboard;
+    dashboard.serve(count);
+    currentDashboard = nullptr;
+
+    if (!cmd.exist("no-summary")) {
+        cout << endl
+             << "---------- results -----------" << endl;
+        cout << "Number of finished shards    : " << dashboard.shardCount() << " of " << count << endl;
+        if (dashboard.suiteCount()) {
+            cout << "Total number of test suites  : " << dashboard.suiteCount() << endl;
+            cout << "Number of passed test suites : " << dashboard.suiteCount() - dashboard.failedSuiteCount() << endl;
+            cout << "Number of failed test suites : " << dashboard.failedSuiteCount() << endl;
+        }
+        cout << "Total number of test cases   : " << dashboard.testCount() << endl;
+        cout << "Number of passed test cases  : " << dashboard.testCount() - dashboard.failedCount() << endl;
+        cout << "Number of failed test cases  : " << dashboard.failedCount() << endl;
+    }
+
+    if (dashboard.shardCount() == count && dashboard.failedCount() == 0 && dashboard.failedSuiteCount() == 0) {
+        return EXIT_SUCCESS;
+    }
+    return EXIT_FAILURE;
+#else
+    (void)cmd;
+    cout << "Web reporter is not enabled! (please build Robot Testing Version with ENABLE_WEB_LISTENER.)" << endl;
+    return EXIT_FAILURE;
+#endif
+}
+
 int main(int argc, char* argv[])
 {
 
@@ -164,19 +281,109 @@ int main(int argc, char* argv[])
         return 0;
     }
 
+    // collect the events of the shards run by other processes
+    if (cmd.get<string>("dashboard").size()) {
+        return runDashboard(cmd);
+    }
+
+    // merge the durations saved by the shards for balancing the next runs
+    if (cmd.get<string>("merge-durations").size()) {
+        if (cmd.get<string>("durations-out").empty()) {
+            cout << "[robottestingframework-testrunner] --merge-durations requires --durations-out" << endl;
+            return EXIT_FAILURE;
+        }
+        if (!PluginRunner::mergeDurations(TestFilter::split(cmd.get<string>("merge-durations")),
+                                          cmd.get<string>("durations-out"))) {
+            reportErrors();
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
     // exit if no test or suite is given
     if (cmd.get<string>("test").empty() &&
         cmd.get<string>("tests").empty() &&
         cmd.get<string>("suite").empty() &&
-        cmd.get<string>("suites").empty()) {
+        cmd.get<string>("suites").empty() &&
+        cmd.get<string>("replay").empty()) {
         cout << cmd.usage();
         return EXIT_FAILURE;
     }
 
+    // open the recorded events to be replayed instead of running the tests
+    EventLogReader reader;
+    string replayFileName = cmd.get<string>("replay");
+    if (replayFileName.size()) {
+        TestMessage msg;
+        if (!reader.open(replayFileName, &msg)) {
+            cout << "[robottestingframework-testrunner] " << msg.getMessage() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
     // create a test runner
     SuiteRunner runner(cmd.exist("verbose"));
     currentRunner = &runner;
 
+    // set the number of concurrent jobs
+    if (cmd.get<int>("jobs") < 0) {
+        cout << "[robottestingframework-testrunner] invalid number of jobs " << cmd.get<int>("jobs") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setJobs(cmd.get<int>("jobs"));
+
+    // set the default timeout of the test cases
+    if (cmd.get<double>("timeout") < 0) {
+        cout << "[robottestingframework-testrunner] invalid timeout " << cmd.get<double>("timeout") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setTimeout(cmd.get<double>("timeout"));
+
+    // run the test cases as benchmarks
+    if (cmd.get<int>("warmup") < 0) {
+        cout << "[robottestingframework-testrunner] invalid number of warm-up repetitions " << cmd.get<int>("warmup") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setBenchmark(cmd.exist("bench"), cmd.get<int>("warmup"));
+
+    // aggregate the checks of the test cases
+    if (cmd.get<int>("keep") < 0) {
+        cout << "[robottestingframework-testrunner] invalid number of kept checks " << cmd.get<int>("keep") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setCheckAggregation(cmd.exist("aggregate"), cmd.get<int>("keep"));
+
+    // check the fixtures periodically
+    if (cmd.get<double>("monitor") < 0) {
+        cout << "[robottestingframework-testrunner] invalid monitor period " << cmd.get<double>("monitor") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setMonitorPeriod(cmd.get<double>("monitor"));
+
+    // run the test cases in separate processes
+    runner.setIsolated(cmd.exist("isolate"));
+
+    // select the tests and suites to be loaded by their names and tags
+    TestFilter filter;
+    if (!filter.setFilter(cmd.get<string>("filter")) || !filter.setExclude(cmd.get<string>("exclude"))) {
+        reportErrors();
+        return EXIT_FAILURE;
+    }
+    filter.setTags(cmd.get<string>("tags"));
+    runner.setFilter(filter);
+
+    // select the shard of the tests and suites to be loaded
+    if (cmd.get<int>("shard-count") < 1 || cmd.get<int>("shard-index") < 0 || cmd.get<int>("shard-index") >= cmd.get<int>("shard-count")) {
+        cout << "[robottestingframework-testrunner] invalid shard " << cmd.get<int>("shard-index") << " of " << cmd.get<int>("shard-count") << endl;
+        return EXIT_FAILURE;
+    }
+    runner.setShard(cmd.get<int>("shard-index"), cmd.get<int>("shard-count"));
+    string durationsFileName = cmd.get<string>("durations");
+    if (durationsFileName.size() && !runner.loadDurations(durationsFileName)) {
+        reportErrors();
+        return EXIT_FAILURE;
+    }
+
     // configure Python venv if provided
     if (!cmd.get<string>("python-venv").empty()) {
         runner.setPythonVenv(cmd.get<string>("python-venv"));
@@ -223,15 +430,36 @@ int main(int argc, char* argv[])
         }
     }
 
+    // fork the zygote before any thread is created
+    if (runner.isIsolated()) {
+        runner.startIsolation();
+    }
+
     // report any warning or errors
     reportErrors();
 
     // create a test result collector to collect the result
     TestResultCollector collector;
 
+    // limit the memory used by the collected events
+    if (cmd.get<int>("memory-budget") < 0) {
+        cout << "[robottestingframework-testrunner] invalid memory budget " << cmd.get<int>("memory-budget") << endl;
+        return EXIT_FAILURE;
+    }
+    collector.setMemoryBudget(static_cast<size_t>(cmd.get<int>("memory-budget")) * 1024 * 1024);
+
     // create a test result and add the listeners
     TestResult result;
     result.addListener(&collector);
+    if (cmd.get<int>("async-queue") < 0) {
+        cout << "[robottestingframework-testrunner] invalid queue size " << cmd.get<int>("async-queue") << endl;
+        return EXIT_FAILURE;
+    }
+    if (cmd.get<int>("async-queue") > 0) {
+        result.setAsync(true,
+                        cmd.get<int>("async-queue"),
+                        cmd.exist("drop-reports") ? TestResult::OverflowPolicy::DropReports : TestResult::OverflowPolicy::Block);
+    }
 
     // create a test listener to collect the result
     ConsoleListener listener(cmd.exist("detail"));
@@ -240,6 +468,66 @@ int main(int argc, char* argv[])
         listener.hideUncriticalMessages();
     }
 
+    // create the outputters which store the results while the tests are running
+    vector<unique_ptr<StreamOutputter>> outputters;
+    if (!cmd.exist("no-output")) {
+        vector<string> types = TestFilter::split(cmd.get<string>("output-type"));
+        vector<string> outputs = TestFilter::split(cmd.get<string>("output"));
+        for (size_t i = 0; i < types.size(); i++) {
+            string output = (i < outputs.size()) ? outputs[i] : "";
+            StreamOutputter* outputter;
+            if (types[i] == "text") {
+                outputter = new TextStreamOutputter(cmd.exist("detail"));
+                output = output.empty() ? "result.txt" : output;
+            } else if (types[i] == "junit") {
+                outputter = new JUnitStreamOutputter(cmd.exist("detail"));
+                output = output.empty() ? "result.xml" : output;
+            } else if (types[i] == "json") {
+                outputter = new JSONStreamOutputter(cmd.exist("detail"));
+                output = output.empty() ? "result.json" : output;
+            } else {
+                cout << endl
+                     << "Results are not saved! Unknown output type " << types[i] << "." << endl;
+                continue;
+            }
+            outputters.emplace_back(outputter);
+            TestMessage msg;
+            if (!outputter->open(output, &msg)) {
+                cout << endl
+                     << msg.getMessage() << ". " << msg.getDetail() << endl;
+                continue;
+            }
+            result.addListener(outputter);
+        }
+    }
+
+    // record the events to be replayed later
+    EventLogWriter recorder;
+    if (cmd.get<string>("record").size()) {
+        TestMessage msg;
+        if (recorder.open(cmd.get<string>("record"), &msg)) {
+            result.addListener(&recorder);
+        } else {
+            cout << endl
+                 << msg.getMessage() << ". The events are not recorded!" << endl;
+        }
+    }
+
+    // publish the events of the shard to a dashboard
+    ShardPublisher publisher;
+    if (cmd.get<string>("publish").size()) {
+        TestMessage msg;
+        if (publisher.connect(cmd.get<string>("publish"),
+                              Asserter::format("shard %d", cmd.get<int>("shard-index")),
+                              runner.getPlan(),
+                              &msg)) {
+            result.addListener(publisher.getListener());
+        } else {
+            cout << endl
+                 << msg.getMessage() << ". " << msg.getDetail() << ". The events are not published!" << endl;
+        }
+    }
+
     // create web listener if enabled
 #if defined(ENABLE_WEB_LISTENER)
     WebProgressListener* webListener = nullptr;
@@ -249,6 +537,10 @@ int main(int argc, char* argv[])
 #if defined(ENABLE_WEB_LISTENER)
         webListener = new WebProgressListener(cmd.get<int>("web-port"),
                                               cmd.exist("detail"));
+        webListener->setTestResult(&result);
+        if (durationsFileName.size()) {
+            webListener->setPlan(runner.getPlan());
+        }
         result.addListener(webListener);
 #else
         cout << "Web reporter is not enabled! (please build Robot Testing Version with ENABLE_WEB_LISTENER.)" << endl;
@@ -256,39 +548,22 @@ int main(int argc, char* argv[])
     }
 
     // create a test runner and run the test case
-    runner.run(result);
+    EventLogPlayer player(reader);
+    if (replayFileName.size()) {
+        currentPlayer = &player;
+        player.play(result, cmd.exist("realtime"));
+        currentPlayer = nullptr;
+    } else {
+        runner.run(result);
+    }
+    if (result.droppedCount() > 0) {
+        cout << "[robottestingframework-testrunner] " << result.droppedCount() << " reports have been dropped because the event queue was full" << endl;
+    }
 
-    // store the results
-    if (!cmd.exist("no-output")) {
-        string outptType = cmd.get<string>("output-type");
-        if (outptType == "text") {
-            TextOutputter outputter(collector, cmd.exist("detail"));
-            string output = (cmd.get<string>("output").empty()) ? "result.txt" : cmd.get<string>("output");
-            TestMessage msg;
-            if (!outputter.write(output, true, &msg)) {
-                cout << endl
-                     << msg.getMessage() << ". " << msg.getDetail() << endl;
-            }
-        } else if (outptType == "junit") {
-            JUnitOutputter outputter(collector, cmd.exist("detail"));
-            string output = (cmd.get<string>("output").empty()) ? "result.xml" : cmd.get<string>("output");
-            TestMessage msg;
-            if (!outputter.write(output, &msg)) {
-                cout << endl
-                     << msg.getMessage() << ". " << msg.getDetail() << endl;
-            }
-        } else if (outptType == "json") {
-            JSONOutputter outputter(collector, cmd.exist("detail"));
-            string output = (cmd.get<string>("output").empty()) ? "result.json" : cmd.get<string>("output");
-            TestMessage msg;
-            if (!outputter.write(output, &msg)) {
-                cout << endl
-                     << msg.getMessage() << ". " << msg.getDetail() << endl;
-            }
-        }  else {
-            cout << endl
-                 << "Results are not saved! Unknown output type " << outptType << "." << endl;
-        }
+    // save the durations for balancing the next runs
+    string durationsOutFileName = cmd.get<string>("durations-out");
+    if (durationsOutFileName.size() && replayFileName.empty() && !runner.saveDurations(durationsOutFileName)) {
+        reportErrors();
     }
 
     if (!cmd.exist("no-summary")) {
@@ -303,6 +578,7 @@ int main(int argc, char* argv[])
         cout << "Total number of test cases   : " << collector.testCount() << endl;
         cout << "Number of passed test cases  : " << collector.passedCount() << endl;
         cout << "Number of failed test cases  : " << collector.failedCount() << endl;
+        cout << "Total duration               : " << fixed << setprecision(3) << collector.duration() << " s" << endl;
     }
 
     currentRunner = nullptr;
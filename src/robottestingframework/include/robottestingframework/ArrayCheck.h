@@ -0,0 +1,224 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_H
+#define ROBOTTESTINGFRAMEWORK_ARRAYCHECK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * \brief The ArrayCheck class compares whole numeric arrays (e.g., joint
+ * positions, torques or sensor readings) against references or bounds, and
+ * holds the outcome: the number of mismatching elements, the worst one and
+ * the first few mismatches.
+ *
+ * The arrays are contiguous spans of \c float or \c double. The kernels
+ * use SIMD instructions where they are available (SSE2) to skip the
+ * matching elements quickly and they fall back to scalar code otherwise.
+ * The details of a mismatch are always computed by the scalar code, so
+ * that both paths give the same outcome.
+ *
+ * The checks are usually done using the array assertion macros of
+ * TestAssert.h (e.g., ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NEAR).
+ */
+class ArrayCheck
+{
+public:
+    /**
+     * @brief The number of mismatches which are kept by default
+     */
+    static const std::size_t DefaultKeep = 5;
+
+    /**
+     * @brief The Mismatch struct describes a mismatching element
+     */
+    struct Mismatch
+    {
+        std::size_t index; ///< the index of the element
+        double actual;     ///< the actual value
+        double expected;   ///< the expected value (if any)
+        double error;      ///< the error (the distance or the ULP distance)
+    };
+
+    /**
+     * @brief closeTo checks that each actual element is close to the expected
+     * one, i.e., |actual - expected| <= absTolerance + relTolerance * |expected|.
+     * The infinities are close only to themselves and a NaN is never close.
+     * @param actual the actual values
+     * @param expected the expected values
+     * @param size the number of elements
+     * @param absTolerance the absolute tolerance
+     * @param relTolerance the tolerance relative to the expected values
+     * @param keep the number of the first mismatches which are kept
+     * @return the outcome of the check
+     */
+    static ArrayCheck closeTo(const double* actual, const double* expected, std::size_t size,
+                           double absTolerance, double relTolerance = 0, std::size_t keep = DefaultKeep);
+    static ArrayCheck closeTo(const float* actual, const float* expected, std::size_t size,
+                           double absTolerance, double relTolerance = 0, std::size_t keep = DefaultKeep);
+
+    /**
+     * @brief withinUlps checks that each actual element is within the given
+     * distance, in units in the last place, from the expected one.
+     * Zero and minus zero are equal and a NaN is never within any distance.
+     * @param actual the actual values
+     * @param expected the expected values
+     * @param size the number of elements
+     * @param maxUlps the maximum distance in units in the last place
+     * @param keep the number of the first mismatches which are kept
+     * @return the outcome of the check
+     */
+    static ArrayCheck withinUlps(const double* actual, const double* expected, std::size_t size,
+                          std::uint64_t maxUlps, std::size_t keep = DefaultKeep);
+    static ArrayCheck withinUlps(const float* actual, const float* expected, std::size_t size,
+                          std::uint64_t maxUlps, std::size_t keep = DefaultKeep);
+
+    /**
+     * @brief normWithin checks that the euclidean norm of the values is within
+     * the given bounds
+     * @param values the values
+     * @param size the number of elements
+     * @param minNorm the minimum norm
+     * @param maxNorm the maximum norm
+     * @return the outcome of the check
+     */
+    static ArrayCheck normWithin(const double* values, std::size_t size, double minNorm, double maxNorm);
+    static ArrayCheck normWithin(const float* values, std::size_t size, double minNorm, double maxNorm);
+
+    /**
+     * @brief distanceWithin checks that the euclidean norm of the difference
+     * between the actual and the expected values is not greater than the
+     * given bound
+     * @param actual the actual values
+     * @param expected the expected values
+     * @param size the number of elements
+     * @param maxNorm the maximum norm of the difference
+     * @return the outcome of the check
+     */
+    static ArrayCheck distanceWithin(const double* actual, const double* expected, std::size_t size, double maxNorm);
+    static ArrayCheck distanceWithin(const float* actual, const float* expected, std::size_t size, double maxNorm);
+
+    /**
+     * @brief allFinite checks that all the values are finite (neither
+     * infinite nor NaN)
+     * @param values the values
+     * @param size the number of elements
+     * @param keep the number of the first mismatches which are kept
+     * @return the outcome of the check
+     */
+    static ArrayCheck allFinite(const double* values, std::size_t size, std::size_t keep = DefaultKeep);
+    static ArrayCheck allFinite(const float* values, std::size_t size, std::size_t keep = DefaultKeep);
+
+    /**
+     * @brief passed
+     * @return true if the check is passed
+     */
+    bool passed() const;
+
+    /**
+     * @brief getSize
+     * @return the number of the checked elements
+     */
+    std::size_t getSize() const;
+
+    /**
+     * @brief getMismatchCount
+     * @return the number of the mismatching elements
+     */
+    std::size_t getMismatchCount() const;
+
+    /**
+     * @brief getWorstIndex
+     * @return the index of the mismatching element with the largest error,
+     * or the size of the array if there is no mismatch
+     */
+    std::size_t getWorstIndex() const;
+
+    /**
+     * @brief getWorstError
+     * @return the largest error of the mismatching elements
+     */
+    double getWorstError() const;
+
+    /**
+     * @brief getMismatches
+     * @return the first mismatching elements
+     */
+    const std::vector<Mismatch>& getMismatches() const;
+
+    /**
+     * @brief getNorm
+     * @return the computed norm of the norm and distance checks
+     */
+    double getNorm() const;
+
+    /**
+     * @brief describe describes the outcome of the check in one line, e.g.,
+     * "3 of 1000 elements mismatch, worst at [512] ..."
+     * @return the description
+     */
+    std::string describe() const;
+
+private:
+    enum class Kind
+    {
+        Near,
+        Ulp,
+        Norm,
+        Finite
+    };
+
+    ArrayCheck(Kind kind, std::size_t size, std::size_t keep);
+
+    void mismatch(std::size_t index, double actual, double expected, double error);
+
+    template <typename T>
+    static ArrayCheck checkNear(const T* actual, const T* expected, std::size_t size,
+                                double absTolerance, double relTolerance, std::size_t keep);
+    template <typename T>
+    static ArrayCheck checkUlp(const T* actual, const T* expected, std::size_t size,
+                               std::uint64_t maxUlps, std::size_t keep);
+    template <typename T>
+    static ArrayCheck checkNorm(const T* actual, const T* expected, std::size_t size,
+                                double minNorm, double maxNorm);
+    template <typename T>
+    static ArrayCheck checkFinite(const T* values, std::size_t size, std::size_t keep);
+
+private:
+    Kind kind;
+    std::size_t size;
+    std::size_t keep;
+    std::size_t count;
+    Mismatch worst;
+    double normValue;
+    double minNorm;
+    double maxNorm;
+    std::vector<Mismatch> mismatches;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_ARRAYCHECK_H
@@ -22,17 +22,29 @@
 #ifndef ROBOTTESTINGFRAMEWORK_ASSERTER_H
 #define ROBOTTESTINGFRAMEWORK_ASSERTER_H
 
+#include <robottestingframework/ArrayCheck.h>
+#include <robottestingframework/CheckAggregator.h>
 #include <robottestingframework/Exception.h>
 #include <robottestingframework/TestCase.h>
 #include <robottestingframework/TestMessage.h>
+#include <robottestingframework/TestResult.h>
 #include <robottestingframework/TestSuite.h>
 
+#include <sstream>
+#include <string>
+
 #if defined _MSC_VER && _MSC_VER <= 1800 //Visual Studio 12 or earlier has not [[noreturn]]
 #    define ROBOTTESTINGFRAMEWORK_NORETURN __declspec(noreturn)
 #else
 #    define ROBOTTESTINGFRAMEWORK_NORETURN [[noreturn]]
 #endif
 
+#if defined(__GNUC__)
+#    define ROBOTTESTINGFRAMEWORK_PRINTF_FORMAT(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#    define ROBOTTESTINGFRAMEWORK_PRINTF_FORMAT(fmt, args)
+#endif
+
 
 namespace robottestingframework {
 
@@ -43,6 +55,11 @@ namespace robottestingframework {
  * to a TestResult.
  * \note There are many usefull macros in the TestAssert.h which can be used to prepare
  * detailed messages of errors or test failures.
+ *
+ * The overloads taking a \c detail callable build the TestMessage only when
+ * it is really needed (i.e., on failure or when a report is delivered to any
+ * listener), therefore a passing check does not cost any allocation.
+ * The callable is invoked without arguments and returns the detail string.
  */
 class Asserter
 {
@@ -93,7 +110,9 @@ public:
      * @brief report report a message to the
      * result collector of the given TestCase
      * @param msg The corresponding message
-     * @param testcase The owner of the message (reporter)
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used
+     * (see TestContext).
      * @note report does not throw any exception!
      */
     static void report(TestMessage msg,
@@ -105,7 +124,8 @@ public:
      * message will be added to the result collector.
      * @param condition The boolean expression
      * @param msg The corresponding message
-     * @param testcase The owner of the message (reporter)
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
      * @note This does not throw any exception!
      */
     static void testFail(bool condition,
@@ -119,20 +139,215 @@ public:
      * otherwise only the message will be reported.
      * @param condition The boolean expression
      * @param msg The corresponding message
-     * @param testcase The owner of the message (reporter)
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
      * @note This does not throw any exception!
      */
     static void testCheck(bool condition,
                           TestMessage msg,
                           TestCase* testcase);
 
+    /**
+     * @brief fail Throw a failure exception if the condition is not hold.
+     * The message is built only if the condition is false.
+     * @param condition The boolean expression
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     */
+    template <typename Detail>
+    static void fail(bool condition,
+                     const char* msg,
+                     const Detail& detail,
+                     const char* filename,
+                     unsigned int line)
+    {
+        if (!condition) {
+            Asserter::fail(TestMessage(msg, detail(), filename, line));
+        }
+    }
+
+    /**
+     * @brief error Throw an error exception if the condition is not hold.
+     * The message is built only if the condition is false.
+     * @param condition The boolean expression
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     */
+    template <typename Detail>
+    static void error(bool condition,
+                      const char* msg,
+                      const Detail& detail,
+                      const char* filename,
+                      unsigned int line)
+    {
+        if (!condition) {
+            Asserter::error(TestMessage(msg, detail(), filename, line));
+        }
+    }
+
+    /**
+     * @brief report report a message to the result collector of the given
+     * TestCase. The message is built only if any listener receives reports.
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
+     */
+    template <typename Detail>
+    static void report(const char* msg,
+                       const Detail& detail,
+                       const char* filename,
+                       unsigned int line,
+                       TestCase* testcase)
+    {
+        testcase = owner(testcase, "Asserter::report", filename, line);
+        TestResult* result = resultOf(testcase);
+        if (result->isWanted(TestEvent::Kind::Report)) {
+            result->addReport(testcase, TestMessage(msg, detail(), filename, line));
+        }
+    }
+
+    /**
+     * @brief Checks the given boolean condition and if it is not hold a
+     * failure message is added to the result collector. The message is
+     * built only on failure.
+     * @param condition The boolean expression
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
+     */
+    template <typename Detail>
+    static void testFail(bool condition,
+                         const char* msg,
+                         const Detail& detail,
+                         const char* filename,
+                         unsigned int line,
+                         TestCase* testcase)
+    {
+        testcase = owner(testcase, "Asserter::testFail", filename, line);
+        if (!condition) {
+            testcase->failed();
+            resultOf(testcase)->addFailure(testcase, TestMessage(msg, detail(), filename, line));
+        }
+    }
+
+    /**
+     * @brief Checks the given boolean condition and if it is not hold a
+     * failure message is added to the result collector; otherwise the
+     * message is reported if any listener receives reports.
+     * @param condition The boolean expression
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
+     * @param aggregated whether the checks of the call site are aggregated
+     * even if the check aggregation of the test is not enabled (see
+     * TestCase::setCheckAggregation)
+     */
+    template <typename Detail>
+    static void testCheck(bool condition,
+                          const char* msg,
+                          const Detail& detail,
+                          const char* filename,
+                          unsigned int line,
+                          TestCase* testcase,
+                          bool aggregated = false)
+    {
+        testcase = owner(testcase, "Asserter::testCheck", filename, line);
+        TestResult* result = resultOf(testcase);
+        CheckAggregator* aggregator = testcase->getCheckAggregator();
+        if (aggregator != nullptr && (aggregated || testcase->isCheckAggregation())) {
+            bool wanted = result->isWanted(TestEvent::Kind::Report);
+            if (!aggregator->check(condition, msg, filename, line, wanted)) {
+                return;
+            }
+        }
+        if (!condition) {
+            testcase->failed();
+            result->addFailure(testcase, TestMessage(msg, detail(), filename, line));
+        } else if (result->isWanted(TestEvent::Kind::Report)) {
+            result->addReport(testcase, TestMessage(msg, detail(), filename, line));
+        }
+    }
+
+    /**
+     * @brief Checks the outcome of an array check (see ArrayCheck) as
+     * testCheck does: a failure is reported if it is not passed, otherwise
+     * the message is reported. The description of the outcome (the number
+     * of mismatches, the worst and the first ones) is appended to the detail.
+     * @param check The outcome of the array check
+     * @param msg The summary of the message
+     * @param detail Callable which returns the detail of the message
+     * @param filename The source file name
+     * @param line The source line number
+     * @param testcase The owner of the message (reporter). If it is
+     * \c nullptr, the TestCase running on the calling thread is used.
+     */
+    template <typename Detail>
+    static void testArray(const ArrayCheck& check,
+                          const char* msg,
+                          const Detail& detail,
+                          const char* filename,
+                          unsigned int line,
+                          TestCase* testcase)
+    {
+        auto describe = [&]() {
+            std::string text = detail();
+            return text.empty() ? check.describe() : text + ": " + check.describe();
+        };
+        testCheck(check.passed(), msg, describe, filename, line, testcase);
+    }
+
     /**
      * @brief format can be used to format data to in
      *        the same way that \c sprintf formats.
+     *        The length of the result is not limited.
      * @param msg a format-control string
      * @return the formated std::string
      */
-    static std::string format(const char* msg, ...);
+    static std::string format(const char* msg, ...) ROBOTTESTINGFRAMEWORK_PRINTF_FORMAT(1, 2);
+
+    /**
+     * @brief compose is the type-safe alternative of format: it streams
+     *        all the arguments, in order, to a string (e.g.,
+     *        \c compose("value ", x, " is out of range") ).
+     * @param args the values to be composed
+     * @return the composed std::string
+     */
+    template <typename... Args>
+    static std::string compose(const Args&... args)
+    {
+        std::ostringstream stream;
+        int expand[] = { 0, ((stream << args), 0)... };
+        (void)expand;
+        return stream.str();
+    }
+
+private:
+    /**
+     * Returns the owner of a report (see TestContext), or throws an error
+     * exception if it is called outside a TestCase.
+     */
+    static TestCase* owner(TestCase* testcase,
+                           const char* caller,
+                           const char* filename,
+                           unsigned int line);
+
+    /**
+     * Returns the TestResult which receives the events of the given test.
+     */
+    static TestResult* resultOf(TestCase* testcase);
 };
 
 } // namespace robottestingframework
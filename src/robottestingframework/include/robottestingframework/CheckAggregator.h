@@ -0,0 +1,147 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_CHECKAGGREGATOR_H
+#define ROBOTTESTINGFRAMEWORK_CHECKAGGREGATOR_H
+
+#include <robottestingframework/Test.h>
+#include <robottestingframework/TestMessage.h>
+#include <robottestingframework/TestResult.h>
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * \brief The CheckAggregator class counts the checks of a test run per call
+ * site, so that a check which is evaluated at a high frequency (e.g., at each
+ * cycle of a control loop) does not flood the listeners with identical
+ * reports.
+ *
+ * The failures are always reported. Only the first and the last \c keep
+ * passing checks of each call site are reported: the first ones immediately
+ * and the last ones at the end of the test, followed by a summary of the call
+ * site (e.g., "checked 100000 times, 3 failures, first at iteration 512").
+ * Only the iterations of the last passing checks are kept, therefore they are
+ * reported without their detail (e.g., "passed at iteration 99999") and a
+ * passing check which is not reported immediately costs no allocation.
+ * The aggregator of a test run is owned by the TestCase (see
+ * TestCase::setCheckAggregation) and it is used by Asserter::testCheck.
+ */
+class CheckAggregator
+{
+public:
+    /**
+     * CheckAggregator constructor
+     * @param keep the number of the first and of the last passing checks
+     * of each call site which are reported
+     */
+    explicit CheckAggregator(unsigned int keep);
+
+    /**
+     * @brief check accounts a check of a call site
+     * @param condition the result of the check
+     * @param msg the summary of the message of the call site
+     * @param filename the source file name of the call site
+     * @param line the source line number of the call site
+     * @param wanted whether the reports are delivered to any listener. If
+     * not, the passing checks are only counted.
+     * @return true if the check should be reported immediately, i.e., it is a
+     * failure or one of the first passing checks of the call site
+     */
+    bool check(bool condition,
+               const char* msg,
+               const char* filename,
+               unsigned int line,
+               bool wanted)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Site& site = lookup(msg, filename, line);
+        site.checks++;
+        if (!condition) {
+            if (site.failures++ == 0) {
+                site.firstFailure = site.checks;
+            }
+            return true;
+        }
+        if (++site.passed <= keep) {
+            return true;
+        }
+        if (wanted && keep > 0) {
+            // the ring of the iterations of the last passing checks
+            if (site.last.size() < keep) {
+                site.last.push_back(site.checks);
+            } else {
+                site.last[site.next] = site.checks;
+            }
+            site.next = (site.next + 1) % keep;
+        }
+        return false;
+    }
+
+    /**
+     * @brief flush reports the last passing checks and the summary of each
+     * call site, in order of appearance, and resets the counters
+     * @param result the TestResult which receives the reports
+     * @param test the owner of the reports
+     */
+    void flush(TestResult& result, Test* test);
+
+private:
+    struct Site
+    {
+        const char* filename;
+        unsigned int line;
+        std::size_t checks;
+        std::size_t passed;
+        std::size_t failures;
+        std::size_t firstFailure;
+        std::string msg;
+        std::vector<std::size_t> last;
+        std::size_t next;
+    };
+
+    struct SiteHash
+    {
+        std::size_t operator()(const std::pair<const char*, unsigned int>& key) const
+        {
+            return std::hash<const void*>()(key.first) ^ (std::hash<unsigned int>()(key.second) << 1);
+        }
+    };
+
+    Site& lookup(const char* msg, const char* filename, unsigned int line);
+
+private:
+    unsigned int keep;
+    std::mutex mutex;
+    std::vector<Site> sites;
+    std::unordered_map<std::pair<const char*, unsigned int>, std::size_t, SiteHash> index;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_CHECKAGGREGATOR_H
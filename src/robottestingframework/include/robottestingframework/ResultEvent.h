@@ -25,21 +25,41 @@
 #include <robottestingframework/Test.h>
 #include <robottestingframework/TestMessage.h>
 
+#include <utility>
+
 namespace robottestingframework {
 
 /**
  * @brief The ResultEvent class is used by a test collector
  * to collect the result of the tests and the corresponding messages
- * issued during the test run.
+ * issued during the test run. The kind of an event (see getKind)
+ * identifies its subtype without any dynamic_cast.
  */
 class ResultEvent
 {
 public:
+    /**
+     * @brief The Kind enum identifies the subtype of an event
+     */
+    enum class Kind
+    {
+        Report,     ///< ResultEventReport
+        Error,      ///< ResultEventError
+        Timeout,    ///< ResultEventTimeout (which is also a ResultEventError)
+        Failure,    ///< ResultEventFailure
+        StartTest,  ///< ResultEventStartTest
+        EndTest,    ///< ResultEventEndTest
+        StartSuite, ///< ResultEventStartSuite
+        EndSuite    ///< ResultEventEndSuite
+    };
+
     /**
      * @brief ResultEvent constructor
      */
     ResultEvent() :
-            test(nullptr)
+            test(nullptr),
+            timestamp(0),
+            kind(Kind::Report)
     {
     }
 
@@ -53,17 +73,25 @@ public:
      * @param test pointer to a Test
      * @param msg  the corresponding message issued by the test
      */
-    ResultEvent(const Test* test, TestMessage msg)
+    ResultEvent(const Test* test, TestMessage msg) :
+            ResultEvent(Kind::Report, test, std::move(msg))
+    {
+    }
+
+    /**
+     * @brief getKind get the kind of the event
+     * @return the kind of the event
+     */
+    Kind getKind() const
     {
-        ResultEvent::test = test;
-        ResultEvent::message = msg;
+        return kind;
     }
 
     /**
      * @brief getTest get the test
      * @return a pointer to a Test
      */
-    const Test* getTest()
+    const Test* getTest() const
     {
         return test;
     }
@@ -77,9 +105,54 @@ public:
         return message;
     }
 
+    /**
+     * @brief getMessage get the corresponding message
+     * @return a TestMessage
+     */
+    const TestMessage& getMessage() const
+    {
+        return message;
+    }
+
+    /**
+     * @brief getTimestamp get the time at which the event has been issued
+     * @return the time in seconds of a monotonic clock
+     * (see TestResult::now())
+     */
+    double getTimestamp() const
+    {
+        return timestamp;
+    }
+
+    /**
+     * @brief setTimestamp set the time at which the event has been issued
+     * @param time the time in seconds of a monotonic clock
+     */
+    void setTimestamp(double time)
+    {
+        timestamp = time;
+    }
+
+protected:
+    /**
+     * @brief ResultEvent constructor used by the subtypes
+     * @param kind the kind of the event
+     * @param test pointer to a Test
+     * @param msg  the corresponding message issued by the test
+     */
+    ResultEvent(Kind kind, const Test* test, TestMessage msg) :
+            test(test),
+            message(std::move(msg)),
+            timestamp(0),
+            kind(kind)
+    {
+    }
+
 private:
     const Test* test;
     TestMessage message;
+    double timestamp;
+    Kind kind;
 };
 
 
@@ -90,7 +163,7 @@ class ResultEventReport : public ResultEvent
 {
 public:
     ResultEventReport(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::Report, test, std::move(msg))
     {
     }
 };
@@ -103,9 +176,41 @@ class ResultEventError : public ResultEvent
 {
 public:
     ResultEventError(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::Error, test, std::move(msg))
+    {
+    }
+
+protected:
+    ResultEventError(Kind kind, const Test* test, TestMessage msg) :
+            ResultEvent(kind, test, std::move(msg))
+    {
+    }
+};
+
+/**
+ * @brief The ResultEventTimeout class keeps a test timeout event.
+ * A timeout is an error of the test.
+ */
+class ResultEventTimeout : public ResultEventError
+{
+public:
+    ResultEventTimeout(const Test* test, TestMessage msg, double elapsed) :
+            ResultEventError(Kind::Timeout, test, std::move(msg)),
+            elapsed(elapsed)
     {
     }
+
+    /**
+     * @brief getElapsed
+     * @return the time elapsed since the test was started (in seconds)
+     */
+    double getElapsed() const
+    {
+        return elapsed;
+    }
+
+private:
+    double elapsed;
 };
 
 /**
@@ -115,7 +220,7 @@ class ResultEventFailure : public ResultEvent
 {
 public:
     ResultEventFailure(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::Failure, test, std::move(msg))
     {
     }
 };
@@ -127,7 +232,7 @@ class ResultEventStartTest : public ResultEvent
 {
 public:
     ResultEventStartTest(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::StartTest, test, std::move(msg))
     {
     }
 };
@@ -139,7 +244,7 @@ class ResultEventEndTest : public ResultEvent
 {
 public:
     ResultEventEndTest(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::EndTest, test, std::move(msg))
     {
     }
 };
@@ -151,7 +256,7 @@ class ResultEventStartSuite : public ResultEvent
 {
 public:
     ResultEventStartSuite(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::StartSuite, test, std::move(msg))
     {
     }
 };
@@ -164,7 +269,7 @@ class ResultEventEndSuite : public ResultEvent
 {
 public:
     ResultEventEndSuite(const Test* test, TestMessage msg) :
-            ResultEvent(test, msg)
+            ResultEvent(Kind::EndSuite, test, std::move(msg))
     {
     }
 };
@@ -0,0 +1,113 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_SHAREDFIXTURE_H
+#define ROBOTTESTINGFRAMEWORK_SHAREDFIXTURE_H
+
+#include <robottestingframework/FixtureManager.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace robottestingframework {
+
+/**
+ * \brief The SharedFixture class shares a single FixtureManager among many
+ * test suites (e.g., an expensive simulator used by all the suites of a run).
+ *
+ * Each test suite gets its own FixtureManager from share(), which forwards
+ * to the shared one. The shared fixture is set up by the first suite which
+ * needs it and it is torn down once all the suites which share it have
+ * released it. If the fixture collapses (its check() fails or it calls
+ * fixtureCollapsed()), all the suites using it are informed and the next
+ * suite which restarts it (i.e., calls tearDown() and setup()) sets it up
+ * again. The calls to the shared fixture are serialized, therefore it can be
+ * used by suites which are run concurrently. The shared fixture is set up
+ * without holding the lock, so that a long setup does not block the fixture
+ * monitor of the other suites: the suites which need the fixture meanwhile
+ * wait for the setup to finish.
+ */
+class SharedFixture : public FixtureEvents
+{
+public:
+    /**
+     * SharedFixture constructor
+     * @param manager the fixture manager to be shared. It is not deleted
+     * by the SharedFixture.
+     */
+    SharedFixture(FixtureManager* manager);
+
+    /**
+     * SharedFixture destructor. The fixture is torn down if it is still
+     * set up (e.g., some of the suites have never been run).
+     */
+    virtual ~SharedFixture();
+
+    SharedFixture(const SharedFixture&) = delete;
+    SharedFixture& operator=(const SharedFixture&) = delete;
+
+    /**
+     * @brief share creates a new user of the shared fixture
+     * @return a FixtureManager to be added to a test suite. It is
+     * owned by the SharedFixture.
+     */
+    FixtureManager* share();
+
+    /**
+     * @brief getFixtureManager
+     * @return the shared fixture manager
+     */
+    FixtureManager* getFixtureManager();
+
+    /**
+     * @brief isSetup
+     * @return true if the shared fixture is currently set up
+     */
+    bool isSetup();
+
+    /**
+     * @brief fixtureCollapsed is called by the shared fixture manager
+     * and it is forwarded to all the suites which are using it.
+     * @param reason the reason for collapsing the fixture
+     */
+    void fixtureCollapsed(TestMessage reason) override;
+
+private:
+    class User;
+    bool acquire(User* user);
+    void release(User* user);
+    bool check();
+
+private:
+    FixtureManager* manager;
+    std::recursive_mutex mutex;
+    std::vector<std::unique_ptr<User>> users;
+    std::condition_variable_any changed;
+    bool ready;
+    bool collapsed;
+    bool settingUp;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_SHAREDFIXTURE_H
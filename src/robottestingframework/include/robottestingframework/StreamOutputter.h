@@ -0,0 +1,216 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_STREAMOUTPUTTER_H
+#define ROBOTTESTINGFRAMEWORK_STREAMOUTPUTTER_H
+
+
+#include <robottestingframework/ResultEvent.h>
+#include <robottestingframework/TestListener.h>
+#include <robottestingframework/TestMessage.h>
+#include <robottestingframework/TestResultCollector.h>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+namespace robottestingframework {
+
+/**
+ * \ingroup key_class
+ *
+ * \brief The StreamOutputter class is the base of the outputters which are
+ * added to a TestResult as listeners and write the results to a file while
+ * the tests are running, rather than after the run from a
+ * TestResultCollector. Their memory usage does not grow with the number of
+ * events.
+ *
+ * Every record (e.g., a finished test case) is appended to the file followed
+ * by the trailer which completes the document (e.g., the closing tags of an
+ * XML file), and the file is flushed. The next record overwrites the trailer
+ * and the file is cut to the size of the document, therefore the file is a
+ * valid document even if the run is killed. The parts of the document which
+ * are known only later (e.g., the number of failures in the header) can be
+ * inserted once they are known.
+ *
+ * The outputters handle the events of all the threads of a TestResult,
+ * which serializes them. The events of the test cases run concurrently are
+ * expected to be delivered test by test (see TestRunner).
+ */
+class StreamOutputter : public TestListener
+{
+public:
+    /**
+     * @brief StreamOutputter constructor
+     * @param verbose enables the verbose mode. If \c true, the source file and
+     * the line number where the messages are issued by the tests will be written to
+     * the output file.
+     */
+    StreamOutputter(bool verbose = false);
+
+    /**
+     * @brief ~StreamOutputter destructor. It completes the document if it
+     * is still open.
+     */
+    ~StreamOutputter() override;
+
+    /**
+     * @brief open creates the file and writes the beginning of the document
+     * @param filename the name of the file
+     * @param errorMsg a pointer to a TestMessage to return the error message
+     * in case of failure. It can be left unassigned if it is not required.
+     * @return true or false uppoun success or failure
+     */
+    bool open(const std::string& filename, TestMessage* errorMsg = nullptr);
+
+    /**
+     * @brief isOpen
+     * @return true if the file is open
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief close completes the document and closes the file. It is called
+     * when the TestRunner is finished.
+     */
+    void close();
+
+    /**
+     * @brief replay writes the events stored by a TestResultCollector as if
+     * they were delivered by a TestResult, keeping their timestamps
+     * @param collector the collector which holds the events
+     */
+    void replay(const TestResultCollector& collector);
+
+    void addReport(const Test* test, TestMessage msg) override;
+    void addError(const Test* test, TestMessage msg) override;
+    void addFailure(const Test* test, TestMessage msg) override;
+    void addTimeout(const Test* test, TestMessage msg, double elapsed) override;
+    void startTest(const Test* test) override;
+    void endTest(const Test* test) override;
+    void startTestSuite(const Test* test) override;
+    void endTestSuite(const Test* test) override;
+    void endTestRunner() override;
+
+protected:
+    /**
+     * @brief begin is called when the file is opened to write the beginning
+     * of the document
+     */
+    virtual void begin();
+
+    /**
+     * @brief handle is called for each event, after the counters have been
+     * updated
+     * @param kind the kind of the event
+     * @param test the test which has issued the event
+     * @param msg the message of the event (empty for the start and the end
+     * of the tests)
+     * @param elapsed the time elapsed since the test was started in
+     * seconds (for a timeout)
+     */
+    virtual void handle(ResultEvent::Kind kind,
+                        const Test* test,
+                        const TestMessage& msg,
+                        double elapsed) = 0;
+
+    /**
+     * @brief finish is called when the file is closed to complete the
+     * records which are still open
+     */
+    virtual void finish();
+
+    /**
+     * @brief trailer
+     * @return the text which completes the document after the records
+     * written so far
+     */
+    virtual std::string trailer() const;
+
+    /**
+     * @brief append writes a record at the end of the document, followed by
+     * the trailer
+     * @param record the text to be written
+     * @param flush whether the file is flushed to make the record durable
+     */
+    void append(const std::string& record, bool flush = true);
+
+    /**
+     * @brief position
+     * @return the position in the file at which the next record is written
+     */
+    std::streamoff position() const;
+
+    /**
+     * @brief replace replaces a part of the records written so far, moving
+     * the text which follows it. The cost grows with the size of the text
+     * which follows, therefore it is meant for the parts of the document
+     * which are known only later (e.g., the attributes of an XML tag which
+     * has been written). The file is not a valid document while the text
+     * is moved.
+     * @param offset the position of the part to be replaced
+     * @param size the size of the part to be replaced (0 to insert the text)
+     * @param text the text to be written
+     */
+    void replace(std::streamoff offset, std::size_t size, const std::string& text);
+
+    /**
+     * @brief elapsed
+     * @return the time elapsed since the first event (in seconds)
+     */
+    double elapsed() const;
+
+    /**
+     * @brief duration
+     * @return the time elapsed between the first and the last event (in
+     * seconds), as TestResultCollector::duration
+     */
+    double duration() const;
+
+protected:
+    bool verbose;
+    unsigned int nTests;
+    unsigned int nPasses;
+    unsigned int nFailures;
+    unsigned int nTestSuites;
+    unsigned int nSuitePasses;
+    unsigned int nSuiteFailures;
+
+private:
+    void event(ResultEvent::Kind kind,
+               const Test* test,
+               const TestMessage& msg,
+               double elapsed = 0);
+    void move(std::streamoff from, std::streamoff to, std::streamoff delta);
+    void resize(std::streamoff size);
+
+private:
+    std::string filename;
+    std::fstream file;
+    std::streamoff end;
+    std::size_t trailerSize;
+    double firstTime;
+    double lastTime;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_STREAMOUTPUTTER_H
@@ -23,6 +23,8 @@
 #define ROBOTTESTINGFRAMEWORK_TEST_H
 
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace robottestingframework {
 
@@ -33,6 +35,18 @@ class TestResult;
  */
 class Test
 {
+public:
+    /**
+     * The durations of the phases of a test run (in seconds)
+     */
+    typedef std::vector<std::pair<std::string, double>> DurationContainer;
+
+    /**
+     * The statistics of a test run (e.g., the latency of the iterations
+     * of a benchmark)
+     */
+    typedef std::vector<std::pair<std::string, double>> StatisticContainer;
+
 public:
     /**
      * Test constructor
@@ -43,7 +57,8 @@ public:
     Test(std::string name,
          std::string description = "") :
             strName(name),
-            strDescription(description)
+            strDescription(description),
+            duration(0)
     {
     }
 
@@ -103,6 +118,37 @@ public:
      */
     virtual bool succeeded() const = 0;
 
+    /**
+     * @brief getDuration gets the duration of the last test run
+     * measured with a monotonic clock.
+     * @return the duration in seconds
+     */
+    double getDuration() const
+    {
+        return duration;
+    }
+
+    /**
+     * @brief getDurations gets the durations of the phases of the last
+     * test run (e.g., the setup, each repetition of the run and the
+     * tearDown of a TestCase) in the order in which they were first run.
+     * @return the phase names and their durations in seconds
+     */
+    const DurationContainer& getDurations() const
+    {
+        return durations;
+    }
+
+    /**
+     * @brief getStatistics gets the statistics of the last test run
+     * (e.g., the latency of the iterations of a TestCase run as a benchmark).
+     * @return the statistic names and their values
+     */
+    const StatisticContainer& getStatistics() const
+    {
+        return statistics;
+    }
+
 protected:
     /**
      * @brief setName setting the test name
@@ -113,9 +159,58 @@ protected:
         strName = name;
     }
 
+    /**
+     * @brief setDuration sets the duration of the last test run
+     * @param seconds the duration in seconds
+     */
+    void setDuration(double seconds)
+    {
+        duration = seconds;
+    }
+
+    /**
+     * @brief setDurations replaces the durations of the phases
+     * of the last test run
+     * @param phases the phase names and their durations in seconds
+     */
+    void setDurations(const DurationContainer& phases)
+    {
+        durations = phases;
+    }
+
+    /**
+     * @brief addDuration adds the duration of a phase of the test run.
+     * The durations of a phase which is run many times (e.g., a fixture
+     * check) are accumulated.
+     * @param phase the phase name
+     * @param seconds the duration in seconds
+     */
+    void addDuration(const std::string& phase, double seconds)
+    {
+        for (auto& item : durations) {
+            if (item.first == phase) {
+                item.second += seconds;
+                return;
+            }
+        }
+        durations.emplace_back(phase, seconds);
+    }
+
+    /**
+     * @brief setStatistics replaces the statistics of the last test run
+     * @param values the statistic names and their values
+     */
+    void setStatistics(const StatisticContainer& values)
+    {
+        statistics = values;
+    }
+
 private:
     std::string strName;
     std::string strDescription;
+    double duration;
+    DurationContainer durations;
+    StatisticContainer statistics;
 };
 
 } // namespace robottestingframework
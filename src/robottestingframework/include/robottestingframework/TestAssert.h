@@ -45,7 +45,13 @@
 
 
 #include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestContext.h>
 
+#include <string>
+
+// The detail of a conditional message is wrapped in a lambda so that it is
+// evaluated only when the message is really needed (see Asserter).
+#define ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message) [&]() -> std::string { return (message); }
 
 /** Assertion with throwing failure exception.
  * \ingroup Test Assertions
@@ -63,12 +69,12 @@
  * \param condition If this condition evaluates to \c true then the
  *                  test failed.
  */
-#define ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_TRUE(condition, message)                                                                                             \
-    (::robottestingframework::Asserter::fail(!condition,                                                                                                            \
-                                           ::robottestingframework::TestMessage(std::string("asserts failure on (") + std::string(#condition) + ") with exception", \
-                                                                              message,                                                                            \
-                                                                              ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                 \
-                                                                              ROBOTTESTINGFRAMEWORK_SOURCELINE())))
+#define ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_TRUE(condition, message)                            \
+    (::robottestingframework::Asserter::fail(!static_cast<bool>(condition),                      \
+                                           "asserts failure on (" #condition ") with exception", \
+                                           ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),           \
+                                           ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                   \
+                                           ROBOTTESTINGFRAMEWORK_SOURCELINE()))
 
 /** Conditional assertion with throwing failure exception.
  * \ingroup Test Assertions
@@ -76,12 +82,12 @@
  * \param condition If this condition evaluates to \c false then the
  *                  test failed.
  */
-#define ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(condition, message)                                                                                            \
-    (::robottestingframework::Asserter::fail(condition,                                                                                                             \
-                                           ::robottestingframework::TestMessage(std::string("asserts failure on (") + std::string(#condition) + ") with exception", \
-                                                                              message,                                                                            \
-                                                                              ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                 \
-                                                                              ROBOTTESTINGFRAMEWORK_SOURCELINE())))
+#define ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(condition, message)                           \
+    (::robottestingframework::Asserter::fail(static_cast<bool>(condition),                       \
+                                           "asserts failure on (" #condition ") with exception", \
+                                           ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),           \
+                                           ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                   \
+                                           ROBOTTESTINGFRAMEWORK_SOURCELINE()))
 
 /** Assertion with throwing error exception.
  * \ingroup Test Assertions
@@ -99,12 +105,12 @@
  * \param condition If this condition evaluates to \c true then the
  *                  test failed.
  */
-#define ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_TRUE(condition, message)                                                                                           \
-    (::robottestingframework::Asserter::error(!condition,                                                                                                          \
-                                            ::robottestingframework::TestMessage(std::string("asserts error on (") + std::string(#condition) + ") with exception", \
-                                                                               message,                                                                          \
-                                                                               ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                               \
-                                                                               ROBOTTESTINGFRAMEWORK_SOURCELINE())))
+#define ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_TRUE(condition, message)                          \
+    (::robottestingframework::Asserter::error(!static_cast<bool>(condition),                    \
+                                            "asserts error on (" #condition ") with exception", \
+                                            ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),         \
+                                            ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                 \
+                                            ROBOTTESTINGFRAMEWORK_SOURCELINE()))
 
 /** Conditional assertion with throwing error exception.
  * \ingroup Test Assertions
@@ -112,12 +118,12 @@
  * \param condition If this condition evaluates to \c false then the
  *                  test failed.
  */
-#define ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(condition, message)                                                                                          \
-    (::robottestingframework::Asserter::error(condition,                                                                                                           \
-                                            ::robottestingframework::TestMessage(std::string("asserts error on (") + std::string(#condition) + ") with exception", \
-                                                                               message,                                                                          \
-                                                                               ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                               \
-                                                                               ROBOTTESTINGFRAMEWORK_SOURCELINE())))
+#define ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_FALSE(condition, message)                         \
+    (::robottestingframework::Asserter::error(static_cast<bool>(condition),                     \
+                                            "asserts error on (" #condition ") with exception", \
+                                            ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),         \
+                                            ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                 \
+                                            ROBOTTESTINGFRAMEWORK_SOURCELINE()))
 
 /** Reporting a message to the TestResult. ROBOTTESTINGFRAMEWORK_TEST_REPORT
  *  does not throw any exception.
@@ -126,14 +132,14 @@
  * \param message Message to be reported as the detail of TestMessage
  *
  * \note ROBOTTESTINGFRAMEWORK_TEST_REPORT throws error exception if it is not called
- *       within a TestCase class.
+ *       while a TestCase is running on the calling thread or within a TestCase class.
  */
-#define ROBOTTESTINGFRAMEWORK_TEST_REPORT(message)                                                                   \
-    (::robottestingframework::Asserter::report(::robottestingframework::TestMessage("reports",                           \
-                                                                                message,                             \
-                                                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),  \
-                                                                                ROBOTTESTINGFRAMEWORK_SOURCELINE()), \
-                                             dynamic_cast<::robottestingframework::TestCase*>(this)))
+#define ROBOTTESTINGFRAMEWORK_TEST_REPORT(message)                                       \
+    (::robottestingframework::Asserter::report("reports",                                \
+                                             ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message), \
+                                             ROBOTTESTINGFRAMEWORK_SOURCEFILE(),         \
+                                             ROBOTTESTINGFRAMEWORK_SOURCELINE(),         \
+                                             ::robottestingframework::TestContext::resolve(this)))
 
 /** Conditional failure report. ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE does not throw any
  *  exception. It reports a failure message to the TestResult indiecating
@@ -146,13 +152,13 @@
  * \note ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE throws error exception if it is not called
  *       within a TestCase class.
  */
-#define ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(condition, message)                                                                         \
-    (::robottestingframework::Asserter::testFail(condition,                                                                                    \
-                                               ::robottestingframework::TestMessage(std::string("checking (") + std::string(#condition) + ")", \
-                                                                                  message,                                                   \
-                                                                                  ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                        \
-                                                                                  ROBOTTESTINGFRAMEWORK_SOURCELINE()),                       \
-                                               dynamic_cast<::robottestingframework::TestCase*>(this)))
+#define ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(condition, message)                       \
+    (::robottestingframework::Asserter::testFail(static_cast<bool>(condition),             \
+                                               "checking (" #condition ")",                \
+                                               ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message), \
+                                               ROBOTTESTINGFRAMEWORK_SOURCEFILE(),         \
+                                               ROBOTTESTINGFRAMEWORK_SOURCELINE(),         \
+                                               ::robottestingframework::TestContext::resolve(this)))
 
 /** Conditional failure report. ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_TRUE does not throw any
  *  exception. It reports a failure message to the TestResult indiecating
@@ -165,13 +171,13 @@
  * \note ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_TRUE throws error exception if it is not called
  *       within a TestCase class.
  */
-#define ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_TRUE(condition, message)                                                                          \
-    (::robottestingframework::Asserter::testFail(!condition,                                                                                   \
-                                               ::robottestingframework::TestMessage(std::string("checking (") + std::string(#condition) + ")", \
-                                                                                  message,                                                   \
-                                                                                  ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                        \
-                                                                                  ROBOTTESTINGFRAMEWORK_SOURCELINE()),                       \
-                                               dynamic_cast<::robottestingframework::TestCase*>(this)))
+#define ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_TRUE(condition, message)                        \
+    (::robottestingframework::Asserter::testFail(!static_cast<bool>(condition),            \
+                                               "checking (" #condition ")",                \
+                                               ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message), \
+                                               ROBOTTESTINGFRAMEWORK_SOURCEFILE(),         \
+                                               ROBOTTESTINGFRAMEWORK_SOURCELINE(),         \
+                                               ::robottestingframework::TestContext::resolve(this)))
 
 /** ROBOTTESTINGFRAMEWORK_TEST_CHECK combines ROBOTTESTINGFRAMEWORK_TEST_REPORT and ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF.
  * It does not throw any exception. It always reports the message (comment)
@@ -185,12 +191,134 @@
  * \note ROBOTTESTINGFRAMEWORK_TEST_CHECK throws error exception if it is not called
  *       within a TestCase class.
  */
-#define ROBOTTESTINGFRAMEWORK_TEST_CHECK(condition, message)                                                            \
-    (::robottestingframework::Asserter::testCheck(condition,                                                              \
-                                                ::robottestingframework::TestMessage("checks",                            \
-                                                                                   message,                             \
-                                                                                   ROBOTTESTINGFRAMEWORK_SOURCEFILE(),  \
-                                                                                   ROBOTTESTINGFRAMEWORK_SOURCELINE()), \
-                                                dynamic_cast<::robottestingframework::TestCase*>(this)))
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK(condition, message)                                \
+    (::robottestingframework::Asserter::testCheck(static_cast<bool>(condition),             \
+                                                "checks",                                   \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message), \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),         \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),         \
+                                                ::robottestingframework::TestContext::resolve(this)))
+
+/** ROBOTTESTINGFRAMEWORK_TEST_CHECK_AGGREGATED is a ROBOTTESTINGFRAMEWORK_TEST_CHECK
+ * whose call site is aggregated: the passes are counted and only the failures
+ * and the first and last passing checks are reported, followed by a summary of
+ * the call site at the end of the test (see TestCase::setCheckAggregation).
+ * It is meant for the checks which are evaluated at a high frequency (e.g., at
+ * each cycle of a control loop).
+ * \ingroup Test Assertions
+ * \param message Message to be reported as the comment for the current check
+ * \param condition If this condition evaluates to \c false then the
+ *                  test failed.
+ *
+ * \note ROBOTTESTINGFRAMEWORK_TEST_CHECK_AGGREGATED throws error exception if it is not called
+ *       within a TestCase class.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_AGGREGATED(condition, message)                              \
+    (::robottestingframework::Asserter::testCheck(static_cast<bool>(condition),                      \
+                                                "checks",                                            \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),          \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                  \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                  \
+                                                ::robottestingframework::TestContext::resolve(this), \
+                                                true))
+
+/** Array check of closeness. It does not throw any exception. It reports a
+ * failure message if any element of the actual array is not close to the
+ * expected one, i.e., if |actual - expected| > abs_tolerance + rel_tolerance * |expected|.
+ * The message tells the number of mismatches, the worst and the first ones.
+ * \ingroup Test Assertions
+ * \param actual Pointer to the actual values (float or double)
+ * \param expected Pointer to the expected values (of the same type)
+ * \param size The number of elements
+ * \param abs_tolerance The absolute tolerance
+ * \param rel_tolerance The tolerance relative to the expected values
+ * \param message Message to be reported as the detail of TestMessage
+ *
+ * \note The arrays are checked by ArrayCheck::closeTo.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NEAR(actual, expected, size, abs_tolerance, rel_tolerance, message)                                    \
+    (::robottestingframework::Asserter::testArray(::robottestingframework::ArrayCheck::closeTo(actual, expected, size, abs_tolerance, rel_tolerance), \
+                                                "checking array (" #actual " near " #expected ")",                                                    \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),                                                           \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                                   \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                                                                   \
+                                                ::robottestingframework::TestContext::resolve(this)))
+
+/** Array check of the ULP distance. It does not throw any exception. It
+ * reports a failure message if any element of the actual array is farther
+ * than max_ulps units in the last place from the expected one.
+ * \ingroup Test Assertions
+ * \param actual Pointer to the actual values (float or double)
+ * \param expected Pointer to the expected values (of the same type)
+ * \param size The number of elements
+ * \param max_ulps The maximum distance in units in the last place
+ * \param message Message to be reported as the detail of TestMessage
+ *
+ * \note The arrays are checked by ArrayCheck::withinUlps.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_ULP(actual, expected, size, max_ulps, message)                                        \
+    (::robottestingframework::Asserter::testArray(::robottestingframework::ArrayCheck::withinUlps(actual, expected, size, max_ulps), \
+                                                "checking array (" #actual " ulp " #expected ")",                                    \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),                                          \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                  \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                                                  \
+                                                ::robottestingframework::TestContext::resolve(this)))
+
+/** Array check of the norm. It does not throw any exception. It reports a
+ * failure message if the euclidean norm of the array is not within
+ * [min_norm, max_norm].
+ * \ingroup Test Assertions
+ * \param values Pointer to the values (float or double)
+ * \param size The number of elements
+ * \param min_norm The minimum norm
+ * \param max_norm The maximum norm
+ * \param message Message to be reported as the detail of TestMessage
+ *
+ * \note The array is checked by ArrayCheck::normWithin.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NORM(values, size, min_norm, max_norm, message)                                       \
+    (::robottestingframework::Asserter::testArray(::robottestingframework::ArrayCheck::normWithin(values, size, min_norm, max_norm), \
+                                                "checking array norm (" #values ")",                                                 \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),                                          \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                  \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                                                  \
+                                                ::robottestingframework::TestContext::resolve(this)))
+
+/** Array check of the distance. It does not throw any exception. It reports
+ * a failure message if the euclidean norm of the difference between the
+ * actual and the expected arrays is greater than max_norm.
+ * \ingroup Test Assertions
+ * \param actual Pointer to the actual values (float or double)
+ * \param expected Pointer to the expected values (of the same type)
+ * \param size The number of elements
+ * \param max_norm The maximum norm of the difference
+ * \param message Message to be reported as the detail of TestMessage
+ *
+ * \note The arrays are checked by ArrayCheck::distanceWithin.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_DISTANCE(actual, expected, size, max_norm, message)                                       \
+    (::robottestingframework::Asserter::testArray(::robottestingframework::ArrayCheck::distanceWithin(actual, expected, size, max_norm), \
+                                                "checking array distance (" #actual ", " #expected ")",                                  \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),                                              \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                                                      \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                                                      \
+                                                ::robottestingframework::TestContext::resolve(this)))
+
+/** Array check of finiteness. It does not throw any exception. It reports a
+ * failure message if any element of the array is infinite or NaN.
+ * \ingroup Test Assertions
+ * \param values Pointer to the values (float or double)
+ * \param size The number of elements
+ * \param message Message to be reported as the detail of TestMessage
+ *
+ * \note The array is checked by ArrayCheck::allFinite.
+ */
+#define ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_FINITE(values, size, message)                                    \
+    (::robottestingframework::Asserter::testArray(::robottestingframework::ArrayCheck::allFinite(values, size), \
+                                                "checking array finite (" #values ")",                          \
+                                                ROBOTTESTINGFRAMEWORK_LAZY_DETAIL(message),                     \
+                                                ROBOTTESTINGFRAMEWORK_SOURCEFILE(),                             \
+                                                ROBOTTESTINGFRAMEWORK_SOURCELINE(),                             \
+                                                ::robottestingframework::TestContext::resolve(this)))
 
 #endif // ROBOTTESTINGFRAMEWORK_TESTASSERT_H
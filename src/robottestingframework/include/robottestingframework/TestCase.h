@@ -25,8 +25,13 @@
 #include <robottestingframework/Test.h>
 #include <robottestingframework/TestResult.h>
 
+#include <atomic>
+#include <memory>
+
 namespace robottestingframework {
 
+class CheckAggregator;
+
 /**
  * \ingroup key_class
  *
@@ -78,8 +83,17 @@ public:
      */
     void interrupt() override;
 
+    /**
+     * @brief isInterrupted can be polled by long running tests
+     * to stop as soon as an interrupt is requested.
+     * @return true if the current test run has been interrupted
+     */
+    bool isInterrupted() const;
+
     /**
      * the main caller of a TestCase inherited from Test Class.
+     * The durations of the setup, of each repetition of the run
+     * and of the tearDown are recorded (see Test::getDurations).
      * @param result an instance of a TestResult
      * to collect the result of the test.
      */
@@ -153,13 +167,132 @@ public:
      */
     unsigned int getRepetition();
 
+    /**
+     * @brief setBenchmark enables the benchmark mode. Each call of run()
+     * is timed and the latency statistics of the iterations (\c iterations,
+     * \c min, \c mean, \c median, \c p90, \c p99, \c max and \c stddev, in seconds)
+     * are recorded (see Test::getStatistics). The warm-up iterations are run
+     * before the timed ones (see setRepetition) and they are not accounted.
+     * @param enabled whether the benchmark mode is enabled
+     * @param warmup the number of warm-up iterations
+     */
+    void setBenchmark(bool enabled, unsigned int warmup = 0);
+
+    /**
+     * @brief isBenchmark
+     * @return true if the benchmark mode is enabled
+     */
+    bool isBenchmark() const;
+
+    /**
+     * @brief getWarmup gets the number of warm-up iterations
+     * of the benchmark mode
+     * @return the number of warm-up iterations
+     */
+    unsigned int getWarmup() const;
+
+    /**
+     * @brief setCheckAggregation enables the aggregation of the checks
+     * (see ROBOTTESTINGFRAMEWORK_TEST_CHECK) per call site. The failures are
+     * always reported, but only the first and the last \c keep passing checks
+     * of each call site are reported, followed by a summary of the call site
+     * at the end of the test (see CheckAggregator). The checks of the
+     * ROBOTTESTINGFRAMEWORK_TEST_CHECK_AGGREGATED call sites are aggregated
+     * even if it is not enabled.
+     * @param enabled whether all the checks are aggregated
+     * @param keep the number of the first and of the last passing checks
+     * which are reported for each call site
+     */
+    void setCheckAggregation(bool enabled, unsigned int keep = 1);
+
+    /**
+     * @brief isCheckAggregation
+     * @return true if all the checks are aggregated
+     */
+    bool isCheckAggregation() const;
+
+    /**
+     * @brief getCheckKeep gets the number of the first and of the last
+     * passing checks which are reported for each aggregated call site
+     * @return the number of the reported passing checks
+     */
+    unsigned int getCheckKeep() const;
+
+    /**
+     * @brief getCheckAggregator returns the aggregator of the checks of the
+     * current test run
+     * @return a pointer to the CheckAggregator or \c nullptr if the test has
+     * never been run
+     */
+    CheckAggregator* getCheckAggregator();
+
+    /**
+     * @brief setTimeout sets the maximum duration of the test run
+     * (including setup and tearDown). When the timeout expires, a watchdog
+     * reports it (see TestResult::addTimeout) and interrupts the test. If the
+     * test does not stop within the grace period, the watchdog aborts it:
+     * the pending events are delivered, the test and the runner are ended so
+     * that the listeners can complete their outputs and then the whole
+     * process is aborted, together with any other test which it is running.
+     * Only a test run in its own process (see the \c --isolate option of
+     * robottestingframework-testrunner) is aborted alone. There is no timeout
+     * by default.
+     * @param timeout the timeout in seconds. Zero disables the timeout.
+     * @param grace the time given to the test to stop after
+     * being interrupted (in seconds)
+     */
+    void setTimeout(double timeout, double grace = 5.0);
+
+    /**
+     * @brief getTimeout gets the test timeout
+     * @return the timeout in seconds or zero if it is disabled
+     */
+    double getTimeout() const;
+
+    /**
+     * @brief getTimeoutGrace gets the time given to the test to stop
+     * after the timeout
+     * @return the grace period in seconds
+     */
+    double getTimeoutGrace() const;
+
+    /**
+     * @brief setCrashHandlerEnabled enables or disables the handler of the
+     * SIGSEGV and SIGABRT signals of the running test cases. The handler
+     * writes an error message to the standard error and exits the process,
+     * since the run cannot safely continue after a crash; a crash of a
+     * single test case is reported as an error without stopping the run only
+     * when the test cases are run in separate processes, where the handler
+     * can be disabled. The handler is enabled by default.
+     * @param enabled whether the signals should be handled or not
+     */
+    static void setCrashHandlerEnabled(bool enabled);
+
+    /**
+     * @brief setTimeoutAbortEnabled enables or disables aborting the process
+     * when a test does not stop within the grace period after its timeout.
+     * A thread cannot be stopped from outside, therefore the whole process is
+     * aborted. It is enabled by default and it can be disabled when the test
+     * cases are run in separate processes, where the parent process kills
+     * the test instead.
+     * @param enabled whether the process should be aborted
+     */
+    static void setTimeoutAbortEnabled(bool enabled);
+
 private:
     std::string param;
     std::string environment;
     TestResult* result;
-    bool successful;
-    bool interrupted;
+    std::atomic<bool> successful;
+    std::atomic<bool> interrupted;
     unsigned int repetition;
+    bool benchmark;
+    unsigned int warmup;
+    double timeout;
+    double grace;
+    bool aggregation;
+    unsigned int checkKeep;
+    std::unique_ptr<CheckAggregator> aggregator;
 };
 
 } // namespace robottestingframework
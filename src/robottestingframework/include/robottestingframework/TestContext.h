@@ -0,0 +1,139 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TESTCONTEXT_H
+#define ROBOTTESTINGFRAMEWORK_TESTCONTEXT_H
+
+#include <robottestingframework/TestCase.h>
+#include <robottestingframework/TestResult.h>
+
+#include <type_traits>
+
+namespace robottestingframework {
+
+/**
+ * \brief The TestContext class holds the execution context of the TestCase
+ * which is running on the calling thread: the test itself, the TestResult
+ * which receives its events and its interrupt flag.
+ *
+ * A context is created by TestCase::run() for the whole duration of the test
+ * and it is only visible from the thread which runs the test. The contexts
+ * of nested test runs (e.g., a TestRunner used within a TestCase) are stacked,
+ * therefore the innermost test is always the active one.
+ * The assertion macros (see TestAssert.h) and the crash handler use the
+ * active context to find out which test should be blamed, so that the tests
+ * which are run concurrently do not need any locking for it.
+ */
+class TestContext
+{
+public:
+    /**
+     * TestContext constructor. It makes the new context the active one
+     * of the calling thread.
+     * @param test the running TestCase
+     * @param result the TestResult which receives the test events
+     */
+    TestContext(TestCase* test, TestResult* result);
+
+    /**
+     * TestContext destructor. It restores the previous context
+     * of the calling thread.
+     */
+    ~TestContext();
+
+    TestContext(const TestContext&) = delete;
+    TestContext& operator=(const TestContext&) = delete;
+
+    /**
+     * @brief getTest returns the running test
+     * @return a pointer to the TestCase
+     */
+    TestCase* getTest() const;
+
+    /**
+     * @brief getResult returns the TestResult which receives
+     * the events of the running test
+     * @return a pointer to the TestResult
+     */
+    TestResult* getResult() const;
+
+    /**
+     * @brief interrupt interrupts the running test
+     */
+    void interrupt();
+
+    /**
+     * @brief isInterrupted
+     * @return true if the running test has been interrupted
+     */
+    bool isInterrupted() const;
+
+    /**
+     * @brief current returns the active context of the calling thread
+     * @return a pointer to the active context or \c nullptr if no
+     * TestCase is running on the calling thread
+     */
+    static TestContext* current();
+
+    /**
+     * @brief currentTest returns the TestCase which is running on the
+     * calling thread
+     * @return a pointer to the TestCase or \c nullptr
+     */
+    static TestCase* currentTest();
+
+    /**
+     * @brief resolve returns the TestCase which should own a report issued
+     * by the given object. The active context of the calling thread is used
+     * if there is any; otherwise the object itself is used if it is a TestCase
+     * (e.g., when reporting from a thread spawned by the test).
+     * @param self the object issuing the report
+     * @return a pointer to the TestCase or \c nullptr
+     */
+    template <typename T>
+    static TestCase* resolve(T* self)
+    {
+        TestCase* test = currentTest();
+        return (test != nullptr) ? test : cast(self, std::is_convertible<T*, TestCase*>());
+    }
+
+private:
+    // a TestCase is known at compile time, any other object is checked
+    template <typename T>
+    static TestCase* cast(T* self, std::true_type)
+    {
+        return self;
+    }
+
+    template <typename T>
+    static TestCase* cast(T* self, std::false_type)
+    {
+        return dynamic_cast<TestCase*>(self);
+    }
+
+    TestCase* test;
+    TestResult* result;
+    TestContext* previous;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_TESTCONTEXT_H
@@ -0,0 +1,261 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TESTEVENT_H
+#define ROBOTTESTINGFRAMEWORK_TESTEVENT_H
+
+#include <robottestingframework/Test.h>
+#include <robottestingframework/TestMessage.h>
+
+#include <memory>
+#include <utility>
+
+namespace robottestingframework {
+
+/**
+ * @brief The TestOutcome class is a snapshot of the outcome of a test (its
+ * success, its durations and its statistics) which is taken when the test
+ * ends, so that the listeners which are delivered its end event later (e.g.,
+ * by the dispatcher thread of an asynchronous TestResult) do not see the
+ * state of a following run of the same test.
+ */
+class TestOutcome
+{
+public:
+    /**
+     * @brief TestOutcome constructor of a successful outcome
+     */
+    TestOutcome() :
+            successful(true),
+            duration(0)
+    {
+    }
+
+    /**
+     * @brief TestOutcome constructor
+     * @param test the test whose current outcome is taken
+     */
+    explicit TestOutcome(const Test& test) :
+            successful(test.succeeded()),
+            duration(test.getDuration()),
+            durations(test.getDurations()),
+            statistics(test.getStatistics())
+    {
+    }
+
+    /**
+     * @brief succeeded
+     * @return true if the test has succeeded
+     */
+    bool succeeded() const
+    {
+        return successful;
+    }
+
+    /**
+     * @brief getDuration
+     * @return the duration of the test run in seconds (see Test::getDuration)
+     */
+    double getDuration() const
+    {
+        return duration;
+    }
+
+    /**
+     * @brief getDurations
+     * @return the durations of the phases of the test run
+     */
+    const Test::DurationContainer& getDurations() const
+    {
+        return durations;
+    }
+
+    /**
+     * @brief getStatistics
+     * @return the statistics of the test run
+     */
+    const Test::StatisticContainer& getStatistics() const
+    {
+        return statistics;
+    }
+
+private:
+    bool successful;
+    double duration;
+    Test::DurationContainer durations;
+    Test::StatisticContainer statistics;
+};
+
+/**
+ * @brief The TestEvent class is an immutable view of an event issued by
+ * the tests through a TestResult (a report, the start of a test, ...). It is
+ * delivered to the TestEventListener by constant reference and it can be
+ * copied without copying its message (see TestMessage).
+ */
+class TestEvent
+{
+public:
+    /**
+     * @brief The Kind enum identifies the kind of an event
+     */
+    enum class Kind : unsigned int
+    {
+        Report,      ///< a report of the test
+        Error,       ///< an error of the test
+        Failure,     ///< a failure of the test
+        Timeout,     ///< the test has exceeded its timeout
+        StartTest,   ///< a test case is started
+        EndTest,     ///< a test case is finished
+        StartSuite,  ///< a test suite is started
+        EndSuite,    ///< a test suite is finished
+        StartRunner, ///< the test runner is started
+        EndRunner    ///< the test runner is finished
+    };
+
+    /**
+     * @brief The masks of the kinds of events (see mask())
+     */
+    enum KindMask : unsigned int
+    {
+        NoKinds = 0,     ///< no event
+        AllKinds = 0x3FF ///< all the kinds of events
+    };
+
+    /**
+     * @brief mask gets the mask of a kind of events, so that several kinds
+     * can be combined with the bitwise or (e.g., to tell the interests of
+     * a TestEventListener)
+     * @param kind the kind of events
+     * @return the mask of the kind
+     */
+    static unsigned int mask(Kind kind)
+    {
+        return 1u << static_cast<unsigned int>(kind);
+    }
+
+    /**
+     * @brief TestEvent constructor of an empty report
+     */
+    TestEvent() :
+            kind(Kind::Report),
+            test(nullptr),
+            elapsed(0),
+            time(0)
+    {
+    }
+
+    /**
+     * @brief TestEvent constructor
+     * @param kind the kind of the event
+     * @param test pointer to the test which issues the event
+     * @param msg the message of the event (if any)
+     * @param elapsed the time elapsed since the test was started in
+     * seconds (for a timeout)
+     * @param time the time at which the event is issued (see
+     * TestResult::now())
+     * @param outcome the outcome of the test (for the end of a test or of
+     * a suite)
+     */
+    TestEvent(Kind kind,
+              const Test* test,
+              TestMessage msg = TestMessage(),
+              double elapsed = 0,
+              double time = 0,
+              std::shared_ptr<const TestOutcome> outcome = nullptr) :
+            kind(kind),
+            test(test),
+            message(std::move(msg)),
+            elapsed(elapsed),
+            time(time),
+            outcome(std::move(outcome))
+    {
+    }
+
+    /**
+     * @brief getKind
+     * @return the kind of the event
+     */
+    Kind getKind() const
+    {
+        return kind;
+    }
+
+    /**
+     * @brief getTest
+     * @return a pointer to the test which has issued the event or nullptr
+     * for the events of the test runner
+     */
+    const Test* getTest() const
+    {
+        return test;
+    }
+
+    /**
+     * @brief getMessage
+     * @return the message of the event (empty for the start and end events)
+     */
+    const TestMessage& getMessage() const
+    {
+        return message;
+    }
+
+    /**
+     * @brief getElapsed
+     * @return the time elapsed since the test was started in seconds (for
+     * a timeout)
+     */
+    double getElapsed() const
+    {
+        return elapsed;
+    }
+
+    /**
+     * @brief getTime
+     * @return the time at which the event has been issued in seconds of a
+     * monotonic clock (see TestResult::now())
+     */
+    double getTime() const
+    {
+        return time;
+    }
+
+    /**
+     * @brief getOutcome
+     * @return the outcome of the test when the event has been issued, for
+     * the end of a test or of a suite, or nullptr
+     */
+    const TestOutcome* getOutcome() const
+    {
+        return outcome.get();
+    }
+
+private:
+    Kind kind;
+    const Test* test;
+    TestMessage message;
+    double elapsed;
+    double time;
+    std::shared_ptr<const TestOutcome> outcome;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_TESTEVENT_H
@@ -0,0 +1,126 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TESTEVENTLISTENER_H
+#define ROBOTTESTINGFRAMEWORK_TESTEVENTLISTENER_H
+
+#include <robottestingframework/TestEvent.h>
+
+#include <cstddef>
+
+namespace robottestingframework {
+
+/**
+ * @brief The TestEventListener class is the base class of the listeners
+ * which receive the events of a TestResult as TestEvent views by constant
+ * reference, either one by one or in batches. Unlike a TestListener, it
+ * tells which kinds of events it is interested in, so that the TestResult
+ * does not even build the other ones if no listener wants them.
+ *
+ * The interests and the batching of a listener are read once, when it is
+ * added to the TestResult. The TestListener classes are delivered the
+ * events through a TestListenerAdapter.
+ */
+class TestEventListener
+{
+public:
+    /**
+     * @brief The BatchMode enum tells how the events are grouped
+     */
+    enum class BatchMode
+    {
+        None,    ///< each event is delivered as soon as it is issued
+        PerTest, ///< the events are delivered when a test or suite ends
+        Period   ///< the events are delivered at most every batch period
+    };
+
+    /**
+     * TestEventListener constructor
+     */
+    TestEventListener() = default;
+
+    /**
+     * TestEventListener destructor
+     */
+    virtual ~TestEventListener() = default;
+
+    /**
+     * @brief getInterests tells which events are delivered to the listener
+     * @return a combination of the masks of the kinds of events (see
+     * TestEvent::mask()). By default, all the events are delivered.
+     */
+    virtual unsigned int getInterests() const
+    {
+        return TestEvent::AllKinds;
+    }
+
+    /**
+     * @brief getBatchMode tells whether the events are delivered in batches.
+     * The batches keep the order of the events and they are always
+     * delivered at the start and at the end of the test runner and when
+     * TestResult::flush() is called.
+     * @return the batch mode. By default, the events are not grouped.
+     */
+    virtual BatchMode getBatchMode() const
+    {
+        return BatchMode::None;
+    }
+
+    /**
+     * @brief getBatchPeriod
+     * @return the period in seconds of the batches of the BatchMode::Period
+     * mode: a batch is delivered with the first event which is issued after
+     * the period has elapsed since its first event. When the events are
+     * delivered asynchronously (see TestResult::setAsync()) the dispatcher
+     * thread also delivers it once the period has elapsed; otherwise a batch
+     * is held for at least the period, until the next event, TestResult::flush() or the
+     * end of the runner.
+     */
+    virtual double getBatchPeriod() const
+    {
+        return 0.1;
+    }
+
+    /**
+     * This is called for each event which is not batched
+     * @param event the event
+     */
+    virtual void handleEvent(const TestEvent& event)
+    {
+    }
+
+    /**
+     * This is called for each batch of events. By default, the events are
+     * handled one by one.
+     * @param events pointer to the first event
+     * @param count the number of events
+     */
+    virtual void handleEvents(const TestEvent* events, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            handleEvent(events[i]);
+        }
+    }
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_TESTEVENTLISTENER_H
@@ -116,6 +116,18 @@ public:
     virtual void endTestRunner()
     {
     }
+
+    /**
+     * This is called when a test exceeds its timeout. By default
+     * the timeout is delivered as an error.
+     * @param test pointer to the corresponding test
+     * @param msg  correspoinding timeout message
+     * @param elapsed the time elapsed since the test was started (in seconds)
+     */
+    virtual void addTimeout(const Test* test, TestMessage msg, double elapsed)
+    {
+        addError(test, msg);
+    }
 };
 
 } // namespace robottestingframework
@@ -0,0 +1,70 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TESTLISTENERADAPTER_H
+#define ROBOTTESTINGFRAMEWORK_TESTLISTENERADAPTER_H
+
+#include <robottestingframework/TestEventListener.h>
+#include <robottestingframework/TestListener.h>
+
+namespace robottestingframework {
+
+/**
+ * @brief The TestListenerAdapter class delivers the events of a
+ * TestEventListener to a TestListener, calling the method which
+ * corresponds to the kind of each event. It is used by the TestResult for
+ * the TestListener which are added to it.
+ */
+class TestListenerAdapter : public TestEventListener
+{
+public:
+    /**
+     * @brief TestListenerAdapter constructor
+     * @param listener the listener the events are delivered to
+     */
+    TestListenerAdapter(TestListener& listener);
+
+    /**
+     * @brief getListener
+     * @return the listener the events are delivered to
+     */
+    TestListener& getListener() const;
+
+    void handleEvent(const TestEvent& event) override;
+
+    /**
+     * @brief outcomeOf can be used by the TestListener to get the outcome of
+     * a test: while the end of the test or of the suite is delivered to them,
+     * it is the outcome taken when the event has been issued (see
+     * TestEvent::getOutcome), which is still right when the events are
+     * delivered asynchronously; otherwise it is the current one.
+     * @param test the test
+     * @return the outcome of the test
+     */
+    static TestOutcome outcomeOf(const Test* test);
+
+private:
+    TestListener& listener;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_TESTLISTENERADAPTER_H
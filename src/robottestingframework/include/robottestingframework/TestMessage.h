@@ -28,6 +28,12 @@ namespace robottestingframework {
 
 /**
  * @brief A formated message with details.
+ *
+ * The content of a message is immutable and shared by reference count
+ * between its copies, therefore copying a message (e.g., to deliver it to
+ * many listeners) does not allocate any memory. The file names and the
+ * short strings which are repeated (e.g., the messages of the assertions)
+ * are interned and stored only once.
  */
 class TestMessage
 {
@@ -43,6 +49,11 @@ public:
      */
     TestMessage(const TestMessage& other);
 
+    /**
+     * Move constructor
+     * @param other a TestMessage which is left empty
+     */
+    TestMessage(TestMessage&& other) noexcept;
 
     /**
      * @brief TestMessage construct a test message
@@ -70,12 +81,42 @@ public:
                 const std::string filename = "",
                 unsigned int line = 0);
 
+    /**
+     * @brief TestMessage construct a test message
+     * @param msg the message
+     * @param detail the detail of the message
+     * @param filename the source file name of the code for the
+     *        corresponding message, usually a string literal (e.g.,
+     *        ROBOTTESTINGFRAMEWORK_SOURCEFILE()) which is looked up
+     *        without being copied
+     * @param line the line number of the code for
+     *        the corresponding message
+     */
+    TestMessage(const std::string msg,
+                const std::string detail,
+                const char* filename,
+                unsigned int line);
+
 
     /**
      * @brief ~TestMessage Destructor
      */
     virtual ~TestMessage();
 
+    /**
+     * Copy assignment operator
+     * @param other a TestMessage
+     * @return this TestMessage
+     */
+    TestMessage& operator=(const TestMessage& other);
+
+    /**
+     * Move assignment operator
+     * @param other a TestMessage which is left empty
+     * @return this TestMessage
+     */
+    TestMessage& operator=(TestMessage&& other) noexcept;
+
     /**
      * @brief setMessage sets the message
      * @param message the message string
@@ -92,13 +133,13 @@ public:
      * @brief getMessage returns the message string
      * @return string
      */
-    std::string getMessage();
+    const std::string& getMessage() const;
 
     /**
      * @brief getMessage returns the detail string
      * @return string
      */
-    std::string getDetail();
+    const std::string& getDetail() const;
 
 
     /**
@@ -114,7 +155,7 @@ public:
      * @return the line number of the code for
      *         the corresponding message
      */
-    unsigned int getSourceLineNumber();
+    unsigned int getSourceLineNumber() const;
 
 
     /**
@@ -129,7 +170,7 @@ public:
      * @return the source file name of the code for
      *         the corresponding message
      */
-    std::string getSourceFileName();
+    const std::string& getSourceFileName() const;
 
     /**
      * @brief clears the test message
@@ -137,10 +178,15 @@ public:
     void clear();
 
 private:
-    unsigned int lineNumber;
-    std::string strFileName;
-    std::string strMessage;
-    std::string strDetail;
+    struct Payload;
+    void assign(const std::string& msg,
+                const std::string& detail,
+                const std::string& filename,
+                unsigned int line);
+    void release();
+
+private:
+    Payload* payload;
 };
 
 } // namespace robottestingframework
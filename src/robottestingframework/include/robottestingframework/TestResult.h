@@ -23,10 +23,16 @@
 #define ROBOTTESTINGFRAMEWORK_TESTRESULT_H
 
 #include <robottestingframework/Test.h>
+#include <robottestingframework/TestEvent.h>
+#include <robottestingframework/TestEventListener.h>
 #include <robottestingframework/TestListener.h>
 #include <robottestingframework/TestMessage.h>
 
-#include <set>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace robottestingframework {
 
@@ -35,17 +41,37 @@ namespace robottestingframework {
  *
  * \brief The TestResult class is used to deliver the test results including
  * any error and failures produced by tests to any listener. The listeneres
- * can be added by \c addListener.
+ * can be added by \c addListener: either a TestListener, which is called
+ * for each event, or a TestEventListener, which receives TestEvent views,
+ * possibly in batches, and only for the kinds of events it is interested
+ * in. An event which no listener is interested in is not even built.
+ *
+ * The listener calls are serialized, therefore a TestResult can be safely
+ * shared among tests which are run concurrently (e.g. by a TestRunner with
+ * more than one job) and used by the threads spawned by a test.
+ *
+ * By default, the listeners are called by the thread which issues the event.
+ * In the asynchronous mode (see setAsync), the events are instead pushed into
+ * a bounded lock-free queue and a dispatcher thread delivers them to the
+ * listeners in the same order, so that a slow listener does not stall the
+ * tests.
  *
  * Here's an example of using a TestResult:
  * \include examples/simple.cpp
  */
 class TestResult
 {
-    typedef std::set<TestListener*> ListenerContainer;
-    typedef std::set<TestListener*>::iterator ListenerIterator;
-
 public:
+    /**
+     * @brief The OverflowPolicy enum tells what happens when an event is
+     * issued and the queue of the asynchronous mode is full
+     */
+    enum class OverflowPolicy
+    {
+        Block,      ///< the issuing thread waits until the queue has room
+        DropReports ///< the reports are dropped; the other events wait
+    };
+
     /**
      * TestResult constructor
      */
@@ -62,17 +88,86 @@ public:
      */
     void addListener(TestListener* listener);
 
+    /**
+     * Adding a new event listener. Its interests and batching are read
+     * once (see TestEventListener::getInterests).
+     * @param listener pointer to a TestEventListener object
+     */
+    void addListener(TestEventListener* listener);
+
     /**
      * Remove a listener
      * @param listener pointer to a TestListener object
      */
     void removeListener(TestListener* listener);
 
+    /**
+     * Remove an event listener, after delivering its pending batch
+     * @param listener pointer to a TestEventListener object
+     */
+    void removeListener(TestEventListener* listener);
+
     /**
      * Clear the listener list
      */
     void reset();
 
+    /**
+     * @brief setAsync enables or disables the asynchronous delivery of the
+     * events to the listeners. It should be called before running the tests.
+     * Disabling it delivers the pending events first.
+     * @param enabled whether the events are delivered by a dispatcher thread
+     * @param capacity the maximum number of pending events
+     * @param policy what to do when the queue is full
+     */
+    void setAsync(bool enabled,
+                  std::size_t capacity = 4096,
+                  OverflowPolicy policy = OverflowPolicy::Block);
+
+    /**
+     * @brief isAsync
+     * @return true if the events are delivered asynchronously
+     */
+    bool isAsync() const;
+
+    /**
+     * @brief flush waits until all the events issued so far have been
+     * delivered to the listeners, including the pending batches. It is called by endTestRunner(); it must
+     * be called before reading the state of a listener (e.g., of a
+     * TestResultCollector) if the tests are run without a TestRunner.
+     */
+    void flush();
+
+    /**
+     * @brief droppedCount
+     * @return the number of reports which have been dropped because the
+     * queue was full (see OverflowPolicy::DropReports)
+     */
+    std::size_t droppedCount() const;
+
+    /**
+     * @brief pendingCount can be called from any thread, e.g. to monitor
+     * the asynchronous mode
+     * @return the number of events which have been queued and not yet
+     * delivered to the listeners (always 0 in the synchronous mode)
+     */
+    std::size_t pendingCount() const;
+
+    /**
+     * @brief isWanted tells whether any listener is interested in a kind of
+     * events, e.g. to avoid building a report which nobody would receive
+     * @param kind the kind of events
+     * @return true if the events of that kind are delivered
+     */
+    bool isWanted(TestEvent::Kind kind) const;
+
+    /**
+     * @brief addEvent issues an event which has been built before (e.g.,
+     * buffered or recorded), keeping its time
+     * @param event the event
+     */
+    void addEvent(const TestEvent& event);
+
     /**
      * This is called to report any arbitrary message
      * from tests.
@@ -95,6 +190,14 @@ public:
      */
     void addFailure(const Test* test, TestMessage msg);
 
+    /**
+     * This is called when a test exceeds its timeout
+     * @param test pointer to the corresponding test
+     * @param msg  correspoinding timeout message
+     * @param elapsed the time elapsed since the test was started (in seconds)
+     */
+    void addTimeout(const Test* test, TestMessage msg, double elapsed);
+
     /**
      * This is called when a Test is started
      * @param test pointer to the corresponding test
@@ -125,12 +228,52 @@ public:
     void startTestRunner();
 
     /**
-     * This is called when the TestRunner is finished
+     * This is called when the TestRunner is finished. In the asynchronous
+     * mode, it waits until all the events have been delivered.
      */
     void endTestRunner();
 
+    /**
+     * @brief now gets the current time of the monotonic clock which is
+     * used to time the tests and their events
+     * @return the time in seconds since an unspecified epoch
+     */
+    static double now();
+
+    /**
+     * @brief eventTime can be used by the listeners to get the time at
+     * which the event they are handling has been issued. It is the current
+     * time unless the event is being replayed (see setEventTime).
+     * @return the time of the event in seconds (see now())
+     */
+    static double eventTime();
+
+    /**
+     * @brief setEventTime sets the time of the events which are delivered
+     * afterwards by the calling thread. It is used to keep the original time
+     * of the events which are buffered (e.g., by a parallel TestRunner) or
+     * received from another process and replayed later.
+     * @param time the time of the events in seconds (see now()) or zero
+     * to use the current time again
+     */
+    static void setEventTime(double time);
+
+private:
+    class Dispatcher;
+    struct Entry;
+
+    void issue(TestEvent&& event);
+    void dispatch(const TestEvent& event);
+    void deliverBatch(Entry& entry);
+    // returns the seconds until the next batch is due, negative if none
+    double deliverDueBatches();
+    void updateInterests();
+
 private:
-    ListenerContainer listeners;
+    std::vector<std::unique_ptr<Entry>> listeners;
+    std::atomic<unsigned int> interests;
+    std::recursive_mutex mutex;
+    std::unique_ptr<Dispatcher> dispatcher;
 };
 
 } // namespace robottestingframework
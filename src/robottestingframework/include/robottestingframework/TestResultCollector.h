@@ -25,6 +25,12 @@
 #include <robottestingframework/ResultEvent.h>
 #include <robottestingframework/TestListener.h>
 
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace robottestingframework {
@@ -37,6 +43,15 @@ namespace robottestingframework {
  * The collected events later can be used by a proper result formatter
  * to be exported as HTML, XML or other desired formats.
  *
+ * The events are stored contiguously in chunks owned by the collector
+ * rather than being allocated one by one, and they can be traversed in
+ * order using visit(), switching on ResultEvent::getKind().
+ *
+ * For long runs, the memory used by the events can be limited using
+ * setMemoryBudget(): the oldest events are then spilled to a segment file
+ * and read back by visit(). The failures, errors and timeouts are always
+ * kept in memory, as well as the counters.
+ *
  * Here's an example of using a TestResultCollector:
  * \include examples/simple_collector.cpp
  */
@@ -45,6 +60,7 @@ class TestResultCollector : public TestListener
 public:
     typedef std::vector<ResultEvent*> EventResultContainer;
     typedef std::vector<ResultEvent*>::iterator EventResultIterator;
+    typedef std::function<void(const ResultEvent& event)> EventVisitor;
 
 public:
     /**
@@ -62,6 +78,32 @@ public:
      */
     void reset();
 
+    /**
+     * @brief setMemoryBudget limits the memory used by the collected events.
+     * When it is exceeded, the oldest events are moved to a segment file,
+     * except for the failures, errors and timeouts. It should be called
+     * before collecting the events.
+     * @param bytes the memory budget in bytes (0 keeps all the events in
+     * memory, which is the default)
+     * @param filename the segment file. If it is empty, an anonymous
+     * temporary file is used. If it cannot be created, the events are kept
+     * in memory.
+     */
+    void setMemoryBudget(std::size_t bytes, const std::string& filename = "");
+
+    /**
+     * @brief getMemoryBudget
+     * @return the memory budget in bytes (0 if the memory is not limited)
+     */
+    std::size_t getMemoryBudget() const;
+
+    /**
+     * @brief spilledCount gets the number of events which have been moved
+     * to the segment file
+     * @return the number of spilled events
+     */
+    std::size_t spilledCount() const;
+
     /**
      * @brief testCount gets the number of test cases. The test
      * suites are not counted.
@@ -101,12 +143,37 @@ public:
      */
     unsigned int passedSuiteCount();
 
+    /**
+     * @brief duration gets the time elapsed between the first and
+     * the last collected events.
+     * @return the duration in seconds
+     */
+    double duration();
+
+    /**
+     * @brief eventCount gets the number of collected events.
+     * @return the number of events
+     */
+    std::size_t eventCount() const;
+
+    /**
+     * @brief visit calls the visitor for each collected event, in the
+     * order in which they have been issued. The subtype of an event is
+     * given by ResultEvent::getKind().
+     * @param visitor the function which is called for each event
+     */
+    void visit(const EventVisitor& visitor) const;
+
     /**
      * @brief getResults return any result event caught by
      * the TestResultCollector. The events are stored in the
      * ResultEvent format which can be type casted to any subtype event
      * such as ResultEventReport, ResultEventError and etc. to indicate the
-     * actual type of the events.
+     * actual type of the events (see also ResultEvent::getKind). Every
+     * event is stamped with the time at which it has been issued (see
+     * ResultEvent::getTimestamp). The container is a view of the events
+     * which are owned by the collector; visit() traverses them without
+     * building it. The spilled events are read back in memory to build it.
      * @return a EventResultContainer of the events
      */
     EventResultContainer& getResults();
@@ -133,6 +200,14 @@ public:
      */
     void addFailure(const Test* test, TestMessage msg) override;
 
+    /**
+     * This is called when a test exceeds its timeout
+     * @param test pointer to the corresponding test
+     * @param msg  correspoinding timeout message
+     * @param elapsed the time elapsed since the test was started (in seconds)
+     */
+    void addTimeout(const Test* test, TestMessage msg, double elapsed) override;
+
     /**
      * This is called when a Test is started
      * @param test pointer to the corresponding test
@@ -158,7 +233,38 @@ public:
     void endTestSuite(const Test* test) override;
 
 private:
+    // a slot can hold any subtype of ResultEvent
+    typedef std::aligned_storage<sizeof(ResultEventTimeout), alignof(ResultEventTimeout)>::type EventSlot;
+    static constexpr std::size_t chunkSize = 1024;
+
+    // a chunk of events which has been spilled to the segment file
+    struct Segment
+    {
+        long long offset;
+        std::size_t size;
+        std::vector<ResultEvent*> pinned;
+    };
+
+    void* allocateEvent();
+    void addEvent(ResultEvent* event);
+    ResultEvent* getEvent(std::size_t index) const;
+    void spill();
+    std::unique_ptr<EventSlot[]> load(std::size_t index) const;
+    static void destroy(EventSlot* chunk, std::size_t count);
+
+private:
+    std::vector<std::unique_ptr<EventSlot[]>> chunks;
+    std::size_t nEvents;
     EventResultContainer events;
+    std::size_t budget;
+    std::size_t residentBytes;
+    std::string segmentFileName;
+    std::FILE* segmentFile;
+    long long segmentSize;
+    std::vector<Segment> segments;
+    std::vector<std::unique_ptr<EventSlot[]>> restored;
+    double firstTime;
+    double lastTime;
     unsigned int nTests;
     unsigned int nFailures;
     unsigned int nPasses;
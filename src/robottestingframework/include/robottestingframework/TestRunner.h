@@ -25,6 +25,10 @@
 #include <robottestingframework/Test.h>
 #include <robottestingframework/TestResult.h>
 
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <set>
 #include <vector>
 
 namespace robottestingframework {
@@ -34,6 +38,10 @@ namespace robottestingframework {
  *
  * \brief The TestRunner class runs the tests added as TestCase or TestSuite.
  * It simply goes through a list of the tests and run them one after each other.
+ * If more than one job is set (see \c setJobs), the tests are distributed among
+ * a pool of worker threads. In that case, the events of each test are collected
+ * while it runs and are delivered to the TestResult as a single group when the
+ * test is finished, so that the events of concurrent tests never interleave.
  *
  * Here's an example of using a TestRunner:
  * \include examples/simple_runner.cpp
@@ -81,14 +89,38 @@ public:
     void run(TestResult& result);
 
     /**
-     * @brief interrupt interrupts the current test run
+     * @brief interrupt interrupts the current test run. It only raises a
+     * flag, so that it can be called from a signal handler: the running
+     * tests are interrupted shortly after by the thread of the run.
      */
     void interrupt();
 
+    /**
+     * @brief setJobs sets the number of tests which can be run
+     * concurrently. The tests are run one after each other by default.
+     * @param jobs the number of worker threads. A value of zero
+     * uses the number of hardware threads available.
+     */
+    void setJobs(std::size_t jobs);
+
+    /**
+     * @brief getJobs returns the number of tests which can be run
+     * concurrently
+     * @return the number of worker threads
+     */
+    std::size_t getJobs() const;
+
+private:
+    void runTest(Test* test, TestResult& result);
+    void runParallel(TestResult& result);
+    void interruptRunning(std::set<Test*>& stopped);
+
 private:
     TestContainer tests;
-    Test* current;
-    bool interrupted;
+    std::set<Test*> running;
+    std::mutex runningMutex;
+    std::atomic<bool> interrupted;
+    std::size_t jobs;
 };
 
 } // namespace robottestingframework
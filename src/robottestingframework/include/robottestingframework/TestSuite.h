@@ -27,6 +27,10 @@
 #include <robottestingframework/TestMessage.h>
 #include <robottestingframework/TestResult.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace robottestingframework {
@@ -46,6 +50,12 @@ namespace robottestingframework {
  * also overriden by a subclass if any specific action is required to be taken (such as retrying
  * to setup the fixture and runing the reamining tests) upon collapsing the fixture.
  *
+ * By default, the \c check() method of the fixture managers is called before
+ * running each test. If a monitor period is set (see setMonitorPeriod), it is
+ * instead called periodically by a monitor thread while the tests are running,
+ * so that a collapse is detected (and the running test is interrupted) without
+ * waiting for the test to finish.
+ *
  * Here's an example of using a TestSuite:
  * \include examples/simple_suite.cpp
  */
@@ -105,8 +115,25 @@ public:
      */
     void fixtureCollapsed(TestMessage reason) override;
 
+    /**
+     * @brief setMonitorPeriod sets the period of the fixture monitor.
+     * If the period is greater than zero, the fixture managers are checked
+     * by a monitor thread every \c period seconds instead of before each test.
+     * @param period the monitor period in seconds. Zero (the default) disables
+     * the monitor thread.
+     */
+    void setMonitorPeriod(double period);
+
+    /**
+     * @brief getMonitorPeriod
+     * @return the period of the fixture monitor in seconds
+     */
+    double getMonitorPeriod() const;
+
     /**
      * the main caller of a TestSuite inherited from Test Class.
+     * The durations of the fixture setup, check, restart and tearDown
+     * are recorded (see Test::getDurations).
      * @param result an instance of a TestResult
      * to collect the result of the test.
      */
@@ -150,13 +177,26 @@ protected:
      */
     virtual void tearDown();
 
+private:
+    void setCurrent(Test* test);
+    bool checkFixtures();
+    void startMonitor();
+    void stopMonitor();
+    void monitor();
+
 private:
     Test* current;
     TestResult* result;
     bool successful;
-    bool fixtureOK;
-    bool interrupted;
+    std::atomic<bool> fixtureOK;
+    std::atomic<bool> interrupted;
     TestMessage fixtureMessage;
+    std::mutex fixtureMutex;
+    double monitorPeriod;
+    bool monitorStopped;
+    std::mutex monitorMutex;
+    std::condition_variable monitorCondition;
+    std::thread monitorThread;
     FixtureContainer fixtureManagers;
     TestContainer tests;
 };
@@ -34,6 +34,7 @@ namespace robottestingframework {
  * \brief Class TextOutputter saves the results of the test collected by
  * a TestResultCollector in a plain text file. The results are
  * written with the same order collected by the TestResultCollector.
+ * To write them while the tests are running, see TextStreamOutputter.
  *
  * \ingroup key_class
  *
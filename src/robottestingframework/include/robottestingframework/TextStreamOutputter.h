@@ -0,0 +1,68 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_TEXTSTREAMOUTPUTTER_H
+#define ROBOTTESTINGFRAMEWORK_TEXTSTREAMOUTPUTTER_H
+
+
+#include <robottestingframework/StreamOutputter.h>
+
+namespace robottestingframework {
+
+/**
+ * \brief Class TextStreamOutputter writes the results of the test in a
+ * plain text file while the tests are running. The lines of each test case
+ * are flushed when it is finished.
+ *
+ * \ingroup key_class
+ */
+class TextStreamOutputter : public StreamOutputter
+{
+public:
+    /**
+     * @brief TextStreamOutputter constructor.
+     * @param verbose enables the verbose mode. If \c true, the source file and
+     * the line number where the messages are issued by the tests will be written to
+     * the output file. The verbose mode is disabled by default.
+     * @param summary whether some simple statistics are written at the end
+     */
+    TextStreamOutputter(bool verbose = false,
+                        bool summary = true);
+
+    /**
+     * @brief ~TextStreamOutputter destructor
+     */
+    ~TextStreamOutputter() override;
+
+protected:
+    void handle(ResultEvent::Kind kind,
+                const Test* test,
+                const TestMessage& msg,
+                double elapsed) override;
+    void finish() override;
+
+private:
+    bool summary;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_TEXTSTREAMOUTPUTTER_H
@@ -24,8 +24,14 @@
 
 #include <robottestingframework/TestListener.h>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace robottestingframework {
 
+class TestResult;
+
 /**
  * \brief class WebProgressListener listens to any messages reported by the tests
  * during the test run, formates them sends them to the web clients.
@@ -46,11 +52,43 @@ public:
     WebProgressListener(unsigned int port = 8080,
                         bool verbose = false);
 
+    /**
+     * WebProgressListener constructor of a named run (e.g. a shard of the
+     * tests run by another process). The listeners of a process share the
+     * same web server: the events of the named runs are merged in one log,
+     * tagged with the name of their run, and the progress of each run is
+     * shown apart.
+     * @param run the name of the run. The listeners with the same name
+     * belong to the same run.
+     * @param port the server port number. default is 8080
+     * @param verbose enables the verbose mode
+     */
+    WebProgressListener(const std::string& run,
+                        unsigned int port = 8080,
+                        bool verbose = false);
+
     /**
      *  WebProgressListener destructor
      */
     ~WebProgressListener() override;
 
+    /**
+     * @brief setTestResult sets the TestResult whose event queue depth and
+     * dropped reports are exported by the /metrics endpoint. The TestResult
+     * must outlive the listener or be unset before being destroyed.
+     * @param result the TestResult or nullptr
+     */
+    void setTestResult(const TestResult* result);
+
+    /**
+     * @brief setPlan sets the tests and suites which the run is expected to
+     * run, from which the time left is estimated. The unknown durations are
+     * estimated by the average duration of the finished ones.
+     * @param plan the names of the top level tests and suites with their
+     * expected durations in seconds (negative if unknown)
+     */
+    void setPlan(const std::vector<std::pair<std::string, double>>& plan);
+
     /**
      * This is called to report any arbitrary message
      * from tests.
@@ -109,6 +147,7 @@ public:
 
 private:
     void* implement;
+    void* run;
 };
 
 } // namespace robottestingframework
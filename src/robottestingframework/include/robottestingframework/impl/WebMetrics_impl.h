@@ -0,0 +1,157 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#ifndef ROBOTTESTINGFRAMEWORK_WEBMETRICS_IMPL_H
+#define ROBOTTESTINGFRAMEWORK_WEBMETRICS_IMPL_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace robottestingframework {
+
+class TestResult;
+
+/**
+ * \brief class WebMetrics keeps the metrics of a WebProgressListenerImpl
+ * and renders them in the Prometheus text format for the /metrics endpoint.
+ *
+ * The metrics are recorded with atomic updates only, so that they can be
+ * kept on the event path; render() may be called concurrently from another
+ * thread.
+ */
+class WebMetrics
+{
+public:
+    /**
+     * @brief The Counter enum lists the counted events
+     */
+    enum Counter
+    {
+        TestsStarted = 0,
+        TestsPassed,
+        TestsFailed,
+        TestsErrored,
+        SuitesStarted,
+        SuitesPassed,
+        SuitesFailed,
+        SuitesErrored,
+        Reports,
+        Failures,
+        Errors,
+        CounterCount
+    };
+
+    /**
+     * WebMetrics constructor
+     */
+    WebMetrics();
+
+    /**
+     * WebMetrics destructor
+     */
+    ~WebMetrics();
+
+    /**
+     * @brief count increments a counter
+     * @param counter the counter
+     */
+    void count(Counter counter);
+
+    /**
+     * @brief observeTest records the duration of a test case
+     * @param seconds the duration in seconds
+     */
+    void observeTest(double seconds);
+
+    /**
+     * @brief observeSuite records the duration of a test suite
+     * @param seconds the duration in seconds
+     */
+    void observeSuite(double seconds);
+
+    /**
+     * @brief observePhase records the duration of a phase of a test run.
+     * The first MaxPhases phase names get their own histogram, the others
+     * are recorded as "other". The repetitions of a test ("run #N") are
+     * all recorded as "run".
+     * @param phase the phase name
+     * @param seconds the duration in seconds
+     */
+    void observePhase(const std::string& phase, double seconds);
+
+    /**
+     * @brief setTestResult sets the TestResult whose event queue is
+     * monitored
+     * @param result the TestResult or nullptr
+     */
+    void setTestResult(const TestResult* result);
+
+    /**
+     * @brief render renders the metrics in the Prometheus text format
+     * @param webEvents the number of events kept for the web clients
+     * @return the metrics
+     */
+    std::string render(std::size_t webEvents) const;
+
+private:
+    WebMetrics(WebMetrics const&) = delete;
+    void operator=(WebMetrics const&) = delete;
+
+    // the upper bounds of the buckets of the histograms (in seconds)
+    static const double Bounds[];
+    static const std::size_t BucketCount = 16;
+
+    class Histogram
+    {
+    public:
+        Histogram();
+        void observe(double seconds);
+        void render(std::string& out,
+                    const std::string& name,
+                    const std::string& labels) const;
+
+    private:
+        // the last bucket is +Inf; the counts are not cumulative
+        std::atomic<std::uint64_t> buckets[BucketCount];
+        std::atomic<std::uint64_t> nanoseconds;
+    };
+
+    struct Phase
+    {
+        std::atomic<const std::string*> name;
+        Histogram histogram;
+    };
+
+    static const std::size_t MaxPhases = 16;
+
+    std::atomic<std::uint64_t> counters[CounterCount];
+    Histogram tests;
+    Histogram suites;
+    Phase phases[MaxPhases];
+    Histogram otherPhases;
+    std::atomic<const TestResult*> result;
+};
+
+} // namespace robottestingframework
+
+#endif // ROBOTTESTINGFRAMEWORK_WEBMETRICS_IMPL_H
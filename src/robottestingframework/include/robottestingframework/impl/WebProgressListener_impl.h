@@ -23,14 +23,101 @@
 #define ROBOTTESTINGFRAMEWORK_WEBPROGRESSLISTENER_IMPL_H
 
 
+#include <robottestingframework/TestEvent.h>
 #include <robottestingframework/TestListener.h>
+#include <robottestingframework/impl/WebMetrics_impl.h>
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mongoose.h>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace robottestingframework {
 
+/**
+ * \brief struct WebEvent holds an event formatted for the web clients: as
+ * HTML for the /update requests and as compact JSON for the /events stream.
+ */
+struct WebEvent
+{
+    std::string html;
+    std::string json;
+};
+
+/**
+ * \brief class WebEventLog keeps the formatted events of a
+ * WebProgressListenerImpl in an append-only log.
+ *
+ * The events are numbered from 0 and stored in chunks which are never moved
+ * or freed while the log exists. The chunks double in size, so an event is
+ * located in constant time. The writers append under a mutex and publish
+ * each event by advancing the event count; the readers (the web clients)
+ * never take a lock and never block the writers.
+ */
+class WebEventLog
+{
+public:
+    /**
+     * WebEventLog constructor
+     */
+    WebEventLog();
+
+    /**
+     * WebEventLog destructor
+     */
+    ~WebEventLog();
+
+    /**
+     * append an event to the log
+     * @param event the formatted event
+     * @return the sequence number of the event
+     */
+    std::size_t append(WebEvent event);
+
+    /**
+     * @return the number of the events in the log
+     */
+    std::size_t size() const;
+
+    /**
+     * @param seq the sequence number of a published event (lower than size())
+     * @return the event
+     */
+    const WebEvent& at(std::size_t seq) const;
+
+    /**
+     * read the HTML of the events from \c since on
+     * @param since the sequence number of the first event to read
+     * @param maxBytes stop once this many bytes have been read
+     * @param out the events are appended to this string
+     * @return the sequence number of the next event to read
+     */
+    std::size_t read(std::size_t since,
+                     std::size_t maxBytes,
+                     std::string& out) const;
+
+private:
+    WebEventLog(WebEventLog const&) = delete;
+    void operator=(WebEventLog const&) = delete;
+
+    // chunk k holds FirstChunkSize << k events
+    static const std::size_t FirstChunkSize = 64;
+    static const std::size_t MaxChunks = 48;
+
+    static std::size_t chunkOf(std::size_t seq);
+    static std::size_t chunkStart(std::size_t chunk);
+
+    std::atomic<WebEvent*> chunks[MaxChunks];
+    std::atomic<std::size_t> count;
+    std::mutex appending;
+};
+
 /**
  * \brief Singleton class WebProgressListenerImpl listens to any messages reported by the tests
  * during the test run, formates them sends them to the web clients.
@@ -41,6 +128,41 @@ namespace robottestingframework {
 class WebProgressListenerImpl
 {
 public:
+    /**
+     * \brief struct PlanItem is a test or suite which a run is expected to
+     * run, with its expected duration in seconds (negative if unknown).
+     */
+    struct PlanItem
+    {
+        std::string name;
+        double expected;
+        // the time at which it has been started, negative if not started
+        double started;
+        bool done;
+    };
+
+    /**
+     * \brief struct Run holds the progress of a run of the tests, e.g. a
+     * shard of a multi-run dashboard. The events of the listeners created
+     * without a run name belong to the default run, which is shown apart
+     * only once it has a plan.
+     */
+    struct Run
+    {
+        std::string name;
+        bool planned;
+        bool finished;
+        std::size_t passed;
+        std::size_t failed;
+        // the nesting level of the running tests and suites
+        std::size_t depth;
+        // the indices in testStatus of the running test cases
+        std::vector<std::size_t> running;
+        // the running top level test or suite
+        std::string current;
+        std::vector<PlanItem> plan;
+    };
+
     /**
      * create Creates an instance of WebProgressListenerImpl class
      * @param port the server port number. default is 8080
@@ -56,67 +178,93 @@ public:
      */
     virtual ~WebProgressListenerImpl();
 
+    /**
+     * addRun returns the run of the given name, which is created if needed
+     * @param name the name of the run, empty for the default run
+     * @return the run, which lives as long as the listener
+     */
+    Run* addRun(const std::string& name);
+
+    /**
+     * setPlan sets the tests and suites which a run is expected to run
+     * @param run the run
+     * @param plan the names of the tests and suites with their expected
+     * durations in seconds (negative if unknown)
+     */
+    void setPlan(Run* run,
+                 const std::vector<std::pair<std::string, double>>& plan);
+
     /**
      * This is called to report any arbitrary message
      * from tests.
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      * @param msg  correspoinding error message
      */
-    virtual void addReport(const Test* test, TestMessage msg);
+    virtual void addReport(Run* run, const Test* test, TestMessage msg);
 
     /**
      * This is called when an error occurred during test run
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      * @param msg  correspoinding error message
      */
-    virtual void addError(const Test* test, TestMessage msg);
+    virtual void addError(Run* run, const Test* test, TestMessage msg);
 
     /**
      * This is called when a failure occurred during test run
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      * @param msg  correspoinding failure message
      */
-    virtual void addFailure(const Test* test, TestMessage msg);
+    virtual void addFailure(Run* run, const Test* test, TestMessage msg);
 
     /**
      * This is called when a Test is started
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      */
-    virtual void startTest(const Test* test);
+    virtual void startTest(Run* run, const Test* test);
 
     /**
      * This is called when a Test is finished
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      */
-    virtual void endTest(const Test* test);
+    virtual void endTest(Run* run, const Test* test);
 
     /**
      * This is called when a TestSuite is started
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      */
-    virtual void startTestSuite(const Test* test);
+    virtual void startTestSuite(Run* run, const Test* test);
 
     /**
      * This is called when a TestSuite is finished
+     * @param run the run of the test
      * @param test pointer to the corresponding test
      */
-    virtual void endTestSuite(const Test* test);
+    virtual void endTestSuite(Run* run, const Test* test);
 
     /**
      * This is called when the TestRunner is started
+     * @param run the run
      */
-    virtual void startTestRunner();
+    virtual void startTestRunner(Run* run);
 
     /**
      * This is called when the TestRunner is finished
+     * @param run the run
      */
-    virtual void endTestRunner();
+    virtual void endTestRunner(Run* run);
 
 public:
     struct mg_server* server;
     std::mutex critical;
-    bool shouldStop;
-    std::string result;
+    std::atomic<bool> shouldStop;
+    std::atomic<bool> wakeupPending;
+    WebEventLog events;
     std::string suite_name;
     std::size_t suite_size;
 
@@ -130,19 +278,100 @@ public:
 
     std::vector<TestStatus> testStatus;
 
+    // runs[0] is the default run
+    std::vector<std::unique_ptr<Run>> runs;
+    // the actual durations of the finished plan items, from which the
+    // unknown ones are estimated
+    double doneDuration;
+    std::size_t doneCount;
+
+    /**
+     * \brief struct RunStatus is the progress of a run in a Status. The
+     * time left is computed when it is sent, from the expected durations
+     * of the plan items which are not finished yet.
+     */
+    struct RunStatus
+    {
+        std::string name;
+        bool planned;
+        bool finished;
+        std::size_t passed;
+        std::size_t failed;
+        std::size_t planSize;
+        std::size_t done;
+        std::string current;
+        // the expected duration of the items which are not started
+        double left;
+        // the number of the items which are not started and whose expected
+        // duration is unknown
+        std::size_t unknown;
+        // the expected duration and the start time of the running items
+        std::vector<std::pair<double, double>> running;
+    };
+
+    /**
+     * \brief struct Status is an immutable snapshot of the progress. The
+     * listener replaces it as a whole whenever the progress changes, so the
+     * web clients read it without taking \c critical.
+     */
+    struct Status
+    {
+        std::uint64_t version;
+        std::string suite_name;
+        std::size_t suite_size;
+        std::vector<TestStatus> testStatus;
+        std::vector<RunStatus> runs;
+        // the expected duration of an item whose one is unknown, negative
+        // if it cannot be estimated yet
+        double average;
+    };
+
+    // accessed with std::atomic_load and std::atomic_store
+    std::shared_ptr<const Status> status;
+
+    WebMetrics metrics;
+    // the tests which have reported an error and are not finished yet
+    std::unordered_set<const Test*> erroredTests;
+
 private:
     WebProgressListenerImpl(WebProgressListenerImpl const&) = delete;
     void operator=(WebProgressListenerImpl const&) = delete;
 
     WebProgressListenerImpl(unsigned int port,
                             bool verbose);
-    std::string encode(const std::string& data);
+    static std::string encode(const std::string& data);
+    static std::string encodeJson(const std::string& data);
+    static std::string tag(const Run* run);
+    std::string toJson(const char* kind,
+                       const Run* run,
+                       const Test* test,
+                       const TestMessage* msg = nullptr);
+    void publish(WebEvent event);
+    void publishStatus();
+    bool shown(const Run* run) const;
+    void startItem(Run* run, const Test* test);
+    void endItem(Run* run, const Test* test, const TestOutcome& outcome);
+    static double eta(const RunStatus& run, double average, double now);
+    static std::string statusToJson(const Status& snapshot, double now);
+    static void sendStatus(struct mg_connection* conn,
+                           WebProgressListenerImpl* web);
+    void observeEnd(const Test* test, const TestOutcome& outcome, bool suite);
     static void update(void* param);
+    static void sendUpdate(struct mg_connection* conn,
+                           WebProgressListenerImpl* web);
+    static void openStream(struct mg_connection* conn,
+                           WebProgressListenerImpl* web);
+    static void pushEvents(struct mg_connection* conn,
+                           WebProgressListenerImpl* web);
     static int handler(struct mg_connection* conn,
                        enum mg_event ev);
 
 private:
     std::thread* updater;
+    // the JSON of the last snapshot sent to the web clients; used only by
+    // the server thread
+    std::shared_ptr<const Status> sentStatus;
+    std::string sentStatusJson;
     bool verbose;
     unsigned int port;
 };
@@ -0,0 +1,473 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/ArrayCheck.h>
+#include <robottestingframework/Asserter.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+#    include <emmintrin.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+
+namespace {
+
+/**
+ * The scalar predicates are the reference: the SIMD kernels only skip the
+ * blocks of elements in which all of them hold.
+ */
+inline bool is_near(double actual, double expected, double absTolerance, double relTolerance)
+{
+    return (actual == expected) || (std::fabs(actual - expected) <= absTolerance + relTolerance * std::fabs(expected));
+}
+
+/**
+ * Maps the bits of a floating point value to an integer which is ordered
+ * as the values are, so that the ULP distance is a difference of integers.
+ */
+inline int64_t ordered_bits(double value)
+{
+    int64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits < 0) ? numeric_limits<int64_t>::min() - bits : bits;
+}
+
+inline int64_t ordered_bits(float value)
+{
+    int32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits < 0) ? numeric_limits<int32_t>::min() - static_cast<int64_t>(bits) : bits;
+}
+
+template <typename T>
+inline uint64_t ulp_distance(T actual, T expected)
+{
+    int64_t a = ordered_bits(actual);
+    int64_t e = ordered_bits(expected);
+    return (a >= e) ? static_cast<uint64_t>(a) - static_cast<uint64_t>(e)
+                    : static_cast<uint64_t>(e) - static_cast<uint64_t>(a);
+}
+
+#ifdef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+/**
+ * Loads a block of elements as pairs of doubles, so that the float arrays
+ * are checked with the same precision as the scalar predicates.
+ */
+template <typename T>
+struct Lanes;
+
+template <>
+struct Lanes<double>
+{
+    static const size_t width = 2;
+    static void load(const double* values, __m128d* pairs)
+    {
+        pairs[0] = _mm_loadu_pd(values);
+    }
+};
+
+template <>
+struct Lanes<float>
+{
+    static const size_t width = 4;
+    static void load(const float* values, __m128d* pairs)
+    {
+        __m128 block = _mm_loadu_ps(values);
+        pairs[0] = _mm_cvtps_pd(block);
+        pairs[1] = _mm_cvtps_pd(_mm_movehl_ps(block, block));
+    }
+};
+
+inline __m128d abs_pd(__m128d values)
+{
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), values);
+}
+
+inline double sum_pd(__m128d values)
+{
+    double pair[2];
+    _mm_storeu_pd(pair, values);
+    return pair[0] + pair[1];
+}
+
+/**
+ * Tells whether any element of a block may exceed the ULP distance. SSE2
+ * has no 64 bits comparison, therefore only the equal doubles are skipped
+ * and the distance is not used.
+ */
+inline int exceeds_ulps(const double* actual, const double* expected, double /*maxUlps*/)
+{
+    return _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(actual), _mm_loadu_pd(expected)));
+}
+
+/**
+ * The ordered bits of the floats are 32 bits integers; their difference is
+ * computed exactly as doubles.
+ */
+inline __m128i ordered_epi32(__m128i bits)
+{
+    __m128i negative = _mm_srai_epi32(bits, 31);
+    __m128i flipped = _mm_sub_epi32(_mm_set1_epi32(numeric_limits<int32_t>::min()), bits);
+    return _mm_or_si128(_mm_andnot_si128(negative, bits), _mm_and_si128(negative, flipped));
+}
+
+inline int exceeds_ulps(const float* actual, const float* expected, double maxUlps)
+{
+    __m128 a = _mm_loadu_ps(actual);
+    __m128 e = _mm_loadu_ps(expected);
+    __m128i oa = ordered_epi32(_mm_castps_si128(a));
+    __m128i oe = ordered_epi32(_mm_castps_si128(e));
+    __m128d limit = _mm_set1_pd(maxUlps);
+    __m128d low = abs_pd(_mm_sub_pd(_mm_cvtepi32_pd(oa), _mm_cvtepi32_pd(oe)));
+    __m128d high = abs_pd(_mm_sub_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(oa, _MM_SHUFFLE(1, 0, 3, 2))),
+                                     _mm_cvtepi32_pd(_mm_shuffle_epi32(oe, _MM_SHUFFLE(1, 0, 3, 2)))));
+    return _mm_movemask_pd(_mm_cmpgt_pd(low, limit)) | _mm_movemask_pd(_mm_cmpgt_pd(high, limit))
+           | _mm_movemask_ps(_mm_cmpunord_ps(a, e));
+}
+#endif
+
+} // namespace
+
+
+ArrayCheck::ArrayCheck(Kind kind, size_t size, size_t keep) :
+        kind(kind),
+        size(size),
+        keep(keep),
+        count(0),
+        worst{ size, 0, 0, 0 },
+        normValue(0),
+        minNorm(0),
+        maxNorm(0)
+{
+}
+
+void ArrayCheck::mismatch(size_t index, double actual, double expected, double error)
+{
+    if (std::isnan(error)) {
+        error = numeric_limits<double>::infinity();
+    }
+    if (count++ == 0 || error > worst.error) {
+        worst = Mismatch{ index, actual, expected, error };
+    }
+    if (mismatches.size() < keep) {
+        mismatches.push_back(Mismatch{ index, actual, expected, error });
+    }
+}
+
+template <typename T>
+ArrayCheck ArrayCheck::checkNear(const T* actual, const T* expected, size_t size,
+                                 double absTolerance, double relTolerance, size_t keep)
+{
+    ArrayCheck check(Kind::Near, size, keep);
+    auto element = [&](size_t i) {
+        double a = actual[i];
+        double e = expected[i];
+        if (!is_near(a, e, absTolerance, relTolerance)) {
+            check.mismatch(i, a, e, std::fabs(a - e));
+        }
+    };
+
+    size_t i = 0;
+#ifdef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+    const size_t width = Lanes<T>::width;
+    const __m128d absTol = _mm_set1_pd(absTolerance);
+    const __m128d relTol = _mm_set1_pd(relTolerance);
+    for (; i + width <= size; i += width) {
+        __m128d a[width / 2];
+        __m128d e[width / 2];
+        Lanes<T>::load(actual + i, a);
+        Lanes<T>::load(expected + i, e);
+        int bad = 0;
+        for (size_t k = 0; k < width / 2; k++) {
+            __m128d diff = abs_pd(_mm_sub_pd(a[k], e[k]));
+            __m128d tolerance = _mm_add_pd(absTol, _mm_mul_pd(relTol, abs_pd(e[k])));
+            // a NaN compares as "not less or equal" and as "not equal"
+            bad |= _mm_movemask_pd(_mm_and_pd(_mm_cmpnle_pd(diff, tolerance), _mm_cmpneq_pd(a[k], e[k])));
+        }
+        if (bad != 0) {
+            for (size_t j = i; j < i + width; j++) {
+                element(j);
+            }
+        }
+    }
+#endif
+    for (; i < size; i++) {
+        element(i);
+    }
+    return check;
+}
+
+template <typename T>
+ArrayCheck ArrayCheck::checkUlp(const T* actual, const T* expected, size_t size,
+                                uint64_t maxUlps, size_t keep)
+{
+    ArrayCheck check(Kind::Ulp, size, keep);
+    auto element = [&](size_t i) {
+        T a = actual[i];
+        T e = expected[i];
+        if (std::isnan(a) || std::isnan(e)) {
+            check.mismatch(i, a, e, numeric_limits<double>::infinity());
+            return;
+        }
+        uint64_t distance = ulp_distance(a, e);
+        if (distance > maxUlps) {
+            check.mismatch(i, a, e, static_cast<double>(distance));
+        }
+    };
+
+    size_t i = 0;
+#ifdef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+    const size_t width = Lanes<T>::width;
+    const double limit = static_cast<double>(maxUlps);
+    for (; i + width <= size; i += width) {
+        if (exceeds_ulps(actual + i, expected + i, limit) != 0) {
+            for (size_t j = i; j < i + width; j++) {
+                element(j);
+            }
+        }
+    }
+#endif
+    for (; i < size; i++) {
+        element(i);
+    }
+    return check;
+}
+
+template <typename T>
+ArrayCheck ArrayCheck::checkNorm(const T* actual, const T* expected, size_t size,
+                                 double minNorm, double maxNorm)
+{
+    ArrayCheck check(Kind::Norm, size, 0);
+    auto value = [&](size_t i) {
+        return (expected != nullptr) ? static_cast<double>(actual[i]) - static_cast<double>(expected[i])
+                                     : static_cast<double>(actual[i]);
+    };
+
+    double squares = 0;
+    size_t i = 0;
+#ifdef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+    const size_t width = Lanes<T>::width;
+    __m128d sum = _mm_setzero_pd();
+    for (; i + width <= size; i += width) {
+        __m128d a[width / 2];
+        __m128d e[width / 2];
+        Lanes<T>::load(actual + i, a);
+        if (expected != nullptr) {
+            Lanes<T>::load(expected + i, e);
+        }
+        for (size_t k = 0; k < width / 2; k++) {
+            __m128d v = (expected != nullptr) ? _mm_sub_pd(a[k], e[k]) : a[k];
+            sum = _mm_add_pd(sum, _mm_mul_pd(v, v));
+        }
+    }
+    squares = sum_pd(sum);
+#endif
+    for (; i < size; i++) {
+        double v = value(i);
+        squares += v * v;
+    }
+
+    check.normValue = std::sqrt(squares);
+    check.minNorm = minNorm;
+    check.maxNorm = maxNorm;
+    if (!(check.normValue >= minNorm && check.normValue <= maxNorm)) {
+        check.count = 1;
+        check.worst.error = check.normValue;
+    }
+    return check;
+}
+
+template <typename T>
+ArrayCheck ArrayCheck::checkFinite(const T* values, size_t size, size_t keep)
+{
+    ArrayCheck check(Kind::Finite, size, keep);
+    auto element = [&](size_t i) {
+        double v = values[i];
+        if (!std::isfinite(v)) {
+            check.mismatch(i, v, 0, numeric_limits<double>::infinity());
+        }
+    };
+
+    size_t i = 0;
+#ifdef ROBOTTESTINGFRAMEWORK_ARRAYCHECK_SSE2
+    const size_t width = Lanes<T>::width;
+    for (; i + width <= size; i += width) {
+        __m128d v[width / 2];
+        Lanes<T>::load(values + i, v);
+        int bad = 0;
+        for (size_t k = 0; k < width / 2; k++) {
+            // v - v is NaN if and only if v is infinite or NaN
+            __m128d zero = _mm_sub_pd(v[k], v[k]);
+            bad |= _mm_movemask_pd(_mm_cmpunord_pd(zero, zero));
+        }
+        if (bad != 0) {
+            for (size_t j = i; j < i + width; j++) {
+                element(j);
+            }
+        }
+    }
+#endif
+    for (; i < size; i++) {
+        element(i);
+    }
+    return check;
+}
+
+
+ArrayCheck ArrayCheck::closeTo(const double* actual, const double* expected, size_t size,
+                            double absTolerance, double relTolerance, size_t keep)
+{
+    return checkNear(actual, expected, size, absTolerance, relTolerance, keep);
+}
+
+ArrayCheck ArrayCheck::closeTo(const float* actual, const float* expected, size_t size,
+                            double absTolerance, double relTolerance, size_t keep)
+{
+    return checkNear(actual, expected, size, absTolerance, relTolerance, keep);
+}
+
+ArrayCheck ArrayCheck::withinUlps(const double* actual, const double* expected, size_t size,
+                           uint64_t maxUlps, size_t keep)
+{
+    return checkUlp(actual, expected, size, maxUlps, keep);
+}
+
+ArrayCheck ArrayCheck::withinUlps(const float* actual, const float* expected, size_t size,
+                           uint64_t maxUlps, size_t keep)
+{
+    return checkUlp(actual, expected, size, maxUlps, keep);
+}
+
+ArrayCheck ArrayCheck::normWithin(const double* values, size_t size, double minNorm, double maxNorm)
+{
+    return checkNorm<double>(values, nullptr, size, minNorm, maxNorm);
+}
+
+ArrayCheck ArrayCheck::normWithin(const float* values, size_t size, double minNorm, double maxNorm)
+{
+    return checkNorm<float>(values, nullptr, size, minNorm, maxNorm);
+}
+
+ArrayCheck ArrayCheck::distanceWithin(const double* actual, const double* expected, size_t size, double maxNorm)
+{
+    return checkNorm(actual, expected, size, 0, maxNorm);
+}
+
+ArrayCheck ArrayCheck::distanceWithin(const float* actual, const float* expected, size_t size, double maxNorm)
+{
+    return checkNorm(actual, expected, size, 0, maxNorm);
+}
+
+ArrayCheck ArrayCheck::allFinite(const double* values, size_t size, size_t keep)
+{
+    return checkFinite(values, size, keep);
+}
+
+ArrayCheck ArrayCheck::allFinite(const float* values, size_t size, size_t keep)
+{
+    return checkFinite(values, size, keep);
+}
+
+
+bool ArrayCheck::passed() const
+{
+    return count == 0;
+}
+
+size_t ArrayCheck::getSize() const
+{
+    return size;
+}
+
+size_t ArrayCheck::getMismatchCount() const
+{
+    return count;
+}
+
+size_t ArrayCheck::getWorstIndex() const
+{
+    return worst.index;
+}
+
+double ArrayCheck::getWorstError() const
+{
+    return worst.error;
+}
+
+const vector<ArrayCheck::Mismatch>& ArrayCheck::getMismatches() const
+{
+    return mismatches;
+}
+
+double ArrayCheck::getNorm() const
+{
+    return normValue;
+}
+
+string ArrayCheck::describe() const
+{
+    if (kind == Kind::Norm) {
+        return Asserter::format("norm %.10g of %zu elements is %s [%.10g, %.10g]",
+                                normValue,
+                                size,
+                                passed() ? "within" : "not within",
+                                minNorm,
+                                maxNorm);
+    }
+
+    if (passed()) {
+        return Asserter::format((kind == Kind::Finite) ? "all %zu elements are finite" : "all %zu elements match", size);
+    }
+
+    auto error = [this](double value) {
+        return (kind == Kind::Ulp) ? Asserter::format("%.0f ulps", value) : Asserter::format("%.3g", value);
+    };
+    auto element = [this](const Mismatch& m) {
+        return (kind == Kind::Finite) ? Asserter::format("[%zu] %g", m.index, m.actual)
+                                      : Asserter::format("[%zu] %.10g vs %.10g", m.index, m.actual, m.expected);
+    };
+
+    string text;
+    if (kind == Kind::Finite) {
+        text = Asserter::format("%zu of %zu elements are not finite", count, size);
+    } else {
+        text = Asserter::format("%zu of %zu elements mismatch, worst at %s (error %s)",
+                                count,
+                                size,
+                                element(worst).c_str(),
+                                error(worst.error).c_str());
+    }
+    if (!mismatches.empty()) {
+        text += (count > mismatches.size()) ? Asserter::format(", first %zu:", mismatches.size()) : string(":");
+        for (size_t i = 0; i < mismatches.size(); i++) {
+            text += (i > 0) ? ", " : " ";
+            text += element(mismatches[i]);
+        }
+    }
+    return text;
+}
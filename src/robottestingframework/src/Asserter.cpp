@@ -21,13 +21,38 @@
 
 #include <robottestingframework/Asserter.h>
 #include <robottestingframework/Exception.h>
+#include <robottestingframework/TestContext.h>
 
 #include <cstdarg>
 #include <cstdio>
+#include <vector>
 
 using namespace robottestingframework;
 
 
+/**
+ * Returns the test which owns a report. If no test is given,
+ * the one running on the calling thread is used.
+ */
+static TestCase* resolve_test(TestCase* testcase)
+{
+    return (testcase != nullptr) ? testcase : TestContext::currentTest();
+}
+
+/**
+ * Returns the result sink of the given test. The one of the active
+ * context is preferred since it is bound to the calling thread.
+ */
+static TestResult* resolve_result(TestCase* testcase)
+{
+    TestContext* context = TestContext::current();
+    if (context != nullptr && context->getTest() == testcase) {
+        return context->getResult();
+    }
+    return testcase->getResult();
+}
+
+
 void Asserter::fail(TestMessage msg)
 {
     throw TestFailureException(msg);
@@ -60,6 +85,7 @@ void Asserter::error(bool condition,
 void Asserter::report(TestMessage msg,
                       TestCase* testcase)
 {
+    testcase = resolve_test(testcase);
     if (testcase == nullptr) {
         Asserter::error(TestMessage("asserts error with exception",
                                     "Asserter::report is called outside a TestCase!",
@@ -67,7 +93,7 @@ void Asserter::report(TestMessage msg,
                                     msg.getSourceLineNumber()));
         return;
     }
-    testcase->getResult()->addReport(testcase, msg);
+    resolve_result(testcase)->addReport(testcase, msg);
 }
 
 void Asserter::report(TestMessage msg,
@@ -80,6 +106,7 @@ void Asserter::testFail(bool condition,
                         TestMessage msg,
                         TestCase* testcase)
 {
+    testcase = resolve_test(testcase);
     if (testcase == nullptr) {
         Asserter::error(TestMessage("asserts error with exception",
                                     "Asserter::testFail is called outside a TestCase!",
@@ -89,7 +116,7 @@ void Asserter::testFail(bool condition,
     }
     if (!condition) {
         testcase->failed();
-        testcase->getResult()->addFailure(testcase, msg);
+        resolve_result(testcase)->addFailure(testcase, msg);
     }
 }
 
@@ -97,6 +124,7 @@ void Asserter::testCheck(bool condition,
                          TestMessage msg,
                          TestCase* testcase)
 {
+    testcase = resolve_test(testcase);
     if (testcase == nullptr) {
         Asserter::error(TestMessage("asserts error with exception",
                                     "Asserter::testCheck is called outside a TestCase!",
@@ -106,22 +134,53 @@ void Asserter::testCheck(bool condition,
     }
     if (!condition) {
         testcase->failed();
-        testcase->getResult()->addFailure(testcase, msg);
+        resolve_result(testcase)->addFailure(testcase, msg);
     } else {
         Asserter::report(msg, testcase);
     }
 }
 
+TestCase* Asserter::owner(TestCase* testcase,
+                          const char* caller,
+                          const char* filename,
+                          unsigned int line)
+{
+    testcase = resolve_test(testcase);
+    if (testcase == nullptr) {
+        Asserter::error(TestMessage("asserts error with exception",
+                                    std::string(caller) + " is called outside a TestCase!",
+                                    filename,
+                                    line));
+    }
+    return testcase;
+}
+
+TestResult* Asserter::resultOf(TestCase* testcase)
+{
+    return resolve_result(testcase);
+}
+
 std::string Asserter::format(const char* msg, ...)
 {
+    std::string str;
+    if (msg == nullptr) {
+        return str;
+    }
     va_list args;
     va_start(args, msg);
-    std::string str;
-    if (msg != nullptr) {
-        char buf[255];
-        int w = vsnprintf(buf, 255, msg, args);
-        str = buf;
+    char buf[256];
+    va_list retry;
+    va_copy(retry, args);
+    int w = vsnprintf(buf, sizeof(buf), msg, args);
+    if (w > 0 && static_cast<size_t>(w) < sizeof(buf)) {
+        str.assign(buf, w);
+    } else if (w > 0) {
+        // too long for the stack buffer: format it again at its full size
+        std::vector<char> large(w + 1);
+        vsnprintf(large.data(), large.size(), msg, retry);
+        str.assign(large.data(), w);
     }
+    va_end(retry);
     va_end(args);
     return str;
 }
@@ -0,0 +1,70 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/Asserter.h>
+#include <robottestingframework/CheckAggregator.h>
+
+using namespace robottestingframework;
+using namespace std;
+
+
+CheckAggregator::CheckAggregator(unsigned int keep) :
+        keep(keep)
+{
+}
+
+CheckAggregator::Site& CheckAggregator::lookup(const char* msg, const char* filename, unsigned int line)
+{
+    auto key = make_pair(filename, line);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        return sites[it->second];
+    }
+    index.emplace(key, sites.size());
+    sites.push_back(Site{ filename, line, 0, 0, 0, 0, msg, vector<size_t>(), 0 });
+    return sites.back();
+}
+
+void CheckAggregator::flush(TestResult& result, Test* test)
+{
+    vector<Site> flushed;
+    {
+        lock_guard<std::mutex> lock(mutex);
+        flushed.swap(sites);
+        index.clear();
+    }
+
+    for (auto& site : flushed) {
+        // the ring starts from the oldest check when it is full
+        size_t count = site.last.size();
+        size_t first = (count < keep) ? 0 : site.next;
+        for (size_t i = 0; i < count; i++) {
+            size_t iteration = site.last[(first + i) % count];
+            result.addReport(test, TestMessage(site.msg, Asserter::compose("passed at iteration ", iteration), site.filename, site.line));
+        }
+
+        string summary = Asserter::compose("checked ", site.checks, (site.checks == 1) ? " time, " : " times, ", site.failures, (site.failures == 1) ? " failure" : " failures");
+        if (site.failures > 0) {
+            summary += Asserter::compose(", first at iteration ", site.firstFailure);
+        }
+        result.addReport(test, TestMessage("checks summary", summary, site.filename, site.line));
+    }
+}
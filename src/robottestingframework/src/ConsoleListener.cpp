@@ -20,6 +20,7 @@
 
 
 #include <robottestingframework/ConsoleListener.h>
+#include <robottestingframework/TestListenerAdapter.h>
 
 #include <iostream>
 
@@ -112,7 +113,7 @@ void ConsoleListener::endTest(const Test* test)
     }
 
     cout << BLUE << "Test case " << test->getName();
-    if (test->succeeded()) {
+    if (TestListenerAdapter::outcomeOf(test).succeeded()) {
         cout << " passed!" << ENDC << endl;
     } else {
         cout << " failed!" << ENDC << endl;
@@ -135,7 +136,7 @@ void ConsoleListener::endTestSuite(const Test* test)
     }
 
     cout << BLUE << "Test suite " << test->getName();
-    if (test->succeeded()) {
+    if (TestListenerAdapter::outcomeOf(test).succeeded()) {
         cout << " passed!" << ENDC << endl;
     } else {
         cout << " failed!" << ENDC << endl;
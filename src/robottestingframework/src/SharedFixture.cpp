@@ -0,0 +1,174 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/SharedFixture.h>
+
+using namespace robottestingframework;
+
+
+/**
+ * The fixture manager of a single suite which shares the fixture.
+ */
+class SharedFixture::User : public FixtureManager
+{
+public:
+    User(SharedFixture& shared) :
+            shared(shared),
+            active(false),
+            used(false)
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        return shared.acquire(this);
+    }
+
+    void tearDown() override
+    {
+        shared.release(this);
+    }
+
+    bool check() override
+    {
+        return shared.check();
+    }
+
+    SharedFixture& shared;
+    bool active;
+    bool used;
+};
+
+
+SharedFixture::SharedFixture(FixtureManager* manager) :
+        manager(manager),
+        ready(false),
+        collapsed(false),
+        settingUp(false)
+{
+    manager->setDispatcher(this);
+}
+
+
+SharedFixture::~SharedFixture()
+{
+    std::unique_lock<std::recursive_mutex> lock(mutex);
+    changed.wait(lock, [this]() { return !settingUp; });
+    if (ready) {
+        manager->tearDown();
+        ready = false;
+    }
+    manager->setDispatcher(nullptr);
+}
+
+
+FixtureManager* SharedFixture::share()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    users.emplace_back(new User(*this));
+    return users.back().get();
+}
+
+
+FixtureManager* SharedFixture::getFixtureManager()
+{
+    return manager;
+}
+
+
+bool SharedFixture::isSetup()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return ready;
+}
+
+
+bool SharedFixture::acquire(User* user)
+{
+    std::unique_lock<std::recursive_mutex> lock(mutex);
+    user->active = true;
+    user->used = true;
+    // another suite is setting up the fixture
+    changed.wait(lock, [this]() { return !settingUp; });
+    if (ready && !collapsed) {
+        return true;
+    }
+
+    // set up the fixture for the first time or restart it
+    if (ready) {
+        manager->tearDown();
+        ready = false;
+    }
+    collapsed = false;
+
+    // the lock is released during the setup, so that the fixture can be
+    // checked and released by the other suites meanwhile
+    settingUp = true;
+    lock.unlock();
+    bool done = manager->setup();
+    lock.lock();
+    settingUp = false;
+    ready = done;
+    changed.notify_all();
+    return ready;
+}
+
+
+void SharedFixture::release(User* user)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    user->active = false;
+    for (auto& other : users) {
+        // the fixture is still needed by another suite
+        if (other->active || !other->used) {
+            return;
+        }
+    }
+    if (ready) {
+        manager->tearDown();
+        ready = false;
+    }
+}
+
+
+bool SharedFixture::check()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (!ready || collapsed) {
+        return false;
+    }
+    if (!manager->check()) {
+        collapsed = true;
+    }
+    return !collapsed;
+}
+
+
+void SharedFixture::fixtureCollapsed(TestMessage reason)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    collapsed = true;
+    for (auto& user : users) {
+        if (user->active && user->getDispatcher() != nullptr) {
+            user->getDispatcher()->fixtureCollapsed(reason);
+        }
+    }
+}
@@ -0,0 +1,301 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/StreamOutputter.h>
+#include <robottestingframework/TestListenerAdapter.h>
+#include <robottestingframework/TestResult.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#    include <fcntl.h>
+#    include <io.h>
+#else
+#    include <sys/types.h>
+#    include <unistd.h>
+#endif
+
+using namespace robottestingframework;
+using namespace std;
+
+
+StreamOutputter::StreamOutputter(bool verbose) :
+        verbose(verbose),
+        nTests(0),
+        nPasses(0),
+        nFailures(0),
+        nTestSuites(0),
+        nSuitePasses(0),
+        nSuiteFailures(0),
+        end(0),
+        trailerSize(0),
+        firstTime(-1),
+        lastTime(-1)
+{
+}
+
+StreamOutputter::~StreamOutputter()
+{
+    // the derived outputters close the file in their own destructor, since
+    // the document cannot be completed once they are destroyed
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+bool StreamOutputter::open(const std::string& filename, TestMessage* errorMsg)
+{
+    if (filename.empty()) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot open the file.");
+            errorMsg->setDetail("Empty file name.");
+        }
+        return false;
+    }
+
+    this->filename = filename;
+    file.open(filename.c_str(), ios::in | ios::out | ios::trunc | ios::binary);
+    if (!file.is_open() || !file.good()) {
+        if (errorMsg != nullptr) {
+            errorMsg->setMessage("Cannot open the file.");
+            const char* errorStr = strerror(errno);
+            errorMsg->setDetail(errorStr);
+        }
+        return false;
+    }
+    end = 0;
+    trailerSize = 0;
+    begin();
+    append("");
+    return true;
+}
+
+bool StreamOutputter::isOpen() const
+{
+    return file.is_open();
+}
+
+void StreamOutputter::close()
+{
+    if (!file.is_open()) {
+        return;
+    }
+    finish();
+    append("");
+    file.close();
+}
+
+void StreamOutputter::replay(const TestResultCollector& collector)
+{
+    collector.visit([this](const ResultEvent& e) {
+        TestResult::setEventTime(e.getTimestamp());
+        double elapsed = 0;
+        if (e.getKind() == ResultEvent::Kind::Timeout) {
+            elapsed = static_cast<const ResultEventTimeout&>(e).getElapsed();
+        }
+        event(e.getKind(), e.getTest(), e.getMessage(), elapsed);
+    });
+    TestResult::setEventTime(0);
+}
+
+void StreamOutputter::addReport(const Test* test, TestMessage msg)
+{
+    event(ResultEvent::Kind::Report, test, msg);
+}
+
+void StreamOutputter::addError(const Test* test, TestMessage msg)
+{
+    event(ResultEvent::Kind::Error, test, msg);
+}
+
+void StreamOutputter::addFailure(const Test* test, TestMessage msg)
+{
+    event(ResultEvent::Kind::Failure, test, msg);
+}
+
+void StreamOutputter::addTimeout(const Test* test, TestMessage msg, double elapsed)
+{
+    event(ResultEvent::Kind::Timeout, test, msg, elapsed);
+}
+
+void StreamOutputter::startTest(const Test* test)
+{
+    event(ResultEvent::Kind::StartTest, test, TestMessage());
+}
+
+void StreamOutputter::endTest(const Test* test)
+{
+    event(ResultEvent::Kind::EndTest, test, TestMessage());
+}
+
+void StreamOutputter::startTestSuite(const Test* test)
+{
+    event(ResultEvent::Kind::StartSuite, test, TestMessage());
+}
+
+void StreamOutputter::endTestSuite(const Test* test)
+{
+    event(ResultEvent::Kind::EndSuite, test, TestMessage());
+}
+
+void StreamOutputter::endTestRunner()
+{
+    close();
+}
+
+void StreamOutputter::begin()
+{
+}
+
+void StreamOutputter::finish()
+{
+}
+
+std::string StreamOutputter::trailer() const
+{
+    return "";
+}
+
+void StreamOutputter::append(const std::string& record, bool flush)
+{
+    streamoff size = end + static_cast<streamoff>(trailerSize);
+    file.seekp(end);
+    file << record;
+    end = file.tellp();
+
+    string text = trailer();
+    file << text;
+    trailerSize = text.size();
+
+    // a shorter document leaves the end of the previous one behind
+    if (end + static_cast<streamoff>(trailerSize) < size) {
+        resize(end + static_cast<streamoff>(trailerSize));
+    } else if (flush) {
+        file.flush();
+    }
+}
+
+std::streamoff StreamOutputter::position() const
+{
+    return end;
+}
+
+void StreamOutputter::replace(std::streamoff offset, std::size_t size, const std::string& text)
+{
+    streamoff from = offset + static_cast<streamoff>(size);
+    streamoff to = end + static_cast<streamoff>(trailerSize);
+    streamoff delta = static_cast<streamoff>(text.size()) - static_cast<streamoff>(size);
+    move(from, to, delta);
+    file.seekp(offset);
+    file << text;
+    end += delta;
+    if (delta < 0) {
+        resize(to + delta);
+    } else {
+        file.flush();
+    }
+}
+
+void StreamOutputter::move(std::streamoff from, std::streamoff to, std::streamoff delta)
+{
+    if (delta == 0) {
+        return;
+    }
+
+    // the blocks are moved from the end when the text grows, so that none
+    // is overwritten before being read
+    const streamoff blockSize = 64 * 1024;
+    vector<char> block;
+    for (streamoff moved = 0; moved < to - from;) {
+        streamoff size = std::min(blockSize, to - from - moved);
+        streamoff pos = (delta > 0) ? to - moved - size : from + moved;
+        block.resize(static_cast<size_t>(size));
+        file.seekg(pos);
+        file.read(block.data(), size);
+        file.seekp(pos + delta);
+        file.write(block.data(), size);
+        moved += size;
+    }
+}
+
+void StreamOutputter::resize(std::streamoff size)
+{
+    // if the file cannot be cut, the end of the previous document is left
+    // after the complete one
+    file.flush();
+#if defined(_WIN32)
+    int fd = _open(filename.c_str(), _O_WRONLY | _O_BINARY);
+    if (fd >= 0) {
+        _chsize_s(fd, size);
+        _close(fd);
+    }
+#else
+    int result = ::truncate(filename.c_str(), static_cast<off_t>(size));
+    (void)result;
+#endif
+}
+
+double StreamOutputter::elapsed() const
+{
+    return (firstTime < 0) ? 0 : TestResult::eventTime() - firstTime;
+}
+
+double StreamOutputter::duration() const
+{
+    return (firstTime < 0) ? 0 : lastTime - firstTime;
+}
+
+void StreamOutputter::event(ResultEvent::Kind kind,
+                            const Test* test,
+                            const TestMessage& msg,
+                            double elapsed)
+{
+    if (!file.is_open()) {
+        return;
+    }
+
+    double time = TestResult::eventTime();
+    if (firstTime < 0) {
+        firstTime = time;
+    }
+    lastTime = time;
+
+    switch (kind) {
+    case ResultEvent::Kind::StartTest:
+        nTests++;
+        break;
+    case ResultEvent::Kind::EndTest:
+        (TestListenerAdapter::outcomeOf(test).succeeded()) ? nPasses++ : nFailures++;
+        break;
+    case ResultEvent::Kind::StartSuite:
+        nTestSuites++;
+        break;
+    case ResultEvent::Kind::EndSuite:
+        (TestListenerAdapter::outcomeOf(test).succeeded()) ? nSuitePasses++ : nSuiteFailures++;
+        break;
+    default:
+        break;
+    }
+    handle(kind, test, msg, elapsed);
+}
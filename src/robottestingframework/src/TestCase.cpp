@@ -20,13 +20,33 @@
 
 
 #include <robottestingframework/Arguments.h>
+#include <robottestingframework/CheckAggregator.h>
 #include <robottestingframework/Exception.h>
 #include <robottestingframework/TestCase.h>
+#include <robottestingframework/TestContext.h>
 #include <robottestingframework/TestMessage.h>
 
+#include <robottestingframework/Asserter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
 
 #define C_MAXARGS 128 // max number of the command parametes
 
@@ -35,35 +55,221 @@ using namespace std;
 
 
 /**
- * In case of any abnormal behaviour of the test case
- * catch the abortion signal and add the proper messege
- * to the result collector.
+ * In case of any abnormal behaviour of the test case the process cannot
+ * safely continue: the state of the other tests and of the TestResult (whose
+ * lock may be held by another thread) is unknown, and a signal handler may
+ * neither take locks nor throw. Therefore it only writes a message using
+ * async-signal-safe calls and exits. A crash of a single test case is
+ * reported without stopping the run only when it runs in its own process
+ * (see the --isolate option of robottestingframework-testrunner).
+ */
+static void run_signal_handler(int signum)
+{
+    if (TestContext::current() == nullptr) {
+        // not within a test case (e.g., a thread spawned by the test)
+        std::signal(SIGSEGV, SIG_DFL);
+        std::signal(SIGABRT, SIG_DFL);
+        std::raise(signum);
+        return;
+    }
+    static const char message[] = "Terminated due to segmentation violation/abortion within the test case! "
+                                  "(The test cases can be run in separate processes using --isolate option.)\n";
+#if defined(_WIN32)
+    _write(2, message, sizeof(message) - 1);
+#else
+    ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)written;
+#endif
+    std::_Exit(EXIT_FAILURE);
+}
+
+/**
+ * The signal handlers are process wide; they are installed by the first
+ * running test case and restored when the last one is finished.
+ */
+static std::mutex _signalMutex;
+static unsigned int _signalUsers = 0;
+static bool _signalEnabled = true;
+
+static void install_signal_handler()
+{
+    std::lock_guard<std::mutex> lock(_signalMutex);
+    if (_signalUsers++ == 0 && _signalEnabled) {
+        std::signal(SIGSEGV, run_signal_handler);
+        std::signal(SIGABRT, run_signal_handler);
+    }
+}
+
+static void restore_signal_handler()
+{
+    std::lock_guard<std::mutex> lock(_signalMutex);
+    if (_signalUsers > 0 && --_signalUsers == 0 && _signalEnabled) {
+        std::signal(SIGSEGV, SIG_DFL);
+        std::signal(SIGABRT, SIG_DFL);
+    }
+}
+
+
+/**
+ * The watchdog of a test case with a timeout. It reports the timeout and
+ * interrupts the test when the timeout expires; if the test does not stop
+ * within the grace period, the process is aborted.
+ */
+static bool _timeoutAbortEnabled = true;
+
+namespace {
+class Watchdog
+{
+public:
+    Watchdog(TestCase* test, TestResult* result) :
+            test(test),
+            result(result),
+            done(false)
+    {
+        if (test->getTimeout() > 0) {
+            thread = std::thread(&Watchdog::watch, this);
+        }
+    }
+
+    ~Watchdog()
+    {
+        stop();
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        cond.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+private:
+    void watch()
+    {
+        using seconds = std::chrono::duration<double>;
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        if (cond.wait_for(lock, seconds(test->getTimeout()), [this]() { return done; })) {
+            return;
+        }
+        lock.unlock();
+
+        double elapsed = seconds(std::chrono::steady_clock::now() - start).count();
+        test->failed();
+        result->addTimeout(test,
+                           TestMessage("timeout",
+                                       Asserter::format("The test exceeded its timeout of %.3f s after %.3f s",
+                                                        test->getTimeout(),
+                                                        elapsed),
+                                       ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                       ROBOTTESTINGFRAMEWORK_SOURCELINE()),
+                           elapsed);
+        test->interrupt();
+
+        lock.lock();
+        if (cond.wait_for(lock, seconds(test->getTimeoutGrace()), [this]() { return done; })) {
+            return;
+        }
+        lock.unlock();
+        if (!_timeoutAbortEnabled) {
+            return;
+        }
+        result->addError(test,
+                         TestMessage("timeout",
+                                     Asserter::format("The test did not stop within %.3f s after being interrupted. Aborting!",
+                                                      test->getTimeoutGrace()),
+                                     ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                     ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        // the whole process is aborted: deliver the queued events, including
+        // the timeout, and let the listeners complete their outputs first
+        result->endTest(test);
+        result->endTestRunner();
+        result->flush();
+        std::cout.flush();
+        std::signal(SIGABRT, SIG_DFL);
+        std::abort();
+    }
+
+private:
+    TestCase* test;
+    TestResult* result;
+    bool done;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread thread;
+};
+} // namespace
+
+
+/**
+ * Computes the statistics of the latencies of the benchmark iterations.
+ * The percentiles are computed using the nearest-rank method.
  */
-static TestCase* _currentTestCase = nullptr;
-static void run_signal_handler(int /*unused*/)
-{
-    if (_currentTestCase != nullptr) {
-        _currentTestCase->getResult()->addError(_currentTestCase,
-                                                TestMessage("asserts error with exception",
-                                                            "Terminated due to segmentation violation/abortion within the test case!",
-                                                            ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
-                                                            ROBOTTESTINGFRAMEWORK_SOURCELINE()));
-        _currentTestCase->getResult()->endTest(_currentTestCase);
+static Test::StatisticContainer latency_statistics(std::vector<double> latencies)
+{
+    Test::StatisticContainer statistics;
+    statistics.emplace_back("iterations", static_cast<double>(latencies.size()));
+    if (latencies.empty()) {
+        return statistics;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    size_t count = latencies.size();
+    double mean = std::accumulate(latencies.begin(), latencies.end(), 0.0) / count;
+    double median = (count % 2 == 1) ? latencies[count / 2] : (latencies[count / 2 - 1] + latencies[count / 2]) / 2;
+    auto percentile = [&](double p) {
+        auto rank = static_cast<size_t>(std::ceil(p / 100.0 * count));
+        return latencies[(rank > 0) ? rank - 1 : 0];
+    };
+    double variance = 0;
+    for (double latency : latencies) {
+        variance += (latency - mean) * (latency - mean);
     }
-    std::signal(SIGSEGV, SIG_DFL);
-    std::signal(SIGABRT, SIG_DFL);
-    throw TestErrorException(TestMessage("Terminated due to segmentation violation or abort signal!"));
+    variance = (count > 1) ? variance / (count - 1) : 0;
+
+    statistics.emplace_back("min", latencies.front());
+    statistics.emplace_back("mean", mean);
+    statistics.emplace_back("median", median);
+    statistics.emplace_back("p90", percentile(90));
+    statistics.emplace_back("p99", percentile(99));
+    statistics.emplace_back("max", latencies.back());
+    statistics.emplace_back("stddev", std::sqrt(variance));
+    return statistics;
+}
+
+
+void TestCase::setTimeoutAbortEnabled(bool enabled)
+{
+    _timeoutAbortEnabled = enabled;
+}
+
+
+void TestCase::setCrashHandlerEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_signalMutex);
+    _signalEnabled = enabled;
 }
 
 
 TestCase::TestCase(std::string name, std::string param) :
         Test(name),
         param(std::move(param)),
-        successful(true),
         result(nullptr),
-        repetition(0)
+        successful(true),
+        interrupted(false),
+        repetition(0),
+        benchmark(false),
+        warmup(0),
+        timeout(0),
+        grace(5.0),
+        aggregation(false),
+        checkKeep(1)
 {
-    _currentTestCase = this;
 }
 
 TestCase::~TestCase() = default;
@@ -104,6 +310,22 @@ std::string TestCase::getEnvironment()
     return environment;
 }
 
+void TestCase::setTimeout(double timeout, double grace)
+{
+    this->timeout = (timeout > 0) ? timeout : 0;
+    this->grace = (grace > 0) ? grace : 0;
+}
+
+double TestCase::getTimeout() const
+{
+    return timeout;
+}
+
+double TestCase::getTimeoutGrace() const
+{
+    return grace;
+}
+
 void TestCase::setRepetition(unsigned int rep)
 {
     repetition = rep;
@@ -114,6 +336,43 @@ unsigned int TestCase::getRepetition()
     return repetition;
 }
 
+void TestCase::setBenchmark(bool enabled, unsigned int warmup)
+{
+    benchmark = enabled;
+    this->warmup = warmup;
+}
+
+bool TestCase::isBenchmark() const
+{
+    return benchmark;
+}
+
+unsigned int TestCase::getWarmup() const
+{
+    return warmup;
+}
+
+void TestCase::setCheckAggregation(bool enabled, unsigned int keep)
+{
+    aggregation = enabled;
+    checkKeep = keep;
+}
+
+bool TestCase::isCheckAggregation() const
+{
+    return aggregation;
+}
+
+unsigned int TestCase::getCheckKeep() const
+{
+    return checkKeep;
+}
+
+CheckAggregator* TestCase::getCheckAggregator()
+{
+    return aggregator.get();
+}
+
 
 bool TestCase::setup(int argc, char** argv)
 {
@@ -131,15 +390,41 @@ void TestCase::run(TestResult& rsl)
     this->result = &rsl;
     successful = true;
     interrupted = false;
+    setDuration(0);
+    setDurations(DurationContainer());
+    setStatistics(StatisticContainer());
+    aggregator.reset(new CheckAggregator(checkKeep));
+    std::vector<double> latencies;
+
+    // time the setup, each repetition of the run and the tearDown
+    double start = TestResult::now();
+    double phaseStart = start;
+    string phase;
+    auto beginPhase = [&](const string& name) {
+        phase = name;
+        phaseStart = TestResult::now();
+    };
+    auto endPhase = [&]() {
+        if (!phase.empty()) {
+            addDuration(phase, TestResult::now() - phaseStart);
+            phase.clear();
+        }
+    };
 
     // call setup and run
     char* szcmd;
     char** szarg;
 
-    std::signal(SIGSEGV, run_signal_handler);
-    std::signal(SIGABRT, run_signal_handler);
+    TestContext context(this, result);
+    install_signal_handler();
+    Watchdog watchdog(this, result);
     try {
+        // the start event is stamped with the start of the test, so that
+        // the start and end events enclose its duration
+        start = TestResult::now();
+        TestResult::setEventTime(start);
         result->startTest(this);
+        TestResult::setEventTime(0);
 
         // parsing the argument to pass to the setup
         string strCmd = getName() + string(" ") + param;
@@ -150,9 +435,16 @@ void TestCase::run(TestResult& rsl)
         Arguments::parse(szcmd, &nargs, szarg);
         szarg[nargs] = nullptr;
         // call the setup
-        if (!setup(nargs, szarg)) {
+        beginPhase("setup");
+        bool setupOk = setup(nargs, szarg);
+        endPhase();
+        if (!setupOk) {
             result->addError(this, TestMessage("setup() failed!"));
             successful = false;
+            watchdog.stop();
+            setDuration(TestResult::now() - start);
+            restore_signal_handler();
+            aggregator->flush(*result, this);
             result->endTest(this);
             // clear allocated memory for arguments
             if (szcmd != nullptr) {
@@ -166,34 +458,64 @@ void TestCase::run(TestResult& rsl)
             return;
         }
 
-        for (unsigned int rep = 0; rep <= repetition && successful && !interrupted; rep++) {
-            run();
+        if (benchmark) {
+            // the warm-up iterations are not accounted
+            beginPhase("warmup");
+            for (unsigned int rep = 0; rep < warmup && successful && !interrupted; rep++) {
+                run();
+            }
+            endPhase();
+            beginPhase("run");
+            for (unsigned int rep = 0; rep <= repetition && successful && !interrupted; rep++) {
+                double iteration = TestResult::now();
+                run();
+                latencies.push_back(TestResult::now() - iteration);
+            }
+            endPhase();
+        } else {
+            for (unsigned int rep = 0; rep <= repetition && successful && !interrupted; rep++) {
+                beginPhase((repetition > 0) ? Asserter::format("run #%u", rep + 1) : string("run"));
+                run();
+                endPhase();
+            }
         }
     } catch (TestFailureException& e) {
+        endPhase();
         successful = false;
         result->addFailure(this, e.message());
     } catch (TestErrorException& e) {
+        endPhase();
         successful = false;
         result->addError(this, e.message());
     } catch (std::exception& e) {
+        endPhase();
         successful = false;
         result->addError(this, TestMessage(e.what()));
     }
 
     // call tearDown and catch the error exception
     try {
+        beginPhase("tearDown");
         tearDown();
+        endPhase();
     } catch (TestErrorException& e) {
+        endPhase();
         successful = false;
         result->addError(this, e.message());
     } catch (std::exception& e) {
+        endPhase();
         successful = false;
         result->addError(this, TestMessage(e.what()));
     }
 
-    std::signal(SIGSEGV, SIG_DFL);
-    std::signal(SIGABRT, SIG_DFL);
+    watchdog.stop();
+    restore_signal_handler();
+    setDuration(TestResult::now() - start);
+    if (benchmark) {
+        setStatistics(latency_statistics(latencies));
+    }
 
+    aggregator->flush(*result, this);
     result->endTest(this);
 
     // clear allocated memory for arguments if it is not cleared
@@ -207,8 +529,16 @@ void TestCase::run(TestResult& rsl)
     }
 }
 
+bool TestCase::isInterrupted() const
+{
+    return interrupted;
+}
+
 void TestCase::interrupt()
 {
     interrupted = true;
+    if (result == nullptr) {
+        return;
+    }
     result->addReport(this, TestMessage("TestCase interrupted", "An interrupt signal received", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
 }
@@ -0,0 +1,78 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestContext.h>
+
+using namespace robottestingframework;
+
+
+static thread_local TestContext* _currentContext = nullptr;
+
+
+TestContext::TestContext(TestCase* test, TestResult* result) :
+        test(test),
+        result(result),
+        previous(_currentContext)
+{
+    _currentContext = this;
+}
+
+
+TestContext::~TestContext()
+{
+    _currentContext = previous;
+}
+
+
+TestCase* TestContext::getTest() const
+{
+    return test;
+}
+
+
+TestResult* TestContext::getResult() const
+{
+    return result;
+}
+
+
+void TestContext::interrupt()
+{
+    test->interrupt();
+}
+
+
+bool TestContext::isInterrupted() const
+{
+    return test->isInterrupted();
+}
+
+
+TestContext* TestContext::current()
+{
+    return _currentContext;
+}
+
+
+TestCase* TestContext::currentTest()
+{
+    return (_currentContext != nullptr) ? _currentContext->test : nullptr;
+}
@@ -0,0 +1,90 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestListenerAdapter.h>
+
+using namespace robottestingframework;
+
+
+// the event which is being delivered to a TestListener by the calling thread
+static thread_local const TestEvent* _event = nullptr;
+
+
+TestListenerAdapter::TestListenerAdapter(TestListener& listener) :
+        listener(listener)
+{
+}
+
+
+TestListener& TestListenerAdapter::getListener() const
+{
+    return listener;
+}
+
+
+void TestListenerAdapter::handleEvent(const TestEvent& event)
+{
+    // a listener may issue other events while handling this one
+    const TestEvent* previous = _event;
+    _event = &event;
+    switch (event.getKind()) {
+    case TestEvent::Kind::Report:
+        listener.addReport(event.getTest(), event.getMessage());
+        break;
+    case TestEvent::Kind::Error:
+        listener.addError(event.getTest(), event.getMessage());
+        break;
+    case TestEvent::Kind::Failure:
+        listener.addFailure(event.getTest(), event.getMessage());
+        break;
+    case TestEvent::Kind::Timeout:
+        listener.addTimeout(event.getTest(), event.getMessage(), event.getElapsed());
+        break;
+    case TestEvent::Kind::StartTest:
+        listener.startTest(event.getTest());
+        break;
+    case TestEvent::Kind::EndTest:
+        listener.endTest(event.getTest());
+        break;
+    case TestEvent::Kind::StartSuite:
+        listener.startTestSuite(event.getTest());
+        break;
+    case TestEvent::Kind::EndSuite:
+        listener.endTestSuite(event.getTest());
+        break;
+    case TestEvent::Kind::StartRunner:
+        listener.startTestRunner();
+        break;
+    case TestEvent::Kind::EndRunner:
+        listener.endTestRunner();
+        break;
+    }
+    _event = previous;
+}
+
+
+TestOutcome TestListenerAdapter::outcomeOf(const Test* test)
+{
+    if (_event != nullptr && _event->getTest() == test && _event->getOutcome() != nullptr) {
+        return *_event->getOutcome();
+    }
+    return (test != nullptr) ? TestOutcome(*test) : TestOutcome();
+}
@@ -21,91 +21,257 @@
 
 #include <robottestingframework/TestMessage.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
 using namespace robottestingframework;
 
 
+/**
+ * The shared content of the messages. The strings point either to the
+ * interned ones or to the own copies of the payload.
+ */
+struct TestMessage::Payload
+{
+    std::atomic<unsigned int> refs;
+    unsigned int lineNumber;
+    const std::string* message;
+    const std::string* detail;
+    const std::string* fileName;
+    std::string ownMessage;
+    std::string ownDetail;
+    std::string ownFileName;
+};
+
+
+// The pool of the interned strings is bounded, so that the unique strings
+// (e.g., formatted details) cannot make it grow during long runs: once it
+// is full, the strings are copied in the payloads. The pool is never freed
+// and each thread caches the last strings it has looked up to avoid taking
+// the lock.
+static const size_t maxPooledStrings = 4096;
+static const size_t maxPooledLength = 256;
+static const size_t cacheSize = 64;
+
+static thread_local const std::string* pooledCache[cacheSize];
+static thread_local const char* literalKeys[cacheSize];
+static thread_local const std::string* literalCache[cacheSize];
+
+static const std::string& empty_string()
+{
+    static const std::string* empty = new std::string();
+    return *empty;
+}
+
+static const std::string* intern(const std::string& str)
+{
+    if (str.empty()) {
+        return &empty_string();
+    }
+    if (str.size() > maxPooledLength) {
+        return nullptr;
+    }
+    const std::string*& cached = pooledCache[std::hash<std::string>()(str) % cacheSize];
+    if (cached != nullptr && *cached == str) {
+        return cached;
+    }
+
+    static std::mutex* mutex = new std::mutex();
+    static std::unordered_set<std::string>* pool = new std::unordered_set<std::string>();
+    std::lock_guard<std::mutex> lock(*mutex);
+    auto itr = pool->find(str);
+    if (itr == pool->end()) {
+        if (pool->size() >= maxPooledStrings) {
+            return nullptr;
+        }
+        itr = pool->insert(str).first;
+    }
+    cached = &*itr;
+    return cached;
+}
+
+static const std::string* intern_literal(const char* str)
+{
+    // the same pointer may hold another string (e.g., a reused buffer)
+    size_t slot = (reinterpret_cast<uintptr_t>(str) >> 4) % cacheSize;
+    if (literalKeys[slot] == str && strcmp(literalCache[slot]->c_str(), str) == 0) {
+        return literalCache[slot];
+    }
+    const std::string* pooled = intern(std::string(str));
+    if (pooled != nullptr) {
+        literalKeys[slot] = str;
+        literalCache[slot] = pooled;
+    }
+    return pooled;
+}
+
+
 TestMessage::TestMessage() :
-        strFileName(""), lineNumber(0)
+        payload(nullptr)
 {
 }
 
 
-TestMessage::TestMessage(const TestMessage& other)
+TestMessage::TestMessage(const TestMessage& other) :
+        payload(other.payload)
 {
-    *this = other;
+    if (payload != nullptr) {
+        payload->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+TestMessage::TestMessage(TestMessage&& other) noexcept :
+        payload(other.payload)
+{
+    other.payload = nullptr;
 }
 
 TestMessage::TestMessage(const std::string msg,
                          const std::string filename,
-                         unsigned int line)
+                         unsigned int line) :
+        payload(nullptr)
 {
-    strMessage = msg;
-    strFileName = filename;
-    lineNumber = line;
+    assign(msg, empty_string(), filename, line);
 }
 
 TestMessage::TestMessage(const std::string msg,
                          const std::string detail,
                          const std::string filename,
+                         unsigned int line) :
+        payload(nullptr)
+{
+    assign(msg, detail, filename, line);
+}
+
+TestMessage::TestMessage(const std::string msg,
+                         const std::string detail,
+                         const char* filename,
+                         unsigned int line) :
+        payload(nullptr)
+{
+    const std::string* pooled = (filename != nullptr) ? intern_literal(filename) : &empty_string();
+    if (pooled != nullptr) {
+        assign(msg, detail, *pooled, line);
+    } else {
+        assign(msg, detail, std::string(filename), line);
+    }
+}
+
+TestMessage::~TestMessage()
+{
+    release();
+}
+
+TestMessage& TestMessage::operator=(const TestMessage& other)
+{
+    if (other.payload != nullptr) {
+        other.payload->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    release();
+    payload = other.payload;
+    return *this;
+}
+
+TestMessage& TestMessage::operator=(TestMessage&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        payload = other.payload;
+        other.payload = nullptr;
+    }
+    return *this;
+}
+
+
+void TestMessage::assign(const std::string& msg,
+                         const std::string& detail,
+                         const std::string& filename,
                          unsigned int line)
 {
-    strMessage = msg;
-    strDetail = detail;
-    strFileName = filename;
-    lineNumber = line;
+    // the arguments may belong to the current payload
+    Payload* content = nullptr;
+    if (!msg.empty() || !detail.empty() || !filename.empty() || line != 0) {
+        content = new Payload();
+        content->refs.store(1, std::memory_order_relaxed);
+        content->lineNumber = line;
+        content->message = intern(msg);
+        if (content->message == nullptr) {
+            content->ownMessage = msg;
+            content->message = &content->ownMessage;
+        }
+        content->detail = intern(detail);
+        if (content->detail == nullptr) {
+            content->ownDetail = detail;
+            content->detail = &content->ownDetail;
+        }
+        content->fileName = intern(filename);
+        if (content->fileName == nullptr) {
+            content->ownFileName = filename;
+            content->fileName = &content->ownFileName;
+        }
+    }
+    release();
+    payload = content;
 }
 
-TestMessage::~TestMessage() = default;
+
+void TestMessage::release()
+{
+    if (payload != nullptr && payload->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete payload;
+    }
+    payload = nullptr;
+}
 
 
 void TestMessage::setMessage(const std::string message)
 {
-    strMessage = message;
+    assign(message, getDetail(), getSourceFileName(), getSourceLineNumber());
 }
 
 
 void TestMessage::setDetail(const std::string detail)
 {
-    strDetail = detail;
+    assign(getMessage(), detail, getSourceFileName(), getSourceLineNumber());
 }
 
-std::string TestMessage::getMessage()
+const std::string& TestMessage::getMessage() const
 {
-    return strMessage;
+    return (payload != nullptr) ? *payload->message : empty_string();
 }
 
-std::string TestMessage::getDetail()
+const std::string& TestMessage::getDetail() const
 {
-    return strDetail;
+    return (payload != nullptr) ? *payload->detail : empty_string();
 }
 
 
 void TestMessage::setSourceLineNumber(unsigned int line)
 {
-    lineNumber = line;
+    assign(getMessage(), getDetail(), getSourceFileName(), line);
 }
 
 
-unsigned int TestMessage::getSourceLineNumber()
+unsigned int TestMessage::getSourceLineNumber() const
 {
-    return lineNumber;
+    return (payload != nullptr) ? payload->lineNumber : 0;
 }
 
 
 void TestMessage::setSourceFileName(const std::string filename)
 {
-    strFileName = filename;
+    assign(getMessage(), getDetail(), filename, getSourceLineNumber());
 }
 
-std::string TestMessage::getSourceFileName()
+const std::string& TestMessage::getSourceFileName() const
 {
-    return strFileName;
+    return (payload != nullptr) ? *payload->fileName : empty_string();
 }
 
 void TestMessage::clear()
 {
-    lineNumber = 0;
-    strFileName.clear();
-    strMessage.clear();
-    strDetail.clear();
+    release();
 }
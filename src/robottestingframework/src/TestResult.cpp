@@ -19,81 +19,577 @@
  */
 
 
+#include <robottestingframework/TestListenerAdapter.h>
 #include <robottestingframework/TestResult.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+
 using namespace robottestingframework;
 
-#define CALL_LISTENERS(method, ...)        \
-    for (const auto& listener : listeners) \
-        listener->method(__VA_ARGS__);
+static thread_local double _eventTime = 0;
+
+
+/**
+ * @brief The TestResult::Entry struct keeps a listener together with its
+ * interests, its batching and its pending batch. The TestListener are
+ * wrapped by an adapter.
+ */
+struct TestResult::Entry
+{
+    TestEventListener* listener;
+    TestListener* legacy;
+    std::unique_ptr<TestListenerAdapter> adapter;
+    unsigned int interests;
+    TestEventListener::BatchMode batchMode;
+    double batchPeriod;
+    std::vector<TestEvent> batch;
+};
+
+
+/**
+ * @brief The TestResult::Dispatcher class delivers the events of a TestResult
+ * to its listeners from a dedicated thread. The events are pushed into a
+ * bounded ring buffer whose cells carry a sequence number which tells whether
+ * they are free or published: the producers claim a cell with a single
+ * compare-and-swap and never take a lock, unless the dispatcher is sleeping
+ * and has to be woken up.
+ */
+class TestResult::Dispatcher
+{
+public:
+    Dispatcher(TestResult& result, std::size_t capacity, OverflowPolicy policy);
+    ~Dispatcher();
+
+    /**
+     * @brief push queues an event
+     * @return false if the event has to be delivered by the caller, that is
+     * if it is issued by a listener from the dispatcher thread
+     */
+    bool push(TestEvent&& event);
+
+    void flush();
+
+    std::size_t dropped() const
+    {
+        return droppedEvents.load();
+    }
 
-TestResult::TestResult() = default;
+    std::size_t pending() const
+    {
+        // delivered is read first: it never overtakes the enqueued events
+        std::size_t done = delivered.load();
+        return enqueuePos.load() - done;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        TestEvent event;
+    };
+
+    bool isDispatcher() const
+    {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+    bool isReady() const;
+    void run();
+
+private:
+    TestResult& result;
+    OverflowPolicy policy;
+    std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    std::atomic<std::size_t> enqueuePos;
+    std::size_t dequeuePos;
+    std::atomic<std::size_t> delivered;
+    std::atomic<std::size_t> droppedEvents;
+    std::atomic<bool> sleeping;
+    std::atomic<int> flushing;
+    bool stopping;
+    std::mutex waitMutex;
+    std::condition_variable wakeup;
+    std::condition_variable drained;
+    std::thread thread;
+};
+
+
+TestResult::Dispatcher::Dispatcher(TestResult& result,
+                                   std::size_t capacity,
+                                   OverflowPolicy policy) :
+        result(result),
+        policy(policy),
+        mask(1),
+        enqueuePos(0),
+        dequeuePos(0),
+        delivered(0),
+        droppedEvents(0),
+        sleeping(false),
+        flushing(0),
+        stopping(false)
+{
+    // the capacity is rounded up to a power of two to index the cells
+    // by masking the positions
+    while (mask + 1 < capacity) {
+        mask = (mask << 1) | 1;
+    }
+    cells.reset(new Cell[mask + 1]);
+    for (std::size_t i = 0; i <= mask; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    thread = std::thread(&Dispatcher::run, this);
+}
+
+
+TestResult::Dispatcher::~Dispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+}
+
+
+bool TestResult::Dispatcher::push(TestEvent&& event)
+{
+    if (isDispatcher()) {
+        return false;
+    }
+
+    Cell* cell;
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    unsigned int retries = 0;
+    while (true) {
+        cell = &cells[pos & mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // the queue is full
+            if (event.getKind() == TestEvent::Kind::Report && policy == OverflowPolicy::DropReports) {
+                droppedEvents++;
+                return true;
+            }
+            if (++retries < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event = std::move(event);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    // pairs with the fence in run(): either the dispatcher sees the event
+    // or this thread sees that it is sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        wakeup.notify_one();
+    }
+    return true;
+}
+
+
+void TestResult::Dispatcher::flush()
+{
+    if (isDispatcher()) {
+        return;
+    }
+    std::size_t target = enqueuePos.load();
+    flushing++;
+    {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        while (delivered.load() < target) {
+            drained.wait(lock);
+        }
+    }
+    flushing--;
+}
+
+
+bool TestResult::Dispatcher::isReady() const
+{
+    return cells[dequeuePos & mask].sequence.load(std::memory_order_acquire) == dequeuePos + 1;
+}
+
+
+void TestResult::Dispatcher::run()
+{
+    while (true) {
+        if (isReady()) {
+            Cell& cell = cells[dequeuePos & mask];
+            result.dispatch(cell.event);
+            // do not keep the message alive until the cell is reused
+            cell.event = TestEvent();
+            cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            delivered.store(++dequeuePos);
+            if (flushing.load() > 0) {
+                std::lock_guard<std::mutex> lock(waitMutex);
+                drained.notify_all();
+            }
+            continue;
+        }
+
+        // only this thread adds events to the batches, so none becomes due
+        // earlier while it is sleeping
+        double due = result.deliverDueBatches();
+        std::unique_lock<std::mutex> lock(waitMutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool timedOut = false;
+        while (!isReady() && !stopping && !timedOut) {
+            if (due < 0) {
+                wakeup.wait(lock);
+            } else {
+                timedOut = (wakeup.wait_for(lock, std::chrono::duration<double>(due)) == std::cv_status::timeout);
+            }
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+        if (stopping && !isReady()) {
+            break;
+        }
+    }
+}
+
+
+TestResult::TestResult() :
+        interests(TestEvent::NoKinds)
+{
+}
 
 
 TestResult::~TestResult()
 {
-    reset();
+    // the pending batches are dropped: their listeners may be gone
+    dispatcher.reset();
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    listeners.clear();
 }
 
 
 void TestResult::addListener(TestListener* listener)
 {
-    listeners.insert(listener);
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (const auto& entry : listeners) {
+        if (entry->legacy == listener) {
+            return;
+        }
+    }
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->adapter.reset(new TestListenerAdapter(*listener));
+    entry->listener = entry->adapter.get();
+    entry->legacy = listener;
+    entry->interests = TestEvent::AllKinds;
+    entry->batchMode = TestEventListener::BatchMode::None;
+    entry->batchPeriod = 0;
+    listeners.push_back(std::move(entry));
+    updateInterests();
+}
+
+
+void TestResult::addListener(TestEventListener* listener)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (const auto& entry : listeners) {
+        if (entry->listener == listener) {
+            return;
+        }
+    }
+    std::unique_ptr<Entry> entry(new Entry());
+    entry->listener = listener;
+    entry->legacy = nullptr;
+    entry->interests = listener->getInterests() & TestEvent::AllKinds;
+    entry->batchMode = listener->getBatchMode();
+    entry->batchPeriod = listener->getBatchPeriod();
+    listeners.push_back(std::move(entry));
+    updateInterests();
 }
 
 
 void TestResult::removeListener(TestListener* listener)
 {
-    listeners.erase(listener);
+    flush();
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    listeners.erase(std::remove_if(listeners.begin(),
+                                   listeners.end(),
+                                   [listener](const std::unique_ptr<Entry>& entry) { return entry->legacy == listener; }),
+                    listeners.end());
+    updateInterests();
+}
+
+
+void TestResult::removeListener(TestEventListener* listener)
+{
+    flush();
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    listeners.erase(std::remove_if(listeners.begin(),
+                                   listeners.end(),
+                                   [listener](const std::unique_ptr<Entry>& entry) { return entry->listener == listener; }),
+                    listeners.end());
+    updateInterests();
 }
 
 
 void TestResult::reset()
 {
+    flush();
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     listeners.clear();
+    updateInterests();
 }
 
+
+void TestResult::updateInterests()
+{
+    unsigned int all = TestEvent::NoKinds;
+    for (const auto& entry : listeners) {
+        all |= entry->interests;
+    }
+    interests.store(all, std::memory_order_relaxed);
+}
+
+
+void TestResult::setAsync(bool enabled, std::size_t capacity, OverflowPolicy policy)
+{
+    // the pending events are delivered before the dispatcher is stopped
+    dispatcher.reset();
+    if (enabled) {
+        dispatcher.reset(new Dispatcher(*this, capacity, policy));
+    }
+}
+
+
+bool TestResult::isAsync() const
+{
+    return dispatcher != nullptr;
+}
+
+
+void TestResult::flush()
+{
+    if (dispatcher) {
+        dispatcher->flush();
+    }
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (size_t i = 0; i < listeners.size(); i++) {
+        deliverBatch(*listeners[i]);
+    }
+}
+
+
+std::size_t TestResult::droppedCount() const
+{
+    return dispatcher ? dispatcher->dropped() : 0;
+}
+
+
+std::size_t TestResult::pendingCount() const
+{
+    return dispatcher ? dispatcher->pending() : 0;
+}
+
+
+bool TestResult::isWanted(TestEvent::Kind kind) const
+{
+    return (interests.load(std::memory_order_relaxed) & TestEvent::mask(kind)) != 0;
+}
+
+
+void TestResult::issue(TestEvent&& event)
+{
+    bool end = (event.getKind() == TestEvent::Kind::EndRunner);
+    if (dispatcher && dispatcher->push(std::move(event))) {
+        if (end) {
+            dispatcher->flush();
+        }
+        return;
+    }
+    dispatch(event);
+}
+
+
+void TestResult::dispatch(const TestEvent& event)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    double time = _eventTime;
+    _eventTime = event.getTime();
+    unsigned int kind = TestEvent::mask(event.getKind());
+    // a listener may add other listeners while handling the event
+    for (size_t i = 0; i < listeners.size(); i++) {
+        Entry& entry = *listeners[i];
+        if ((entry.interests & kind) == 0) {
+            continue;
+        }
+        if (entry.batchMode == TestEventListener::BatchMode::None) {
+            entry.listener->handleEvent(event);
+            continue;
+        }
+        entry.batch.push_back(event);
+        bool complete = (event.getKind() == TestEvent::Kind::StartRunner || event.getKind() == TestEvent::Kind::EndRunner);
+        if (entry.batchMode == TestEventListener::BatchMode::PerTest) {
+            complete |= (event.getKind() == TestEvent::Kind::EndTest || event.getKind() == TestEvent::Kind::EndSuite);
+        } else {
+            complete |= (event.getTime() - entry.batch.front().getTime() >= entry.batchPeriod);
+        }
+        if (complete) {
+            deliverBatch(entry);
+        }
+    }
+    _eventTime = time;
+}
+
+
+double TestResult::deliverDueBatches()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    double due = -1;
+    // a listener may add other listeners while handling the batch
+    for (size_t i = 0; i < listeners.size(); i++) {
+        Entry& entry = *listeners[i];
+        if (entry.batchMode != TestEventListener::BatchMode::Period || entry.batch.empty()) {
+            continue;
+        }
+        double left = entry.batch.front().getTime() + entry.batchPeriod - now();
+        if (left <= 0) {
+            deliverBatch(entry);
+        } else if (due < 0 || left < due) {
+            due = left;
+        }
+    }
+    return due;
+}
+
+
+void TestResult::deliverBatch(Entry& entry)
+{
+    if (entry.batch.empty()) {
+        return;
+    }
+    // the listener may issue other events while handling the batch
+    std::vector<TestEvent> batch;
+    batch.swap(entry.batch);
+    entry.listener->handleEvents(batch.data(), batch.size());
+    if (entry.batch.empty()) {
+        batch.clear();
+        entry.batch.swap(batch);
+    }
+}
+
+
+void TestResult::addEvent(const TestEvent& event)
+{
+    if (isWanted(event.getKind())) {
+        issue(TestEvent(event));
+    }
+}
+
+
 void TestResult::addReport(const Test* test, TestMessage msg)
 {
-    CALL_LISTENERS(addReport, test, msg);
+    if (isWanted(TestEvent::Kind::Report)) {
+        issue(TestEvent(TestEvent::Kind::Report, test, std::move(msg), 0, eventTime()));
+    }
 }
 
 void TestResult::addError(const Test* test, TestMessage msg)
 {
-    CALL_LISTENERS(addError, test, msg);
+    if (isWanted(TestEvent::Kind::Error)) {
+        issue(TestEvent(TestEvent::Kind::Error, test, std::move(msg), 0, eventTime()));
+    }
 }
 
 void TestResult::addFailure(const Test* test, TestMessage msg)
 {
-    CALL_LISTENERS(addFailure, test, msg);
+    if (isWanted(TestEvent::Kind::Failure)) {
+        issue(TestEvent(TestEvent::Kind::Failure, test, std::move(msg), 0, eventTime()));
+    }
+}
+
+void TestResult::addTimeout(const Test* test, TestMessage msg, double elapsed)
+{
+    if (isWanted(TestEvent::Kind::Timeout)) {
+        issue(TestEvent(TestEvent::Kind::Timeout, test, std::move(msg), elapsed, eventTime()));
+    }
 }
 
 void TestResult::startTest(const Test* test)
 {
-    CALL_LISTENERS(startTest, test);
+    if (isWanted(TestEvent::Kind::StartTest)) {
+        issue(TestEvent(TestEvent::Kind::StartTest, test, TestMessage(), 0, eventTime()));
+    }
+}
+
+/**
+ * The outcome is taken by the thread which ends the test, since the events
+ * may be delivered when the test is already run again.
+ */
+static std::shared_ptr<const TestOutcome> outcomeOf(const Test* test)
+{
+    return (test != nullptr) ? std::make_shared<const TestOutcome>(*test) : nullptr;
 }
 
 void TestResult::endTest(const Test* test)
 {
-    CALL_LISTENERS(endTest, test);
+    if (isWanted(TestEvent::Kind::EndTest)) {
+        issue(TestEvent(TestEvent::Kind::EndTest, test, TestMessage(), 0, eventTime(), outcomeOf(test)));
+    }
 }
 
 void TestResult::startTestSuite(const Test* test)
 {
-    CALL_LISTENERS(startTestSuite, test);
+    if (isWanted(TestEvent::Kind::StartSuite)) {
+        issue(TestEvent(TestEvent::Kind::StartSuite, test, TestMessage(), 0, eventTime()));
+    }
 }
 
 void TestResult::endTestSuite(const Test* test)
 {
-    CALL_LISTENERS(endTestSuite, test);
+    if (isWanted(TestEvent::Kind::EndSuite)) {
+        issue(TestEvent(TestEvent::Kind::EndSuite, test, TestMessage(), 0, eventTime(), outcomeOf(test)));
+    }
 }
 
 void TestResult::startTestRunner()
 {
-    CALL_LISTENERS(startTestRunner);
+    if (isWanted(TestEvent::Kind::StartRunner)) {
+        issue(TestEvent(TestEvent::Kind::StartRunner, nullptr, TestMessage(), 0, eventTime()));
+    }
 }
 
 void TestResult::endTestRunner()
 {
-    CALL_LISTENERS(endTestRunner);
+    if (isWanted(TestEvent::Kind::EndRunner)) {
+        issue(TestEvent(TestEvent::Kind::EndRunner, nullptr, TestMessage(), 0, eventTime()));
+    }
+}
+
+double TestResult::now()
+{
+    auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(time).count();
+}
+
+double TestResult::eventTime()
+{
+    return (_eventTime > 0) ? _eventTime : now();
+}
+
+void TestResult::setEventTime(double time)
+{
+    _eventTime = time;
 }
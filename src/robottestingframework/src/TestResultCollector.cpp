@@ -19,11 +19,124 @@
  */
 
 
+#include <robottestingframework/TestListenerAdapter.h>
+#include <robottestingframework/TestResult.h>
 #include <robottestingframework/TestResultCollector.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
 using namespace robottestingframework;
 
-TestResultCollector::TestResultCollector()
+// the mark of a spilled event which is kept in memory
+static const uint8_t PINNED_EVENT = 0xFF;
+
+// the memory used by an event besides its slot
+static std::size_t event_size(const ResultEvent& e)
+{
+    const TestMessage& msg = e.getMessage();
+    return msg.getMessage().size() + msg.getDetail().size() + msg.getSourceFileName().size();
+}
+
+static ResultEvent* construct_event(void* slot,
+                                    ResultEvent::Kind kind,
+                                    const Test* test,
+                                    TestMessage msg,
+                                    double elapsed)
+{
+    switch (kind) {
+    case ResultEvent::Kind::Report:
+        return new (slot) ResultEventReport(test, std::move(msg));
+    case ResultEvent::Kind::Error:
+        return new (slot) ResultEventError(test, std::move(msg));
+    case ResultEvent::Kind::Timeout:
+        return new (slot) ResultEventTimeout(test, std::move(msg), elapsed);
+    case ResultEvent::Kind::Failure:
+        return new (slot) ResultEventFailure(test, std::move(msg));
+    case ResultEvent::Kind::StartTest:
+        return new (slot) ResultEventStartTest(test, std::move(msg));
+    case ResultEvent::Kind::EndTest:
+        return new (slot) ResultEventEndTest(test, std::move(msg));
+    case ResultEvent::Kind::StartSuite:
+        return new (slot) ResultEventStartSuite(test, std::move(msg));
+    case ResultEvent::Kind::EndSuite:
+        return new (slot) ResultEventEndSuite(test, std::move(msg));
+    }
+    return nullptr;
+}
+
+static ResultEvent* copy_event(void* slot, const ResultEvent& e)
+{
+    double elapsed = 0;
+    if (e.getKind() == ResultEvent::Kind::Timeout) {
+        elapsed = static_cast<const ResultEventTimeout&>(e).getElapsed();
+    }
+    ResultEvent* copy = construct_event(slot, e.getKind(), e.getTest(), e.getMessage(), elapsed);
+    copy->setTimestamp(e.getTimestamp());
+    return copy;
+}
+
+template <typename T>
+static void write_value(std::string& buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void write_string(std::string& buffer, const std::string& text)
+{
+    write_value<uint32_t>(buffer, static_cast<uint32_t>(text.size()));
+    buffer += text;
+}
+
+template <typename T>
+static T read_value(const char*& data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return value;
+}
+
+static std::string read_string(const char*& data)
+{
+    auto size = read_value<uint32_t>(data);
+    std::string text(data, size);
+    data += size;
+    return text;
+}
+
+static bool seek(std::FILE* file, long long offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+// the slots are sized for the largest event
+static_assert(sizeof(ResultEventReport) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventError) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventFailure) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventStartTest) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventEndTest) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventStartSuite) <= sizeof(ResultEventTimeout)
+                      && sizeof(ResultEventEndSuite) <= sizeof(ResultEventTimeout),
+              "ResultEventTimeout must be the largest ResultEvent");
+
+constexpr std::size_t TestResultCollector::chunkSize;
+
+TestResultCollector::TestResultCollector() :
+        nEvents(0),
+        budget(0),
+        residentBytes(0),
+        segmentFile(nullptr),
+        segmentSize(0),
+        firstTime(0),
+        lastTime(0)
 {
     nPasses = nFailures = nTests = 0;
     nSuitePasses = nSuiteFailures = nTestSuites = 0;
@@ -37,11 +150,56 @@ TestResultCollector::~TestResultCollector()
 void TestResultCollector::reset()
 {
     nPasses = nFailures = nTests = 0;
-    TestResultCollector::EventResultIterator it;
-    for (it = events.begin(); it != events.end(); ++it) {
-        delete *(it);
+    for (std::size_t i = segments.size(); i < chunks.size(); i++) {
+        destroy(chunks[i].get(), std::min(chunkSize, nEvents - i * chunkSize));
     }
+    for (auto& chunk : restored) {
+        if (chunk) {
+            destroy(chunk.get(), chunkSize);
+        }
+    }
+    for (auto& segment : segments) {
+        for (ResultEvent* event : segment.pinned) {
+            event->~ResultEvent();
+            delete reinterpret_cast<EventSlot*>(event);
+        }
+    }
+    nEvents = 0;
+    chunks.clear();
     events.clear();
+    segments.clear();
+    restored.clear();
+    residentBytes = 0;
+    firstTime = lastTime = 0;
+
+    if (segmentFile != nullptr) {
+        std::fclose(segmentFile);
+        if (!segmentFileName.empty()) {
+            std::remove(segmentFileName.c_str());
+        }
+        segmentFile = nullptr;
+        segmentSize = 0;
+    }
+}
+
+void TestResultCollector::setMemoryBudget(std::size_t bytes, const std::string& filename)
+{
+    budget = bytes;
+    segmentFileName = filename;
+}
+
+std::size_t TestResultCollector::getMemoryBudget() const
+{
+    return budget;
+}
+
+std::size_t TestResultCollector::spilledCount() const
+{
+    std::size_t count = 0;
+    for (const auto& segment : segments) {
+        count += chunkSize - segment.pinned.size();
+    }
+    return count;
 }
 
 unsigned int TestResultCollector::testCount()
@@ -74,59 +232,263 @@ unsigned int TestResultCollector::passedSuiteCount()
     return nSuitePasses;
 }
 
+double TestResultCollector::duration()
+{
+    return lastTime - firstTime;
+}
+
+std::size_t TestResultCollector::eventCount() const
+{
+    return nEvents;
+}
+
+void TestResultCollector::visit(const EventVisitor& visitor) const
+{
+    std::size_t i = 0;
+
+    // the spilled events are read back one chunk at a time
+    for (std::size_t index = 0; index < segments.size(); index++, i += chunkSize) {
+        std::unique_ptr<EventSlot[]> chunk = load(index);
+        if (!chunk) {
+            continue;
+        }
+        for (std::size_t j = 0; j < chunkSize; j++) {
+            visitor(*reinterpret_cast<ResultEvent*>(&chunk[j]));
+        }
+        destroy(chunk.get(), chunkSize);
+    }
+
+    for (; i < nEvents; i++) {
+        visitor(*getEvent(i));
+    }
+}
+
 TestResultCollector::EventResultContainer& TestResultCollector::getResults()
 {
+    // the view is extended with the events collected since the last call
+    events.reserve(nEvents);
+    for (std::size_t i = events.size(); i < nEvents; i++) {
+        std::size_t index = i / chunkSize;
+        if (index < segments.size()) {
+            if (restored.size() <= index) {
+                restored.resize(index + 1);
+            }
+            if (!restored[index]) {
+                restored[index] = load(index);
+                if (!restored[index]) {
+                    break;
+                }
+            }
+            events.push_back(reinterpret_cast<ResultEvent*>(&restored[index][i % chunkSize]));
+        } else {
+            events.push_back(getEvent(i));
+        }
+    }
     return events;
 }
 
+ResultEvent* TestResultCollector::getEvent(std::size_t index) const
+{
+    return reinterpret_cast<ResultEvent*>(&chunks[index / chunkSize][index % chunkSize]);
+}
+
+void* TestResultCollector::allocateEvent()
+{
+    if (nEvents == chunks.size() * chunkSize) {
+        chunks.emplace_back(new EventSlot[chunkSize]);
+        residentBytes += chunkSize * sizeof(EventSlot);
+    }
+    return &chunks[nEvents / chunkSize][nEvents % chunkSize];
+}
+
+void TestResultCollector::addEvent(ResultEvent* event)
+{
+    // the events are accessed through their slot
+    assert(static_cast<void*>(event) == static_cast<void*>(getEvent(nEvents)));
+    event->setTimestamp(TestResult::eventTime());
+    if (nEvents == 0) {
+        firstTime = event->getTimestamp();
+    }
+    lastTime = event->getTimestamp();
+    nEvents++;
+
+    // the oldest full chunks are spilled when the budget is exceeded
+    residentBytes += event_size(*event);
+    while (budget > 0 && residentBytes > budget && segments.size() + 1 < chunks.size()) {
+        spill();
+    }
+}
+
+void TestResultCollector::spill()
+{
+    if (segmentFile == nullptr) {
+        segmentFile = segmentFileName.empty() ? std::tmpfile() : std::fopen(segmentFileName.c_str(), "w+b");
+        if (segmentFile == nullptr) {
+            // the events are kept in memory
+            budget = 0;
+            return;
+        }
+    }
+
+    std::size_t index = segments.size();
+    EventSlot* chunk = chunks[index].get();
+    Segment segment;
+    segment.offset = segmentSize;
+    std::size_t freed = chunkSize * sizeof(EventSlot);
+    std::string buffer;
+    for (std::size_t i = 0; i < chunkSize; i++) {
+        const ResultEvent& e = *reinterpret_cast<ResultEvent*>(&chunk[i]);
+        if (e.getKind() == ResultEvent::Kind::Failure
+            || e.getKind() == ResultEvent::Kind::Error
+            || e.getKind() == ResultEvent::Kind::Timeout) {
+            // the failures are never evicted from memory
+            segment.pinned.push_back(copy_event(new EventSlot, e));
+            freed -= sizeof(EventSlot);
+            write_value<uint8_t>(buffer, PINNED_EVENT);
+            continue;
+        }
+        const TestMessage& msg = e.getMessage();
+        freed += event_size(e);
+        write_value<uint8_t>(buffer, static_cast<uint8_t>(e.getKind()));
+        write_value<uint64_t>(buffer, reinterpret_cast<std::uintptr_t>(e.getTest()));
+        write_value<double>(buffer, e.getTimestamp());
+        write_value<uint32_t>(buffer, msg.getSourceLineNumber());
+        write_string(buffer, msg.getMessage());
+        write_string(buffer, msg.getDetail());
+        write_string(buffer, msg.getSourceFileName());
+    }
+
+    if (!seek(segmentFile, segmentSize)
+        || std::fwrite(buffer.data(), 1, buffer.size(), segmentFile) != buffer.size()
+        || std::fflush(segmentFile) != 0) {
+        // the events are kept in memory
+        for (ResultEvent* event : segment.pinned) {
+            event->~ResultEvent();
+            delete reinterpret_cast<EventSlot*>(event);
+        }
+        budget = 0;
+        return;
+    }
+    segment.size = buffer.size();
+    segmentSize += buffer.size();
+    segments.push_back(std::move(segment));
+    destroy(chunk, chunkSize);
+    chunks[index].reset();
+    residentBytes -= freed;
+
+    // the view is rebuilt from the spilled events
+    if (events.size() > index * chunkSize) {
+        events.resize(index * chunkSize);
+    }
+}
+
+std::unique_ptr<TestResultCollector::EventSlot[]> TestResultCollector::load(std::size_t index) const
+{
+    const Segment& segment = segments[index];
+    std::string buffer(segment.size, '\0');
+    if (!seek(segmentFile, segment.offset)
+        || std::fread(&buffer[0], 1, buffer.size(), segmentFile) != buffer.size()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<EventSlot[]> chunk(new EventSlot[chunkSize]);
+    const char* data = buffer.data();
+    std::size_t pinned = 0;
+    for (std::size_t i = 0; i < chunkSize; i++) {
+        auto kind = read_value<uint8_t>(data);
+        if (kind == PINNED_EVENT) {
+            copy_event(&chunk[i], *segment.pinned[pinned++]);
+            continue;
+        }
+        auto test = reinterpret_cast<const Test*>(static_cast<std::uintptr_t>(read_value<uint64_t>(data)));
+        auto timestamp = read_value<double>(data);
+        auto line = read_value<uint32_t>(data);
+        std::string message = read_string(data);
+        std::string detail = read_string(data);
+        std::string filename = read_string(data);
+        ResultEvent* e = construct_event(&chunk[i],
+                                         static_cast<ResultEvent::Kind>(kind),
+                                         test,
+                                         TestMessage(message, detail, filename, line),
+                                         0);
+        e->setTimestamp(timestamp);
+    }
+    return chunk;
+}
+
+void TestResultCollector::destroy(EventSlot* chunk, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        reinterpret_cast<ResultEvent*>(&chunk[i])->~ResultEvent();
+    }
+}
+
 void TestResultCollector::addReport(const Test* test,
                                     TestMessage msg)
 {
-    events.push_back(new ResultEventReport(test, msg));
+    addEvent(new (allocateEvent()) ResultEventReport(test, std::move(msg)));
 }
 
 void TestResultCollector::addError(const Test* test,
                                    TestMessage msg)
 {
-    events.push_back(new ResultEventError(test, msg));
+    addEvent(new (allocateEvent()) ResultEventError(test, std::move(msg)));
 }
 
 
 void TestResultCollector::addFailure(const Test* test,
                                      TestMessage msg)
 {
-    events.push_back(new ResultEventFailure(test, msg));
+    addEvent(new (allocateEvent()) ResultEventFailure(test, std::move(msg)));
+}
+
+
+void TestResultCollector::addTimeout(const Test* test,
+                                     TestMessage msg,
+                                     double elapsed)
+{
+    addEvent(new (allocateEvent()) ResultEventTimeout(test, std::move(msg), elapsed));
+}
+
+
+// the start and end events share the same message
+static const TestMessage& startedMessage()
+{
+    static const TestMessage msg("started");
+    return msg;
+}
+
+static const TestMessage& endedMessage()
+{
+    static const TestMessage msg("ended");
+    return msg;
 }
 
 
 void TestResultCollector::startTest(const Test* test)
 {
     nTests++;
-    events.push_back(new ResultEventStartTest(test,
-                                              TestMessage("started")));
+    addEvent(new (allocateEvent()) ResultEventStartTest(test, startedMessage()));
 }
 
 
 void TestResultCollector::endTest(const Test* test)
 {
-    (test->succeeded()) ? nPasses++ : nFailures++;
-    events.push_back(new ResultEventEndTest(test,
-                                            TestMessage("ended")));
+    (TestListenerAdapter::outcomeOf(test).succeeded()) ? nPasses++ : nFailures++;
+    addEvent(new (allocateEvent()) ResultEventEndTest(test, endedMessage()));
 }
 
 
 void TestResultCollector::startTestSuite(const Test* test)
 {
     nTestSuites++;
-    events.push_back(new ResultEventStartSuite(test,
-                                               TestMessage("started")));
+    addEvent(new (allocateEvent()) ResultEventStartSuite(test, startedMessage()));
 }
 
 
 void TestResultCollector::endTestSuite(const Test* test)
 {
 
-    (test->succeeded()) ? nSuitePasses++ : nSuiteFailures++;
-    events.push_back(new ResultEventEndSuite(test,
-                                             TestMessage("ended")));
+    (TestListenerAdapter::outcomeOf(test).succeeded()) ? nSuitePasses++ : nSuiteFailures++;
+    addEvent(new (allocateEvent()) ResultEventEndSuite(test, endedMessage()));
 }
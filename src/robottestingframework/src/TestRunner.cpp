@@ -22,12 +22,47 @@
 #include <robottestingframework/TestRunner.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
 
 using namespace robottestingframework;
 
 
+namespace {
+
+/**
+ * @brief The EventBuffer class records the events of a test run by a
+ * worker thread, so that they can be delivered to the shared TestResult
+ * as a single group once the test is finished. The events keep the time
+ * at which they have been issued.
+ */
+class EventBuffer : public TestEventListener
+{
+public:
+    void handleEvent(const TestEvent& event) override
+    {
+        events.push_back(event);
+    }
+
+    void replay(TestResult& result)
+    {
+        for (const auto& event : events) {
+            result.addEvent(event);
+        }
+        events.clear();
+    }
+
+private:
+    std::vector<TestEvent> events;
+};
+
+} // namespace
+
+
 TestRunner::TestRunner() :
-        current(nullptr)
+        interrupted(false),
+        jobs(1)
 {
 }
 
@@ -62,22 +97,116 @@ void TestRunner::reset()
 void TestRunner::run(TestResult& result)
 {
     interrupted = false;
+
+    // the running tests are interrupted by this thread rather than by
+    // interrupt(), which can be called from a signal handler
+    std::mutex doneMutex;
+    std::condition_variable doneCond;
+    bool done = false;
+    std::thread watcher([&]() {
+        std::set<Test*> stopped;
+        std::unique_lock<std::mutex> lock(doneMutex);
+        while (!done) {
+            doneCond.wait_for(lock, std::chrono::milliseconds(50));
+            if (interrupted && !done) {
+                lock.unlock();
+                interruptRunning(stopped);
+                lock.lock();
+            }
+        }
+    });
+
     result.startTestRunner();
-    for (auto& test : tests) {
-        if (interrupted) {
-            break;
+    if (jobs > 1 && tests.size() > 1) {
+        runParallel(result);
+    } else {
+        for (auto& test : tests) {
+            if (interrupted) {
+                break;
+            }
+            runTest(test, result);
         }
-        current = test;
-        test->run(result);
     }
     result.endTestRunner();
-    current = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done = true;
+    }
+    doneCond.notify_one();
+    watcher.join();
 }
 
-void TestRunner::interrupt()
+
+void TestRunner::runTest(Test* test, TestResult& result)
 {
-    if (current != nullptr) {
-        current->interrupt();
+    {
+        std::lock_guard<std::mutex> lock(runningMutex);
+        running.insert(test);
     }
+    test->run(result);
+    {
+        std::lock_guard<std::mutex> lock(runningMutex);
+        running.erase(test);
+    }
+}
+
+
+void TestRunner::runParallel(TestResult& result)
+{
+    std::atomic<size_t> next(0);
+    std::mutex flushMutex;
+    auto worker = [&]() {
+        EventBuffer buffer;
+        TestResult local;
+        local.addListener(&buffer);
+        size_t index;
+        while (!interrupted && (index = next++) < tests.size()) {
+            runTest(tests[index], local);
+            std::lock_guard<std::mutex> lock(flushMutex);
+            buffer.replay(result);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t count = std::min(jobs, tests.size());
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+
+void TestRunner::interrupt()
+{
     interrupted = true;
 }
+
+
+void TestRunner::interruptRunning(std::set<Test*>& stopped)
+{
+    // the tests which start after the interruption are interrupted as well
+    std::lock_guard<std::mutex> lock(runningMutex);
+    for (auto& test : running) {
+        if (stopped.insert(test).second) {
+            test->interrupt();
+        }
+    }
+}
+
+
+void TestRunner::setJobs(std::size_t jobs)
+{
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->jobs = jobs;
+}
+
+
+std::size_t TestRunner::getJobs() const
+{
+    return jobs;
+}
@@ -21,24 +21,32 @@
 
 #include <robottestingframework/Exception.h>
 #include <robottestingframework/TestMessage.h>
+#include <robottestingframework/TestResult.h>
 #include <robottestingframework/TestSuite.h>
 
 #include <algorithm>
+#include <chrono>
 
 using namespace robottestingframework;
 
 TestSuite::TestSuite(std::string name) :
         Test(name),
+        current(nullptr),
+        result(nullptr),
         successful(true),
         fixtureOK(true),
-        result(nullptr),
+        interrupted(false),
         fixtureMessage(""),
-        current(nullptr)
+        monitorPeriod(0),
+        monitorStopped(true)
 {
 }
 
 
-TestSuite::~TestSuite() = default;
+TestSuite::~TestSuite()
+{
+    stopMonitor();
+}
 
 void TestSuite::addTest(Test* test)
 {
@@ -62,6 +70,7 @@ void TestSuite::reset()
     tests.clear();
     successful = fixtureOK = true;
     result = nullptr;
+    std::lock_guard<std::mutex> lock(fixtureMutex);
     fixtureMessage.clear();
 }
 
@@ -101,58 +110,83 @@ void TestSuite::tearDown()
 }
 
 
+bool TestSuite::checkFixtures()
+{
+    bool checkOk = true;
+    FixtureIterator itr;
+    for (itr = fixtureManagers.begin(); (itr != fixtureManagers.end()) && checkOk; itr++) {
+        checkOk &= (*itr)->check();
+    }
+    return checkOk;
+}
+
+
 void TestSuite::run(TestResult& rsl)
 {
     this->result = &rsl;
     successful = fixtureOK = true;
     interrupted = false;
-    fixtureMessage.clear();
+    {
+        std::lock_guard<std::mutex> lock(fixtureMutex);
+        fixtureMessage.clear();
+    }
+    setDuration(0);
+    setDurations(DurationContainer());
+    double start = TestResult::now();
+    double phaseStart = start;
     try {
         result->startTestSuite(this);
         // calling test suite setup
-        if (!setup()) {
+        phaseStart = TestResult::now();
+        bool setupOk = setup();
+        addDuration("fixture setup", TestResult::now() - phaseStart);
+        if (!setupOk) {
             result->addError(this, TestMessage("setup() failed!"));
             successful = false;
+            setDuration(TestResult::now() - start);
             result->endTestSuite(this);
             return;
         }
 
+        // check the fixtures periodically while the tests are running
+        startMonitor();
+
         // calling all test's run
         for (auto& test : tests) {
-            current = test;
             // interrupted?
             if (interrupted) {
                 throw TestFailureException(TestMessage("interrupted!"));
             }
 
             if (!fixtureOK) {
+                std::lock_guard<std::mutex> lock(fixtureMutex);
                 result->addError(this, fixtureMessage);
             }
 
-            bool checkOk = true;
-            FixtureIterator itr;
-            for (itr = fixtureManagers.begin(); (itr != fixtureManagers.end()) && checkOk; itr++) {
-                checkOk &= (*itr)->check();
-            }
-            if (!checkOk) {
-                result->addError(this, TestMessage("Fixture collapsed", "check() failed", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
-                fixtureOK = false;
+            // the fixtures are checked here if the monitor is disabled
+            if (monitorPeriod <= 0) {
+                phaseStart = TestResult::now();
+                bool checkOk = checkFixtures();
+                addDuration("fixture check", TestResult::now() - phaseStart);
+                if (!checkOk) {
+                    result->addError(this, TestMessage("Fixture collapsed", "check() failed", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+                    fixtureOK = false;
+                }
             }
 
             // restart the fixture if it has been collapsed
             if (!fixtureOK) {
                 successful = false;
                 result->addReport(this, TestMessage("reports", "restarting fixture setup", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+                phaseStart = TestResult::now();
+                stopMonitor();
                 tearDown();
-                if (!setup()) {
+                bool setupOk = setup();
+                bool checkOk = setupOk && checkFixtures();
+                addDuration("fixture restart", TestResult::now() - phaseStart);
+                if (!setupOk) {
                     throw FixtureException(TestMessage("setup() failed!"));
                 }
-
-                bool checkOk = true;
-                FixtureIterator itr;
-                for (itr = fixtureManagers.begin(); (itr != fixtureManagers.end()) && checkOk; itr++) {
-                    checkOk &= (*itr)->check();
-                }
                 if (!checkOk) {
                     throw FixtureException(TestMessage("Fixture collapsed",
                                                        "check() failed",
@@ -160,10 +194,20 @@ void TestSuite::run(TestResult& rsl)
                                                        ROBOTTESTINGFRAMEWORK_SOURCELINE()));
                 }
                 fixtureOK = true;
+                startMonitor();
             }
+            setCurrent(test);
             test->run(*result);
+            setCurrent(nullptr);
             successful &= test->succeeded();
         }
+
+        // the fixture may have been collapsed during the last test
+        if (!fixtureOK) {
+            successful = false;
+            std::lock_guard<std::mutex> lock(fixtureMutex);
+            result->addError(this, fixtureMessage);
+        }
     } catch (TestFailureException& e) {
         successful = false;
         result->addFailure(this, e.message());
@@ -178,7 +222,11 @@ void TestSuite::run(TestResult& rsl)
         result->addError(this, TestMessage(e.what()));
     }
 
+    setCurrent(nullptr);
+    stopMonitor();
+
     // call tearDown and catch the error exception
+    phaseStart = TestResult::now();
     try {
         tearDown();
     } catch (TestErrorException& e) {
@@ -188,9 +236,10 @@ void TestSuite::run(TestResult& rsl)
         successful = false;
         result->addError(this, TestMessage(e.what()));
     }
+    addDuration("fixture tearDown", TestResult::now() - phaseStart);
 
+    setDuration(TestResult::now() - start);
     result->endTestSuite(this);
-    current = nullptr;
 }
 
 
@@ -206,15 +255,99 @@ void TestSuite::fixtureCollapsed(TestMessage reason)
     // we do not want to throw any exception here.
     // The reason is that if fixtureCollapsed is called
     // within other threads, the exception cannot be caught
-    // by the TestSuite.
+    // by the TestSuite. The running test is interrupted instead.
+    std::lock_guard<std::mutex> lock(fixtureMutex);
     fixtureOK = false;
     fixtureMessage = reason;
+    if (current != nullptr) {
+        current->interrupt();
+    }
 }
 
+
+void TestSuite::setMonitorPeriod(double period)
+{
+    monitorPeriod = period;
+}
+
+
+double TestSuite::getMonitorPeriod() const
+{
+    return monitorPeriod;
+}
+
+
+void TestSuite::setCurrent(Test* test)
+{
+    std::lock_guard<std::mutex> lock(fixtureMutex);
+    current = test;
+}
+
+
+void TestSuite::startMonitor()
+{
+    if (monitorPeriod <= 0 || fixtureManagers.empty()) {
+        return;
+    }
+    stopMonitor();
+    monitorStopped = false;
+    monitorThread = std::thread(&TestSuite::monitor, this);
+}
+
+
+void TestSuite::stopMonitor()
+{
+    {
+        std::lock_guard<std::mutex> lock(monitorMutex);
+        monitorStopped = true;
+    }
+    monitorCondition.notify_all();
+    if (monitorThread.joinable()) {
+        monitorThread.join();
+    }
+}
+
+
+void TestSuite::monitor()
+{
+    using seconds = std::chrono::duration<double>;
+    std::unique_lock<std::mutex> lock(monitorMutex);
+    while (!monitorCondition.wait_for(lock, seconds(monitorPeriod), [this]() { return monitorStopped; })) {
+        // the fixture is restarted by the suite once collapsed
+        if (!fixtureOK) {
+            continue;
+        }
+        lock.unlock();
+        bool checkOk;
+        TestMessage reason("Fixture collapsed",
+                           "check() failed",
+                           ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                           ROBOTTESTINGFRAMEWORK_SOURCELINE());
+        try {
+            checkOk = checkFixtures();
+        } catch (Exception& e) {
+            checkOk = false;
+            reason = e.message();
+        } catch (std::exception& e) {
+            checkOk = false;
+            reason = TestMessage("Fixture collapsed",
+                                 e.what(),
+                                 ROBOTTESTINGFRAMEWORK_SOURCEFILE(),
+                                 ROBOTTESTINGFRAMEWORK_SOURCELINE());
+        }
+        if (!checkOk) {
+            fixtureCollapsed(reason);
+        }
+        lock.lock();
+    }
+}
+
+
 void TestSuite::interrupt()
 {
+    interrupted = true;
+    std::lock_guard<std::mutex> lock(fixtureMutex);
     if (current != nullptr) {
         current->interrupt();
     }
-    interrupted = true;
 }
@@ -0,0 +1,161 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestListenerAdapter.h>
+#include <robottestingframework/TextStreamOutputter.h>
+
+#include <iomanip>
+#include <sstream>
+
+using namespace robottestingframework;
+using namespace std;
+
+#define MSG_ERROR "[ERROR] "
+#define MSG_FAIL "[FAIL]  "
+#define MSG_REPORT "[INFO]  "
+
+static void write_timing(ostream& outputter, const TestOutcome& outcome, bool verbose)
+{
+    outputter << " (" << fixed << setprecision(3) << outcome.getDuration() << " s)" << endl;
+    if (verbose) {
+        for (const auto& phase : outcome.getDurations()) {
+            outputter << "    " << phase.first << ": " << phase.second << " s" << endl;
+        }
+    }
+    // the statistics of a benchmark
+    for (const auto& statistic : outcome.getStatistics()) {
+        outputter << "    " << statistic.first << ": ";
+        if (statistic.first == "iterations") {
+            outputter << static_cast<unsigned long>(statistic.second) << endl;
+        } else {
+            outputter << setprecision(6) << statistic.second << " s" << setprecision(3) << endl;
+        }
+    }
+}
+
+static void write_message(ostream& outputter, const char* type, const Test* test, const TestMessage& msg, bool verbose)
+{
+    outputter << type << "(" << test->getName() << ") "
+              << msg.getMessage() << ": " << msg.getDetail() << endl;
+    if (verbose && msg.getSourceLineNumber() != 0) {
+        outputter << msg.getSourceFileName()
+                  << " at " << msg.getSourceLineNumber() << "." << endl
+                  << endl;
+    }
+}
+
+TextStreamOutputter::TextStreamOutputter(bool verbose, bool summary) :
+        StreamOutputter(verbose),
+        summary(summary)
+{
+}
+
+TextStreamOutputter::~TextStreamOutputter()
+{
+    close();
+}
+
+void TextStreamOutputter::handle(ResultEvent::Kind kind,
+                                 const Test* test,
+                                 const TestMessage& msg,
+                                 double elapsed)
+{
+    ostringstream outputter;
+    bool flush = false;
+    switch (kind) {
+    // start suite
+    case ResultEvent::Kind::StartSuite:
+        outputter << "Test suite " << test->getName() << " started..." << endl;
+        break;
+
+    // end suite
+    case ResultEvent::Kind::EndSuite: {
+        TestOutcome outcome = TestListenerAdapter::outcomeOf(test);
+        outputter << "Test suite " << test->getName();
+        if (outcome.succeeded()) {
+            outputter << " passed!";
+        } else {
+            outputter << " failed!";
+        }
+        write_timing(outputter, outcome, verbose);
+        flush = true;
+        break;
+    }
+
+    // start test case
+    case ResultEvent::Kind::StartTest:
+        outputter << "Test case " << test->getName() << " started..." << endl;
+        break;
+
+    // end test case
+    case ResultEvent::Kind::EndTest: {
+        TestOutcome outcome = TestListenerAdapter::outcomeOf(test);
+        outputter << "Test case " << test->getName();
+        if (outcome.succeeded()) {
+            outputter << " passed!";
+        } else {
+            outputter << " failed!";
+        }
+        write_timing(outputter, outcome, verbose);
+        flush = true;
+        break;
+    }
+
+    // report event
+    case ResultEvent::Kind::Report:
+        write_message(outputter, MSG_REPORT, test, msg, verbose);
+        break;
+
+    // failure event
+    case ResultEvent::Kind::Failure:
+        write_message(outputter, MSG_FAIL, test, msg, verbose);
+        break;
+
+    // error event
+    case ResultEvent::Kind::Error:
+    case ResultEvent::Kind::Timeout:
+        write_message(outputter, MSG_ERROR, test, msg, verbose);
+        break;
+    }
+    append(outputter.str(), flush);
+}
+
+void TextStreamOutputter::finish()
+{
+    if (!summary) {
+        return;
+    }
+
+    // write some simple statistics
+    ostringstream outputter;
+    outputter << endl
+              << "---------- summary -----------" << endl;
+    if (nTestSuites) {
+        outputter << "Total number of test suites  : " << nTestSuites << endl;
+        outputter << "Number of passed test suites : " << nSuitePasses << endl;
+        outputter << "Number of failed test suites : " << nSuiteFailures << endl;
+    }
+    outputter << "Total number of test cases   : " << nTests << endl;
+    outputter << "Number of passed test cases  : " << nPasses << endl;
+    outputter << "Number of failed test cases  : " << nFailures << endl;
+    outputter << "Total duration               : " << fixed << setprecision(3) << duration() << " s" << endl;
+    append(outputter.str());
+}
@@ -0,0 +1,260 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+#include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/impl/WebMetrics_impl.h>
+
+#include <cstdio>
+
+#if defined(__linux__)
+#    include <unistd.h>
+#endif
+
+using namespace std;
+using namespace robottestingframework;
+
+
+const double WebMetrics::Bounds[] = { 0.001, 0.005, 0.01, 0.025, 0.05,
+                                      0.1, 0.25, 0.5, 1, 2.5,
+                                      5, 10, 30, 60, 300 };
+
+namespace {
+
+struct CounterInfo
+{
+    const char* name;
+    const char* labels;
+    const char* help;
+};
+
+// in the order of WebMetrics::Counter; the counters with the same name
+// must follow each other
+const CounterInfo counterInfo[] = {
+    { "rtf_tests_started_total", "", "The number of the test cases which have been started." },
+    { "rtf_tests_passed_total", "", "The number of the test cases which have passed." },
+    { "rtf_tests_failed_total", "", "The number of the test cases which have failed without errors." },
+    { "rtf_tests_errored_total", "", "The number of the test cases which have failed with errors." },
+    { "rtf_suites_started_total", "", "The number of the test suites which have been started." },
+    { "rtf_suites_passed_total", "", "The number of the test suites which have passed." },
+    { "rtf_suites_failed_total", "", "The number of the test suites which have failed without errors." },
+    { "rtf_suites_errored_total", "", "The number of the test suites which have failed with errors." },
+    { "rtf_messages_total", "{kind=\"report\"}", "The number of the messages reported by the tests." },
+    { "rtf_messages_total", "{kind=\"failure\"}", "The number of the messages reported by the tests." },
+    { "rtf_messages_total", "{kind=\"error\"}", "The number of the messages reported by the tests." }
+};
+
+void header(std::string& out, const char* name, const char* type, const char* help)
+{
+    out += Asserter::format("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+std::string escapeLabel(const std::string& value)
+{
+    std::string escaped;
+    for (char c : value) {
+        switch (c) {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\"':
+            escaped += "\\\"";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            escaped += c;
+            break;
+        }
+    }
+    return escaped;
+}
+
+// the resident set size of the process or zero if it is not known
+std::size_t residentMemory()
+{
+#if defined(__linux__)
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int read = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    return (read == 2) ? resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+} // namespace
+
+
+WebMetrics::Histogram::Histogram() :
+        nanoseconds(0)
+{
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void WebMetrics::Histogram::observe(double seconds)
+{
+    std::size_t bucket = 0;
+    while (bucket < BucketCount - 1 && seconds > Bounds[bucket]) {
+        ++bucket;
+    }
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    if (seconds > 0) {
+        nanoseconds.fetch_add(static_cast<std::uint64_t>(seconds * 1e9), std::memory_order_relaxed);
+    }
+}
+
+void WebMetrics::Histogram::render(std::string& out,
+                                   const std::string& name,
+                                   const std::string& labels) const
+{
+    std::string separator = labels.empty() ? "" : ",";
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < BucketCount; ++i) {
+        count += buckets[i].load(std::memory_order_relaxed);
+        std::string bound = (i < BucketCount - 1) ? Asserter::format("%g", Bounds[i]) : "+Inf";
+        out += name + "_bucket{" + labels + separator + "le=\"" + bound + "\"} " + std::to_string(count) + "\n";
+    }
+    std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out += name + "_sum" + braces + Asserter::format(" %.9g\n", nanoseconds.load(std::memory_order_relaxed) / 1e9);
+    out += name + "_count" + braces + " " + std::to_string(count) + "\n";
+}
+
+
+WebMetrics::WebMetrics() :
+        result(nullptr)
+{
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& phase : phases) {
+        phase.name.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+WebMetrics::~WebMetrics()
+{
+    for (auto& phase : phases) {
+        delete phase.name.load(std::memory_order_relaxed);
+    }
+}
+
+void WebMetrics::count(Counter counter)
+{
+    counters[counter].fetch_add(1, std::memory_order_relaxed);
+}
+
+void WebMetrics::observeTest(double seconds)
+{
+    tests.observe(seconds);
+}
+
+void WebMetrics::observeSuite(double seconds)
+{
+    suites.observe(seconds);
+}
+
+void WebMetrics::observePhase(const std::string& phase, double seconds)
+{
+    // the repetitions of a test ("run #N") share the "run" label, so that
+    // the label set does not grow with the repetition count
+    const std::string label = (phase.compare(0, 5, "run #") == 0) ? std::string("run") : phase;
+
+    // the phases are claimed once, in the order in which they are seen
+    for (auto& slot : phases) {
+        const std::string* name = slot.name.load(std::memory_order_acquire);
+        if (name == nullptr) {
+            auto* claimed = new std::string(label);
+            if (slot.name.compare_exchange_strong(name, claimed, std::memory_order_acq_rel)) {
+                slot.histogram.observe(seconds);
+                return;
+            }
+            delete claimed;
+        }
+        if (*name == label) {
+            slot.histogram.observe(seconds);
+            return;
+        }
+    }
+    otherPhases.observe(seconds);
+}
+
+void WebMetrics::setTestResult(const TestResult* result)
+{
+    this->result.store(result);
+}
+
+std::string WebMetrics::render(std::size_t webEvents) const
+{
+    std::string out;
+    const char* last = "";
+    for (std::size_t i = 0; i < CounterCount; ++i) {
+        const CounterInfo& info = counterInfo[i];
+        if (std::string(info.name) != last) {
+            header(out, info.name, "counter", info.help);
+            last = info.name;
+        }
+        out += Asserter::format("%s%s %llu\n",
+                                info.name,
+                                info.labels,
+                                static_cast<unsigned long long>(counters[i].load(std::memory_order_relaxed)));
+    }
+
+    header(out, "rtf_test_duration_seconds", "histogram", "The duration of the test cases.");
+    tests.render(out, "rtf_test_duration_seconds", "");
+    header(out, "rtf_suite_duration_seconds", "histogram", "The duration of the test suites.");
+    suites.render(out, "rtf_suite_duration_seconds", "");
+    header(out, "rtf_phase_duration_seconds", "histogram", "The duration of the phases of the test runs.");
+    for (const auto& slot : phases) {
+        const std::string* name = slot.name.load(std::memory_order_acquire);
+        if (name == nullptr) {
+            break;
+        }
+        slot.histogram.render(out, "rtf_phase_duration_seconds", "phase=\"" + escapeLabel(*name) + "\"");
+    }
+    otherPhases.render(out, "rtf_phase_duration_seconds", "phase=\"other\"");
+
+    const TestResult* monitored = result.load();
+    if (monitored != nullptr) {
+        header(out, "rtf_event_queue_depth", "gauge", "The number of the events queued and not yet delivered to the listeners.");
+        out += Asserter::format("rtf_event_queue_depth %zu\n", monitored->pendingCount());
+        header(out, "rtf_events_dropped_total", "counter", "The number of the reports dropped because the event queue was full.");
+        out += Asserter::format("rtf_events_dropped_total %zu\n", monitored->droppedCount());
+    }
+    header(out, "rtf_web_events", "gauge", "The number of the events kept for the web clients.");
+    out += Asserter::format("rtf_web_events %zu\n", webEvents);
+
+    std::size_t resident = residentMemory();
+    if (resident != 0) {
+        header(out, "process_resident_memory_bytes", "gauge", "Resident memory size in bytes.");
+        out += Asserter::format("process_resident_memory_bytes %zu\n", resident);
+    }
+    return out;
+}
@@ -20,13 +20,16 @@
 
 
 #include <robottestingframework/Asserter.h>
+#include <robottestingframework/TestListenerAdapter.h>
 #include <robottestingframework/WebProgressListener.h>
 #include <robottestingframework/impl/WebProgressListener_impl.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <sstream>
+#include <ctime>
 
 using namespace std;
 using namespace robottestingframework;
@@ -42,6 +45,29 @@ using namespace robottestingframework;
 #define MSG_FAIL RED "[FAIL]&nbsp;&nbsp;" ENDC
 #define MSG_REPORT GREEN "[INFO]&nbsp;&nbsp;" ENDC
 
+// the maximum size of an /update response or of the events queued to an
+// /events stream; a client which is further behind catches up later
+#define UPDATE_MAX_BYTES (256 * 1024)
+// an idle /events stream receives a comment at this interval
+#define STREAM_KEEPALIVE_SECONDS 15
+
+namespace {
+
+// the state of an /events stream
+struct WebStream
+{
+    std::size_t next;
+    time_t lastWrite;
+};
+
+// the time from which the durations of the runs are measured, in seconds
+double steadyTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 static std::string html_page = "<!DOCTYPE html>\n"
                                "<html>\n"
                                "<head>\n"
@@ -66,7 +92,83 @@ static std::string html_page = "<!DOCTYPE html>\n"
                                "</style>\n"
                                "\n"
                                "<script>\n"
-                               "function update() {\n"
+                               "var since = 0;\n"
+                               "var tags = {report: '" MSG_REPORT "', error: '" MSG_ERROR "', failure: '" MSG_FAIL "'};\n"
+                               "var blue = '" BLUE "';\n"
+                               "var endc = '" ENDC "';\n"
+                               "var statusBusy = false;\n"
+                               "var statusDirty = false;\n"
+                               "var statusTimer = null;\n"
+                               "\n"
+                               "function appendLog(html) {\n"
+                               "    var result = document.getElementById(\"result\");\n"
+                               "    result.insertAdjacentHTML(\"beforeend\", html);\n"
+                               "    if (document.getElementById(\"autoscroll\").checked == true) {\n"
+                               "        result.scrollTop = result.scrollHeight;\n"
+                               "    }\n"
+                               "}\n"
+                               "\n"
+                               "function escapeHtml(text) {\n"
+                               "    var div = document.createElement(\"div\");\n"
+                               "    div.textContent = text;\n"
+                               "    return div.innerHTML;\n"
+                               "}\n"
+                               "\n"
+                               "function formatTime(seconds) {\n"
+                               "    if (seconds == null) {\n"
+                               "        return \"unknown\";\n"
+                               "    }\n"
+                               "    seconds = Math.ceil(seconds);\n"
+                               "    return (seconds >= 60) ? Math.floor(seconds / 60) + \" min \" + (seconds % 60) + \" s\" : seconds + \" s\";\n"
+                               "}\n"
+                               "\n"
+                               "function formatRuns(runs, eta) {\n"
+                               "    var html = \"Time left: \" + formatTime(eta);\n"
+                               "    for (var i = 0; i < runs.length; i++) {\n"
+                               "        var run = runs[i];\n"
+                               "        var state = run.finished ? \"finished\" : (run.current ? \"running \" + escapeHtml(run.current) : \"waiting\");\n"
+                               "        html += \"<br>\" + escapeHtml(run.name || \"run\") + \": \" + run.done + \"/\" + run.planned + \" done, \" + run.passed + \" passed, \" + run.failed + \" failed, \" + state;\n"
+                               "        if (!run.finished) {\n"
+                               "            html += \", \" + formatTime(run.eta) + \" left\";\n"
+                               "        }\n"
+                               "    }\n"
+                               "    return html;\n"
+                               "}\n"
+                               "\n"
+                               "function formatEvent(ev) {\n"
+                               "    var test = escapeHtml(ev.test || \"\");\n"
+                               "    var html = formatMessage(ev, test);\n"
+                               "    return (ev.run && html) ? html.replace(\"<br> \", \"<br> [\" + escapeHtml(ev.run) + \"] \") : html;\n"
+                               "}\n"
+                               "\n"
+                               "function formatMessage(ev, test) {\n"
+                               "    switch (ev.kind) {\n"
+                               "    case \"report\":\n"
+                               "    case \"error\":\n"
+                               "    case \"failure\":\n"
+                               "        return \"<br> \" + tags[ev.kind] + \" (\" + test + \") \" + escapeHtml(ev.message) + \" : \" + escapeHtml(ev.detail || \"\") + \".\";\n"
+                               "    case \"testStarted\":\n"
+                               "        return \"<br> \" + blue + \" Test case \" + test + \" started... \" + endc;\n"
+                               "    case \"testPassed\":\n"
+                               "        return \"<br> \" + blue + \" Test case \" + test + \" passed! \" + endc;\n"
+                               "    case \"testFailed\":\n"
+                               "        return \"<br> \" + blue + \" Test case \" + test + \" failed! \" + endc;\n"
+                               "    case \"suiteStarted\":\n"
+                               "        return \"<br> \" + blue + \" Test suite \" + test + \" started... \" + endc;\n"
+                               "    case \"suitePassed\":\n"
+                               "        return \"<br> \" + blue + \" Test suite \" + test + \" passed! \" + endc;\n"
+                               "    case \"suiteFailed\":\n"
+                               "        return \"<br> \" + blue + \" Test suite \" + test + \" failed! \" + endc;\n"
+                               "    case \"runnerStarted\":\n"
+                               "        return \"<br> \" + blue + \" Starting test runner. \" + endc;\n"
+                               "    case \"runnerEnded\":\n"
+                               "        return \"<br> \" + blue + \" Ending test runner. \" + endc;\n"
+                               "    default:\n"
+                               "        return \"\";\n"
+                               "    }\n"
+                               "}\n"
+                               "\n"
+                               "function updateLog() {\n"
                                "    var xmlUpdate;\n"
                                "    if (window.XMLHttpRequest) {\n"
                                "      xmlUpdate=new XMLHttpRequest();\n"
@@ -76,15 +178,28 @@ static std::string html_page = "<!DOCTYPE html>\n"
                                "    }\n"
                                "    xmlUpdate.onreadystatechange=function() {\n"
                                "        if (xmlUpdate.readyState==4 && xmlUpdate.status==200) {\n"
-                               "            document.getElementById(\"result\").innerHTML=xmlUpdate.responseText;\n"
-                               "             if(document.getElementById(\"autoscroll\").checked == true) {\n"
-                               "               document.getElementById(\"result\").scrollTop = document.getElementById(\"result\").scrollHeight;\n"
-                               "             }\n"
+                               "            var next = parseInt(xmlUpdate.getResponseHeader(\"X-Next-Sequence\"));\n"
+                               "            var count = parseInt(xmlUpdate.getResponseHeader(\"X-Sequence-Count\"));\n"
+                               "            if (next < since) {\n"
+                               "                document.getElementById(\"result\").innerHTML=\"\";\n"
+                               "            }\n"
+                               "            since = next;\n"
+                               "            appendLog(xmlUpdate.responseText);\n"
+                               "            if (since < count) {\n"
+                               "                updateLog();\n"
+                               "            }\n"
                                "        }\n"
                                "    }\n"
-                               "    xmlUpdate.open(\"GET\",document.URL+\"update\",true);\n"
+                               "    xmlUpdate.open(\"GET\",document.URL+\"update?since=\"+since,true);\n"
                                "    xmlUpdate.send();\n"
+                               "}\n"
                                "\n"
+                               "function updateStatus() {\n"
+                               "    if (statusBusy) {\n"
+                               "        statusDirty = true;\n"
+                               "        return;\n"
+                               "    }\n"
+                               "    statusBusy = true;\n"
                                "    var xmlStatus;\n"
                                "    if (window.XMLHttpRequest) {\n"
                                "        xmlStatus=new XMLHttpRequest();\n"
@@ -95,7 +210,14 @@ static std::string html_page = "<!DOCTYPE html>\n"
                                "    xmlStatus.onreadystatechange=function() {\n"
                                "        if (xmlStatus.readyState==4 && xmlStatus.status==200) {\n"
                                "            var status = JSON.parse(xmlStatus.responseText);\n"
-                               "            document.getElementById(\"suite_name\").innerHTML=status.name;\n"
+                               "            if (status.name) {\n"
+                               "                document.getElementById(\"suite_name\").innerHTML=status.name;\n"
+                               "            }\n"
+                               "            document.getElementById(\"runs\").innerHTML = status.runs ? formatRuns(status.runs, status.eta) : \"\";\n"
+                               "            // the time left is refreshed while the runs are not finished\n"
+                               "            if (status.runs && statusTimer == null) {\n"
+                               "                statusTimer = setInterval(updateStatus, 1000);\n"
+                               "            }\n"
                                "            var c = document.getElementById(\"progress\");\n"
                                "            var ctx = c.getContext(\"2d\");\n"
                                "            ctx.clearRect(0, 0, c.width, c.height);\n"
@@ -129,13 +251,48 @@ static std::string html_page = "<!DOCTYPE html>\n"
                                "                xpos = xpos + 20;\n"
                                "            }\n"
                                "        }\n"
+                               "        if (xmlStatus.readyState==4) {\n"
+                               "            statusBusy = false;\n"
+                               "            if (statusDirty) {\n"
+                               "                statusDirty = false;\n"
+                               "                updateStatus();\n"
+                               "            }\n"
+                               "        }\n"
                                "    }\n"
                                "    xmlStatus.open(\"GET\",document.URL+\"status\",true);\n"
                                "    xmlStatus.send();\n"
+                               "}\n"
                                "\n"
+                               "function update() {\n"
+                               "    updateLog();\n"
+                               "    updateStatus();\n"
                                "    setTimeout(update, 1000);\n"
                                "}\n"
-                               "setTimeout(update, 1000);\n"
+                               "\n"
+                               "function stream() {\n"
+                               "    var source = new EventSource(document.URL+\"events\");\n"
+                               "    source.onmessage=function(e) {\n"
+                               "        var ev = JSON.parse(e.data);\n"
+                               "        if (e.lastEventId == \"0\") {\n"
+                               "            document.getElementById(\"result\").innerHTML=\"\";\n"
+                               "        }\n"
+                               "        appendLog(formatEvent(ev));\n"
+                               "        if (ev.kind.indexOf(\"test\") == 0 || ev.kind.indexOf(\"suite\") == 0) {\n"
+                               "            updateStatus();\n"
+                               "        }\n"
+                               "    }\n"
+                               "}\n"
+                               "\n"
+                               "window.onload=function() {\n"
+                               "    // the events are pushed by the server when possible, polled otherwise\n"
+                               "    if (window.EventSource) {\n"
+                               "        stream();\n"
+                               "        updateStatus();\n"
+                               "    }\n"
+                               "    else {\n"
+                               "        update();\n"
+                               "    }\n"
+                               "}\n"
                                "</script>\n"
                                "</head>\n"
                                "<body bgcolor=\"#efefef\">\n"
@@ -145,12 +302,94 @@ static std::string html_page = "<!DOCTYPE html>\n"
                                "</div>\n"
                                "<div class=\"my_window\" style=\"top:75px; height:90%; padding:5px\"><div id=\"result\" style=\"top:0px; height:96%; overflow-y:scroll; background:#ffffff;\"></div>\n"
                                "<table style=\"width:100%\"><tr><td width=\"90%\"><canvas id=\"progress\" width=\"1000px\" height=\"20px\" style=\"width:1000px; height:20px\" ></canvas></td><td align=\"right\"><input align=\"right\" type=\"checkbox\" id=\"autoscroll\" checked/> auto scroll</div></td></tr></table>\n"
+                               "<div id=\"runs\" class=\"font_1\"></div>\n"
                                //"<div style=\"top:94%; position:absolute; padding-left:20px;\">\n"
                                //"<p class=\"font_1\">Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)</p>\n"
                                //"</div>\n"
                                "</body>\n"
                                "</html>\n";
 
+/**
+ * WebEventLog
+ */
+WebEventLog::WebEventLog() :
+        count(0)
+{
+    for (auto& chunk : chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+WebEventLog::~WebEventLog()
+{
+    for (auto& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+std::size_t WebEventLog::chunkOf(std::size_t seq)
+{
+    // chunk k starts at FirstChunkSize * (2^k - 1)
+    std::size_t blocks = seq / FirstChunkSize + 1;
+    std::size_t chunk = 0;
+    while (blocks >>= 1) {
+        ++chunk;
+    }
+    return chunk;
+}
+
+std::size_t WebEventLog::chunkStart(std::size_t chunk)
+{
+    return FirstChunkSize * ((static_cast<std::size_t>(1) << chunk) - 1);
+}
+
+std::size_t WebEventLog::append(WebEvent event)
+{
+    std::lock_guard<std::mutex> lock(appending);
+    std::size_t seq = count.load(std::memory_order_relaxed);
+    std::size_t chunk = chunkOf(seq);
+    if (chunk >= MaxChunks) {
+        return seq;
+    }
+    WebEvent* events = chunks[chunk].load(std::memory_order_relaxed);
+    if (events == nullptr) {
+        events = new WebEvent[FirstChunkSize << chunk];
+        chunks[chunk].store(events, std::memory_order_release);
+    }
+    events[seq - chunkStart(chunk)] = std::move(event);
+    // publish the event to the readers
+    count.store(seq + 1, std::memory_order_release);
+    return seq;
+}
+
+std::size_t WebEventLog::size() const
+{
+    return count.load(std::memory_order_acquire);
+}
+
+const WebEvent& WebEventLog::at(std::size_t seq) const
+{
+    std::size_t chunk = chunkOf(seq);
+    return chunks[chunk].load(std::memory_order_acquire)[seq - chunkStart(chunk)];
+}
+
+std::size_t WebEventLog::read(std::size_t since,
+                              std::size_t maxBytes,
+                              std::string& out) const
+{
+    std::size_t end = count.load(std::memory_order_acquire);
+    // a client of an earlier log restarts from the beginning
+    std::size_t seq = (since > end) ? 0 : since;
+    std::size_t bytes = 0;
+    for (; seq < end && bytes < maxBytes; ++seq) {
+        const std::string& html = at(seq).html;
+        out += html;
+        bytes += html.size();
+    }
+    return seq;
+}
+
+
 WebProgressListenerImpl& WebProgressListenerImpl::create(unsigned int port,
                                                          bool verbose)
 {
@@ -159,9 +398,16 @@ WebProgressListenerImpl& WebProgressListenerImpl::create(unsigned int port,
 }
 
 WebProgressListenerImpl::WebProgressListenerImpl(unsigned int port,
-                                                 bool verbose)
+                                                 bool verbose) :
+        shouldStop(false),
+        wakeupPending(false),
+        doneDuration(0),
+        doneCount(0),
+        updater(nullptr)
 {
     suite_size = 0;
+    addRun("");
+    publishStatus();
     this->verbose = verbose;
     this->port = port;
     server = mg_create_server(this, WebProgressListenerImpl::handler);
@@ -170,7 +416,6 @@ WebProgressListenerImpl::WebProgressListenerImpl(unsigned int port,
         mg_set_option(server,
                       "listening_port",
                       port_str.c_str());
-        shouldStop = false;
         updater = new std::thread(update, this);
     }
 }
@@ -193,58 +438,341 @@ WebProgressListenerImpl::~WebProgressListenerImpl()
     }
 }
 
+WebProgressListenerImpl::Run* WebProgressListenerImpl::addRun(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(critical);
+    if (!runs.empty() && name.empty()) {
+        return runs.front().get();
+    }
+    // a run which is started again (e.g. a shard which reconnects) keeps
+    // its progress
+    for (auto& run : runs) {
+        if (run->name == name) {
+            return run.get();
+        }
+    }
+    runs.emplace_back(new Run);
+    Run* run = runs.back().get();
+    run->name = name;
+    run->planned = false;
+    run->finished = false;
+    run->passed = 0;
+    run->failed = 0;
+    run->depth = 0;
+    if (!name.empty()) {
+        publishStatus();
+    }
+    return run;
+}
+
+void WebProgressListenerImpl::setPlan(Run* run,
+                                      const std::vector<std::pair<std::string, double>>& plan)
+{
+    std::lock_guard<std::mutex> lock(critical);
+    run->plan.clear();
+    for (const auto& item : plan) {
+        run->plan.push_back({item.first, item.second, -1, false});
+    }
+    run->planned = true;
+    publishStatus();
+}
+
+bool WebProgressListenerImpl::shown(const Run* run) const
+{
+    return run != runs.front().get() || run->planned;
+}
+
+void WebProgressListenerImpl::startItem(Run* run, const Test* test)
+{
+    // called with critical held; only the top level tests and suites
+    // are planned
+    if (run->depth++ != 0) {
+        return;
+    }
+    run->current = test->getName();
+    for (auto& item : run->plan) {
+        if (!item.done && item.started < 0 && item.name == run->current) {
+            item.started = steadyTime();
+            break;
+        }
+    }
+}
+
+void WebProgressListenerImpl::endItem(Run* run, const Test* test, const TestOutcome& outcome)
+{
+    // called with critical held
+    if (run->depth == 0 || --run->depth != 0) {
+        return;
+    }
+    run->current.clear();
+    for (auto& item : run->plan) {
+        if (!item.done && item.started >= 0 && item.name == test->getName()) {
+            item.done = true;
+            doneDuration += (outcome.getDuration() > 0) ? outcome.getDuration() : steadyTime() - item.started;
+            doneCount++;
+            break;
+        }
+    }
+}
+
 void WebProgressListenerImpl::update(void* param)
 {
     auto* web = (WebProgressListenerImpl*)param;
     while (!web->shouldStop) {
+        // the events published from now on wake up the server again; the
+        // streams are served by the MG_POLL at the beginning of the poll
+        web->wakeupPending = false;
         mg_poll_server(web->server, 1000);
     }
 }
 
+void WebProgressListenerImpl::publish(WebEvent event)
+{
+    events.append(std::move(event));
+    // wake up the server once until it has streamed the new events
+    if (server != nullptr && !shouldStop && !wakeupPending.exchange(true)) {
+        mg_wakeup_server(server);
+    }
+}
+
 int WebProgressListenerImpl::handler(struct mg_connection* conn,
                                      enum mg_event ev)
 {
     auto* web = (WebProgressListenerImpl*)conn->server_param;
     if (ev == MG_REQUEST) {
+        if (strcmp(conn->uri, "/events") == 0) {
+            openStream(conn, web);
+            return MG_MORE;
+        }
         if (strcmp(conn->uri, "/update") == 0) {
-            web->critical.lock();
-            std::string data = web->result;
-            web->critical.unlock();
-            mg_send_header(conn, "Content-Type", "text/turtle");
-            mg_send_header(conn, "Access-Control-Allow-Origin", "*");
-            //mg_send_header(conn, "Content-Location", "mydata.ttl");
-            mg_printf_data(conn, "%s", data.c_str());
+            sendUpdate(conn, web);
         } else if (strcmp(conn->uri, "/status") == 0) {
-            web->critical.lock();
-            std::stringstream ss;
-            ss << R"({"name":")" << web->suite_name;
-            ss << R"(","testStatus":[)";
-            for (auto it = web->testStatus.begin(); it != web->testStatus.end(); ++it) {
-                ss << (int)(*it);
-                if (std::next(it) != web->testStatus.end()) {
-                    ss << ",";
-                }
-            }
-            for (int i = web->testStatus.size(); i < web->suite_size; ++i) {
-                ss << ",0";
-            }
-            ss << "]}";
-
-            web->critical.unlock();
-            mg_send_header(conn, "Content-Type", "text/turtle");
-            mg_send_header(conn, "Access-Control-Allow-Origin", "*");
-            mg_printf_data(conn, "%s", ss.str().c_str());
+            sendStatus(conn, web);
+        } else if (strcmp(conn->uri, "/metrics") == 0) {
+            std::string metrics = web->metrics.render(web->events.size());
+            mg_send_header(conn, "Content-Type", "text/plain; version=0.0.4");
+            mg_send_header(conn, "Cache-Control", "no-cache");
+            mg_send_data(conn, metrics.data(), static_cast<int>(metrics.size()));
         } else {
             mg_send_data(conn, html_page.c_str(), strlen(html_page.c_str()));
         }
         return MG_TRUE;
     }
+    if (ev == MG_POLL) {
+        if (conn->connection_param != nullptr) {
+            pushEvents(conn, web);
+        }
+        return MG_FALSE;
+    }
+    if (ev == MG_CLOSE) {
+        delete (WebStream*)conn->connection_param;
+        conn->connection_param = nullptr;
+        return MG_TRUE;
+    }
     if (ev == MG_AUTH) {
         return MG_TRUE;
     }
     return MG_FALSE;
 }
 
+void WebProgressListenerImpl::publishStatus()
+{
+    // called with critical held (or before the server is started)
+    std::shared_ptr<const Status> current = std::atomic_load(&status);
+    auto snapshot = std::make_shared<Status>();
+    snapshot->version = (current != nullptr) ? current->version + 1 : 0;
+    snapshot->suite_name = suite_name;
+    snapshot->suite_size = suite_size;
+    snapshot->testStatus = testStatus;
+    for (const auto& run : runs) {
+        if (!shown(run.get())) {
+            continue;
+        }
+        RunStatus info;
+        info.name = run->name;
+        info.planned = run->planned;
+        info.finished = run->finished;
+        info.passed = run->passed;
+        info.failed = run->failed;
+        info.planSize = run->plan.size();
+        info.done = 0;
+        info.current = run->current;
+        info.left = 0;
+        info.unknown = 0;
+        for (const auto& item : run->plan) {
+            if (item.done) {
+                info.done++;
+            } else if (item.started >= 0) {
+                info.running.emplace_back(item.expected, item.started);
+            } else if (item.expected < 0) {
+                info.unknown++;
+            } else {
+                info.left += item.expected;
+            }
+        }
+        snapshot->runs.push_back(std::move(info));
+    }
+    snapshot->average = (doneCount > 0) ? doneDuration / doneCount : -1;
+    std::atomic_store(&status, std::shared_ptr<const Status>(std::move(snapshot)));
+}
+
+double WebProgressListenerImpl::eta(const RunStatus& run, double average, double now)
+{
+    // the time left of a run, negative if unknown
+    if (run.finished) {
+        return 0;
+    }
+    if (!run.planned || (run.unknown > 0 && average < 0)) {
+        return -1;
+    }
+    double left = run.left + run.unknown * average;
+    for (const auto& item : run.running) {
+        double expected = (item.first < 0) ? average : item.first;
+        if (expected < 0) {
+            return -1;
+        }
+        left += std::max(0.0, expected - (now - item.second));
+    }
+    return left;
+}
+
+std::string WebProgressListenerImpl::statusToJson(const Status& snapshot, double now)
+{
+    std::string json = R"({"name":")" + encodeJson(snapshot.suite_name) + R"(","testStatus":[)";
+    for (auto it = snapshot.testStatus.begin(); it != snapshot.testStatus.end(); ++it) {
+        if (it != snapshot.testStatus.begin()) {
+            json += ",";
+        }
+        json += std::to_string(static_cast<int>(*it));
+    }
+    for (std::size_t i = snapshot.testStatus.size(); i < snapshot.suite_size; ++i) {
+        json += (i == 0) ? "0" : ",0";
+    }
+    json += "]";
+    if (snapshot.runs.empty()) {
+        return json + "}";
+    }
+
+    // the runs are parallel: the last one to finish sets the time left
+    json += ",\"runs\":[";
+    double total = 0;
+    for (auto it = snapshot.runs.begin(); it != snapshot.runs.end(); ++it) {
+        double left = eta(*it, snapshot.average, now);
+        total = (total < 0 || left < 0) ? -1 : std::max(total, left);
+        json += (it != snapshot.runs.begin()) ? "," : "";
+        json += Asserter::format(R"({"name":"%s","finished":%s,"passed":%zu,"failed":%zu,"planned":%zu,"done":%zu,"current":"%s","eta":%s})",
+                                 encodeJson(it->name).c_str(),
+                                 it->finished ? "true" : "false",
+                                 it->passed,
+                                 it->failed,
+                                 it->planSize,
+                                 it->done,
+                                 encodeJson(it->current).c_str(),
+                                 (left < 0) ? "null" : Asserter::format("%.1f", left).c_str());
+    }
+    json += "],\"eta\":";
+    json += (total < 0) ? "null" : Asserter::format("%.1f", total);
+    json += "}";
+    return json;
+}
+
+void WebProgressListenerImpl::sendStatus(struct mg_connection* conn,
+                                         WebProgressListenerImpl* web)
+{
+    // the JSON is built once per version of the snapshot, however many
+    // clients ask for it, unless it holds a time left
+    std::shared_ptr<const Status> snapshot = std::atomic_load(&web->status);
+    if (snapshot != web->sentStatus || !snapshot->runs.empty()) {
+        web->sentStatusJson = statusToJson(*snapshot, steadyTime());
+        web->sentStatus = std::move(snapshot);
+    }
+    std::string version_str = std::to_string(web->sentStatus->version);
+    mg_send_header(conn, "Content-Type", "text/turtle");
+    mg_send_header(conn, "Access-Control-Allow-Origin", "*");
+    mg_send_header(conn, "Access-Control-Expose-Headers", "X-Status-Version");
+    mg_send_header(conn, "Cache-Control", "no-cache");
+    mg_send_header(conn, "X-Status-Version", version_str.c_str());
+    mg_send_data(conn, web->sentStatusJson.data(), static_cast<int>(web->sentStatusJson.size()));
+}
+
+void WebProgressListenerImpl::openStream(struct mg_connection* conn,
+                                         WebProgressListenerImpl* web)
+{
+    // a reconnecting client resumes after the last event it has received
+    auto* stream = new WebStream;
+    stream->next = 0;
+    const char* last_id = mg_get_header(conn, "Last-Event-ID");
+    char value[32];
+    if (last_id != nullptr && *last_id != '\0') {
+        stream->next = strtoull(last_id, nullptr, 10) + 1;
+    } else if (mg_get_var(conn, "since", value, sizeof(value)) > 0) {
+        stream->next = strtoull(value, nullptr, 10);
+    }
+    if (stream->next > web->events.size()) {
+        stream->next = 0;
+    }
+    stream->lastWrite = time(nullptr);
+    conn->connection_param = stream;
+    mg_send_header(conn, "Content-Type", "text/event-stream");
+    mg_send_header(conn, "Cache-Control", "no-cache");
+    mg_send_header(conn, "Access-Control-Allow-Origin", "*");
+    mg_printf_data(conn, "retry: 1000\n\n");
+    pushEvents(conn, web);
+}
+
+void WebProgressListenerImpl::pushEvents(struct mg_connection* conn,
+                                         WebProgressListenerImpl* web)
+{
+    auto* stream = (WebStream*)conn->connection_param;
+    // leave a slow client until it has received the buffered events
+    if (mg_write(conn, "", 0) >= UPDATE_MAX_BYTES) {
+        return;
+    }
+    std::size_t end = web->events.size();
+    time_t now = time(nullptr);
+    if (stream->next >= end) {
+        // keep the idle stream open
+        if (now - stream->lastWrite >= STREAM_KEEPALIVE_SECONDS) {
+            mg_printf_data(conn, ":\n\n");
+            stream->lastWrite = now;
+        }
+        return;
+    }
+    std::string data;
+    for (; stream->next < end && data.size() < UPDATE_MAX_BYTES; ++stream->next) {
+        data += Asserter::format("id: %zu\ndata: ", stream->next);
+        data += web->events.at(stream->next).json;
+        data += "\n\n";
+    }
+    // the rest of a long backlog is sent by the next polls, as soon as the
+    // connection is writable again
+    mg_send_data(conn, data.data(), static_cast<int>(data.size()));
+    stream->lastWrite = now;
+}
+
+void WebProgressListenerImpl::sendUpdate(struct mg_connection* conn,
+                                         WebProgressListenerImpl* web)
+{
+    // /update?since=<seq> returns the events from <seq> on; the sequence
+    // number to ask next and the number of events are returned as headers
+    std::size_t since = 0;
+    char value[32];
+    if (mg_get_var(conn, "since", value, sizeof(value)) > 0) {
+        since = strtoull(value, nullptr, 10);
+    }
+    std::string data;
+    std::size_t next = web->events.read(since, UPDATE_MAX_BYTES, data);
+    std::string next_str = Asserter::format("%zu", next);
+    std::string count_str = Asserter::format("%zu", web->events.size());
+    mg_send_header(conn, "Content-Type", "text/turtle");
+    mg_send_header(conn, "Access-Control-Allow-Origin", "*");
+    mg_send_header(conn, "Access-Control-Expose-Headers", "X-Next-Sequence, X-Sequence-Count");
+    mg_send_header(conn, "Cache-Control", "no-cache");
+    mg_send_header(conn, "X-Next-Sequence", next_str.c_str());
+    mg_send_header(conn, "X-Sequence-Count", count_str.c_str());
+    mg_send_data(conn, data.data(), static_cast<int>(data.size()));
+}
+
 std::string WebProgressListenerImpl::encode(const std::string& data)
 {
     std::string buffer;
@@ -274,122 +802,255 @@ std::string WebProgressListenerImpl::encode(const std::string& data)
     return buffer;
 }
 
-void WebProgressListenerImpl::addReport(const Test* test,
+std::string WebProgressListenerImpl::encodeJson(const std::string& data)
+{
+    std::string buffer;
+    buffer.reserve(data.size());
+    for (char c : data) {
+        switch (c) {
+        case '\"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                buffer.append(Asserter::format("\\u%04x", c));
+            } else {
+                buffer.push_back(c);
+            }
+            break;
+        }
+    }
+    return buffer;
+}
+
+std::string WebProgressListenerImpl::tag(const Run* run)
+{
+    return run->name.empty() ? std::string() : "[" + encode(run->name) + "] ";
+}
+
+std::string WebProgressListenerImpl::toJson(const char* kind,
+                                            const Run* run,
+                                            const Test* test,
+                                            const TestMessage* msg)
+{
+    std::string json = "{\"kind\":\"";
+    json += kind;
+    json += "\"";
+    if (!run->name.empty()) {
+        json += ",\"run\":\"" + encodeJson(run->name) + "\"";
+    }
+    if (test != nullptr) {
+        json += ",\"test\":\"" + encodeJson(test->getName()) + "\"";
+    }
+    if (msg != nullptr) {
+        json += ",\"message\":\"" + encodeJson(msg->getMessage()) + "\"";
+        if (!msg->getDetail().empty()) {
+            json += ",\"detail\":\"" + encodeJson(msg->getDetail()) + "\"";
+        }
+    }
+    json += "}";
+    return json;
+}
+
+void WebProgressListenerImpl::observeEnd(const Test* test, const TestOutcome& outcome, bool suite)
+{
+    // called with critical held
+    bool errored = (erroredTests.erase(test) != 0);
+    if (suite) {
+        metrics.observeSuite(outcome.getDuration());
+        metrics.count(outcome.succeeded() ? WebMetrics::SuitesPassed : errored ? WebMetrics::SuitesErrored : WebMetrics::SuitesFailed);
+    } else {
+        metrics.observeTest(outcome.getDuration());
+        metrics.count(outcome.succeeded() ? WebMetrics::TestsPassed : errored ? WebMetrics::TestsErrored : WebMetrics::TestsFailed);
+    }
+    for (const auto& phase : outcome.getDurations()) {
+        metrics.observePhase(phase.first, phase.second);
+    }
+}
+
+void WebProgressListenerImpl::addReport(Run* run,
+                                        const Test* test,
                                         TestMessage msg)
 {
-    string text = Asserter::format("<br> %s (%s) %s : %s.",
+    metrics.count(WebMetrics::Reports);
+    string text = Asserter::format("<br> %s%s (%s) %s : %s.",
+                                   tag(run).c_str(),
                                    MSG_REPORT,
                                    encode(test->getName()).c_str(),
                                    encode(msg.getMessage()).c_str(),
                                    encode(msg.getDetail()).c_str());
-    critical.lock();
-    result += text;
-    critical.unlock();
+    publish({std::move(text), toJson("report", run, test, &msg)});
     //if(verbose && msg.getSourceLineNumber() != 0)
     //    cout<<GRAY<<msg.getSourceFileName()<<" at "<<msg.getSourceLineNumber()<<"."<<ENDC<<endl<<endl;
 }
 
-void WebProgressListenerImpl::addError(const Test* test,
+void WebProgressListenerImpl::addError(Run* run,
+                                       const Test* test,
                                        TestMessage msg)
 {
-    string text = Asserter::format("<br> %s (%s) %s : %s.",
+    metrics.count(WebMetrics::Errors);
+    critical.lock();
+    erroredTests.insert(test);
+    critical.unlock();
+    string text = Asserter::format("<br> %s%s (%s) %s : %s.",
+                                   tag(run).c_str(),
                                    MSG_ERROR,
                                    encode(test->getName()).c_str(),
                                    encode(msg.getMessage()).c_str(),
                                    encode(msg.getDetail()).c_str());
-    critical.lock();
-    result += text;
-    critical.unlock();
+    publish({std::move(text), toJson("error", run, test, &msg)});
 }
 
-void WebProgressListenerImpl::addFailure(const Test* test,
+void WebProgressListenerImpl::addFailure(Run* run,
+                                         const Test* test,
                                          TestMessage msg)
 {
-    string text = Asserter::format("<br> %s (%s) %s : %s.",
+    metrics.count(WebMetrics::Failures);
+    string text = Asserter::format("<br> %s%s (%s) %s : %s.",
+                                   tag(run).c_str(),
                                    MSG_FAIL,
                                    encode(test->getName()).c_str(),
                                    encode(msg.getMessage()).c_str(),
                                    encode(msg.getDetail()).c_str());
-    critical.lock();
-    result += text;
-    critical.unlock();
+    publish({std::move(text), toJson("failure", run, test, &msg)});
 }
 
-void WebProgressListenerImpl::startTest(const Test* test)
+void WebProgressListenerImpl::startTest(Run* run,
+                                        const Test* test)
 {
-    string text = Asserter::format("<br> %s Test case %s started... %s",
+    metrics.count(WebMetrics::TestsStarted);
+    string text = Asserter::format("<br> %s%s Test case %s started... %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    encode(test->getName()).c_str(),
                                    ENDC);
     critical.lock();
     // if there is no test suite, use the test case's name
-    if (suite_name.empty()) {
+    if (suite_name.empty() && run->name.empty()) {
         suite_name = test->getName();
     }
     testStatus.push_back(TestStatus::Running);
-    result += text;
+    run->running.push_back(testStatus.size() - 1);
+    startItem(run, test);
+    publishStatus();
     critical.unlock();
+    publish({std::move(text), toJson("testStarted", run, test)});
 }
 
-void WebProgressListenerImpl::endTest(const Test* test)
+void WebProgressListenerImpl::endTest(Run* run,
+                                      const Test* test)
 {
-    string text = Asserter::format("<br> %s Test case %s %s %s",
+    TestOutcome outcome = TestListenerAdapter::outcomeOf(test);
+    string text = Asserter::format("<br> %s%s Test case %s %s %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    encode(test->getName()).c_str(),
-                                   (test->succeeded()) ? "passed!" : "failed!",
+                                   (outcome.succeeded()) ? "passed!" : "failed!",
                                    ENDC);
     critical.lock();
-    testStatus.back() = (test->succeeded()) ? TestStatus::Success : TestStatus::Failed;
-    result += text;
+    if (!run->running.empty()) {
+        testStatus[run->running.back()] = (outcome.succeeded()) ? TestStatus::Success : TestStatus::Failed;
+        run->running.pop_back();
+    }
+    if (outcome.succeeded()) {
+        run->passed++;
+    } else {
+        run->failed++;
+    }
+    endItem(run, test, outcome);
+    publishStatus();
+    observeEnd(test, outcome, false);
     critical.unlock();
+    publish({std::move(text), toJson((outcome.succeeded()) ? "testPassed" : "testFailed", run, test)});
 }
 
-void WebProgressListenerImpl::startTestSuite(const Test* test)
+void WebProgressListenerImpl::startTestSuite(Run* run,
+                                             const Test* test)
 {
-    string text = Asserter::format("<br> %s Test suite %s started... %s",
+    metrics.count(WebMetrics::SuitesStarted);
+    string text = Asserter::format("<br> %s%s Test suite %s started... %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    encode(test->getName()).c_str(),
                                    ENDC);
     critical.lock();
-    result += text;
-    suite_name = test->getName();
-    auto suite = dynamic_cast<const TestSuite*>(test);
-    if (suite != nullptr) {
-        suite_size = suite->size();
+    // the suites of the named runs are shown as their progress
+    if (run->name.empty()) {
+        suite_name = test->getName();
+        auto suite = dynamic_cast<const TestSuite*>(test);
+        if (suite != nullptr) {
+            suite_size = suite->size();
+        }
     }
+    startItem(run, test);
+    publishStatus();
     critical.unlock();
+    publish({std::move(text), toJson("suiteStarted", run, test)});
 }
 
-void WebProgressListenerImpl::endTestSuite(const Test* test)
+void WebProgressListenerImpl::endTestSuite(Run* run,
+                                           const Test* test)
 {
-    string text = Asserter::format("<br> %s Test suite %s %s %s",
+    TestOutcome outcome = TestListenerAdapter::outcomeOf(test);
+    string text = Asserter::format("<br> %s%s Test suite %s %s %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    encode(test->getName()).c_str(),
-                                   (test->succeeded()) ? "passed!" : "failed!",
+                                   (outcome.succeeded()) ? "passed!" : "failed!",
                                    ENDC);
     critical.lock();
-    result += text;
+    endItem(run, test, outcome);
+    if (shown(run)) {
+        publishStatus();
+    }
+    observeEnd(test, outcome, true);
     critical.unlock();
+    publish({std::move(text), toJson((outcome.succeeded()) ? "suitePassed" : "suiteFailed", run, test)});
 }
 
-void WebProgressListenerImpl::startTestRunner()
+void WebProgressListenerImpl::startTestRunner(Run* run)
 {
-    string text = Asserter::format("<br> %s Starting test runner. %s",
+    string text = Asserter::format("<br> %s%s Starting test runner. %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    ENDC);
     critical.lock();
-    result += text;
+    run->finished = false;
+    if (shown(run)) {
+        publishStatus();
+    }
     critical.unlock();
+    publish({std::move(text), toJson("runnerStarted", run, nullptr)});
 }
 
-void WebProgressListenerImpl::endTestRunner()
+void WebProgressListenerImpl::endTestRunner(Run* run)
 {
-    string text = Asserter::format("<br> %s Ending test runner. %s",
+    string text = Asserter::format("<br> %s%s Ending test runner. %s",
+                                   tag(run).c_str(),
                                    BLUE,
                                    ENDC);
     critical.lock();
-    result += text;
+    run->finished = true;
+    run->depth = 0;
+    run->running.clear();
+    run->current.clear();
+    if (shown(run)) {
+        publishStatus();
+    }
     critical.unlock();
+    publish({std::move(text), toJson("runnerEnded", run, nullptr)});
 }
 
 
@@ -400,54 +1061,76 @@ WebProgressListener::WebProgressListener(unsigned int port,
                                          bool verbose)
 {
     implement = &WebProgressListenerImpl::create(port, verbose);
+    run = ((WebProgressListenerImpl*)implement)->addRun("");
 }
 
-WebProgressListener::~WebProgressListener() = default;
+WebProgressListener::WebProgressListener(const std::string& run,
+                                         unsigned int port,
+                                         bool verbose)
+{
+    implement = &WebProgressListenerImpl::create(port, verbose);
+    this->run = ((WebProgressListenerImpl*)implement)->addRun(run);
+}
+
+WebProgressListener::~WebProgressListener()
+{
+    ((WebProgressListenerImpl*)implement)->metrics.setTestResult(nullptr);
+}
+
+void WebProgressListener::setTestResult(const TestResult* result)
+{
+    ((WebProgressListenerImpl*)implement)->metrics.setTestResult(result);
+}
+
+void WebProgressListener::setPlan(const std::vector<std::pair<std::string, double>>& plan)
+{
+    ((WebProgressListenerImpl*)implement)->setPlan((WebProgressListenerImpl::Run*)run, plan);
+}
 
 void WebProgressListener::addReport(const Test* test,
                                     TestMessage msg)
 {
-    ((WebProgressListener*)implement)->addReport(test, msg);
+    ((WebProgressListenerImpl*)implement)->addReport((WebProgressListenerImpl::Run*)run, test, msg);
 }
 
 void WebProgressListener::addError(const Test* test,
                                    TestMessage msg)
 {
-    ((WebProgressListener*)implement)->addError(test, msg);
+    ((WebProgressListenerImpl*)implement)->addError((WebProgressListenerImpl::Run*)run, test, msg);
 }
 
 void WebProgressListener::addFailure(const Test* test,
                                      TestMessage msg)
 {
-    ((WebProgressListener*)implement)->addFailure(test, msg);
+    ((WebProgressListenerImpl*)implement)->addFailure((WebProgressListenerImpl::Run*)run, test, msg);
 }
 
 void WebProgressListener::startTest(const Test* test)
 {
-    ((WebProgressListener*)implement)->startTest(test);
+    ((WebProgressListenerImpl*)implement)->startTest((WebProgressListenerImpl::Run*)run, test);
 }
 
 void WebProgressListener::endTest(const Test* test)
 {
-    ((WebProgressListener*)implement)->endTest(test);
+    ((WebProgressListenerImpl*)implement)->endTest((WebProgressListenerImpl::Run*)run, test);
 }
 
 void WebProgressListener::startTestSuite(const Test* test)
 {
-    ((WebProgressListener*)implement)->startTestSuite(test);
+    ((WebProgressListenerImpl*)implement)->startTestSuite((WebProgressListenerImpl::Run*)run, test);
 }
 
 void WebProgressListener::endTestSuite(const Test* test)
 {
-    ((WebProgressListener*)implement)->endTestSuite(test);
+    ((WebProgressListenerImpl*)implement)->endTestSuite((WebProgressListenerImpl::Run*)run, test);
 }
 
 void WebProgressListener::startTestRunner()
 {
-    ((WebProgressListener*)implement)->startTestRunner();
+    ((WebProgressListenerImpl*)implement)->startTestRunner((WebProgressListenerImpl::Run*)run);
 }
 
 void WebProgressListener::endTestRunner()
 {
-    ((WebProgressListener*)implement)->endTestRunner();
+    ((WebProgressListenerImpl*)implement)->endTestRunner((WebProgressListenerImpl::Run*)run);
 }
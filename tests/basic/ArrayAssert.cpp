@@ -0,0 +1,155 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/ArrayCheck.h>
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestEventListener.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class Recorder : public TestEventListener
+{
+public:
+    unsigned int getInterests() const override
+    {
+        return TestEvent::mask(TestEvent::Kind::Failure);
+    }
+
+    void handleEvent(const TestEvent& event) override
+    {
+        failures.push_back(event.getMessage());
+    }
+
+    std::vector<TestMessage> failures;
+};
+
+
+class Joints : public TestCase
+{
+public:
+    Joints() :
+            TestCase("Joints")
+    {
+    }
+
+    using TestCase::run;
+
+    void run() override
+    {
+        std::vector<double> reference(1000, 1.0);
+        std::vector<double> positions(reference);
+        positions[512] = 1.03;
+        positions[600] = 2.0;
+        positions[700] = std::numeric_limits<double>::quiet_NaN();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NEAR(positions.data(), reference.data(), positions.size(), 0.01, 0, "joint positions");
+    }
+};
+
+
+class ArrayAssert : public TestCase
+{
+public:
+    ArrayAssert() :
+            TestCase("ArrayAssert")
+    {
+    }
+
+    void run() override
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+
+        // the mismatches are found at any position (SIMD blocks and tail)
+        for (size_t size = 0; size < 11; size++) {
+            bool consistent = true;
+            for (size_t bad = 0; bad < size; bad++) {
+                std::vector<double> expected(size, 1.0);
+                std::vector<double> actual(expected);
+                std::vector<float> expectedf(size, 1.0f);
+                std::vector<float> actualf(expectedf);
+                actual[bad] = 1.5;
+                actualf[bad] = 1.5f;
+                ArrayCheck check = ArrayCheck::closeTo(actual.data(), expected.data(), size, 0.1);
+                ArrayCheck checkf = ArrayCheck::closeTo(actualf.data(), expectedf.data(), size, 0.1);
+                consistent &= (check.getMismatchCount() == 1 && check.getWorstIndex() == bad);
+                consistent &= (checkf.getMismatchCount() == 1 && checkf.getWorstIndex() == bad);
+                consistent &= !ArrayCheck::allFinite(std::vector<double>(size, inf).data(), size).passed();
+                expectedf[bad] = -1.0f;
+                actualf[bad] = std::nextafter(std::nextafter(std::nextafter(-1.0f, 0.0f), 0.0f), 0.0f);
+                ArrayCheck ulps = ArrayCheck::withinUlps(actualf.data(), expectedf.data(), size, 2);
+                consistent &= (ulps.getMismatchCount() == 1 && ulps.getWorstIndex() == bad && ulps.getWorstError() == 3);
+                consistent &= ArrayCheck::withinUlps(actualf.data(), expectedf.data(), size, 3).passed();
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(consistent, Asserter::compose("Checking the mismatches of ", size, " elements"));
+        }
+
+        // the tolerances
+        double expected[] = { 1.0, 100.0, inf, -inf, 0.0 };
+        double actual[] = { 1.05, 104.0, inf, -inf, -0.0 };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NEAR(actual, expected, 5, 0.1, 0.05, "Checking the absolute and relative tolerances");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!ArrayCheck::closeTo(actual, expected, 5, 0.01, 0.01).passed(), "Checking the tolerances are applied");
+        double withNan[] = { 1.0, nan };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!ArrayCheck::closeTo(withNan, withNan, 2, inf, inf).passed(), "Checking a NaN is never close");
+
+        // the ULP distance
+        float one = 1.0f;
+        float next[] = { std::nextafter(one, 2.0f), std::nextafter(std::nextafter(one, 2.0f), 2.0f), -0.0f, 1.0f };
+        float ones[] = { one, one, 0.0f, 1.0f };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_ULP(next, ones, 4, 2, "Checking the ULP distance of floats");
+        ArrayCheck ulps = ArrayCheck::withinUlps(next, ones, 4, 1);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(ulps.getMismatchCount() == 1 && ulps.getWorstIndex() == 1 && ulps.getWorstError() == 2, "Checking the ULP mismatch");
+        double small[] = { -std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::denorm_min() };
+        double zeros[] = { 0.0, 0.0 };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_ULP(small, zeros, 2, 1, "Checking the ULP distance across zero");
+
+        // the norm and the distance
+        double vector[] = { 3.0, 4.0, 0.0 };
+        double origin[] = { 0.0, 0.0, 0.0 };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_NORM(vector, 3, 4.9, 5.1, "Checking the norm");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_DISTANCE(vector, origin, 3, 5.0, "Checking the distance");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!ArrayCheck::normWithin(vector, 3, 0, 4.9).passed(), "Checking the norm bound");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK_ARRAY_FINITE(vector, 3, "Checking the values are finite");
+
+        // a failure is reported in one message
+        Joints joints;
+        Recorder recorder;
+        TestResult result;
+        result.addListener(&recorder);
+        joints.run(result);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(recorder.failures.size() == 1, "Checking one failure is reported");
+        if (!recorder.failures.empty()) {
+            const TestMessage& msg = recorder.failures[0];
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(msg.getMessage() == "checking array (positions.data() near reference.data())", "Checking the summary");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(msg.getDetail() == "joint positions: 3 of 1000 elements mismatch, worst at [700] nan vs 1 (error inf): [512] 1.03 vs 1, [600] 2 vs 1, [700] nan vs 1",
+                                             "Checking the detail");
+        }
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(ArrayAssert)
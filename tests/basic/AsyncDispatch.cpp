@@ -0,0 +1,224 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestListener.h>
+#include <robottestingframework/TestListenerAdapter.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest() :
+            TestCase("MyTest")
+    {
+    }
+
+    void run() override
+    {
+    }
+};
+
+
+class MyListener : public TestListener
+{
+public:
+    MyListener(TestResult& result) :
+            result(result),
+            blocked(false),
+            startTests(0),
+            endTests(0),
+            reentrant(false),
+            producerThread(false)
+    {
+    }
+
+    void addReport(const Test* test, TestMessage msg) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reports.push_back(std::stoi(msg.getDetail()));
+        producerThread |= std::this_thread::get_id() == producer;
+    }
+
+    void startTest(const Test* test) override
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        startTests++;
+        while (blocked) {
+            condition.wait(lock);
+        }
+        lock.unlock();
+        if (reentrant) {
+            // delivered inline, since it is issued by the dispatcher thread
+            result.addReport(test, TestMessage("report", "-1", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        }
+    }
+
+    void endTest(const Test* test) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        endTests++;
+        passed.push_back(TestListenerAdapter::outcomeOf(test).succeeded());
+    }
+
+    void block(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocked = enabled;
+        condition.notify_all();
+    }
+
+    TestResult& result;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool blocked;
+    std::vector<int> reports;
+    unsigned int startTests;
+    unsigned int endTests;
+    std::vector<bool> passed;
+    bool reentrant;
+    std::thread::id producer;
+    bool producerThread;
+};
+
+
+class AsyncDispatch : public TestCase
+{
+public:
+    AsyncDispatch() :
+            TestCase("AsyncDispatch")
+    {
+    }
+
+    void run() override
+    {
+        MyTest test;
+
+        // the reports of concurrent producers keep their order
+        {
+            TestResult result;
+            MyListener listener(result);
+            listener.producer = std::this_thread::get_id();
+            result.addListener(&listener);
+            result.setAsync(true, 16);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(result.isAsync(), "Checking the asynchronous mode is enabled");
+
+            const int producers = 4;
+            const int reports = 2000;
+            std::vector<std::thread> threads;
+            for (int p = 0; p < producers; p++) {
+                threads.emplace_back([&result, &test, p, reports]() {
+                    for (int i = 0; i < reports; i++) {
+                        result.addReport(&test, TestMessage("report", std::to_string(p * reports + i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            result.addReport(&test, TestMessage("report", "-1", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            result.flush();
+
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.reports.size() == producers * reports + 1, "Checking all the reports are delivered");
+            std::vector<int> last(producers, -1);
+            bool inOrder = true;
+            for (int report : listener.reports) {
+                if (report >= 0) {
+                    inOrder &= report > last[report / reports];
+                    last[report / reports] = report;
+                }
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(inOrder, "Checking the reports of each producer are in order");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(!listener.producerThread, "Checking the listener is called by the dispatcher");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(result.droppedCount() == 0, "Checking no report is dropped");
+        }
+
+        // a full queue drops the reports but not the other events
+        {
+            TestResult result;
+            MyListener listener(result);
+            result.addListener(&listener);
+            result.setAsync(true, 8, TestResult::OverflowPolicy::DropReports);
+            listener.block(true);
+            result.startTest(&test);
+            for (int i = 0; i < 100; i++) {
+                result.addReport(&test, TestMessage("report", std::to_string(i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            }
+            std::thread unblock([&listener]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                listener.block(false);
+            });
+            result.endTest(&test);
+            result.endTestRunner();
+            unblock.join();
+
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(result.droppedCount() > 0, "Checking some reports are dropped");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.reports.size() + result.droppedCount() == 100, "Checking the dropped reports are counted");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.startTests == 1 && listener.endTests == 1, "Checking the other events are delivered");
+        }
+
+        // the listeners get the outcome of a test when it has ended, even
+        // if it has changed before the event is delivered
+        {
+            TestResult result;
+            MyListener listener(result);
+            MyTest changing;
+            result.addListener(&listener);
+            result.setAsync(true, 8);
+            listener.block(true);
+            result.startTest(&changing);
+            result.endTest(&changing);
+            changing.failed();
+            listener.block(false);
+            result.flush();
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.passed == std::vector<bool>{ true }, "Checking the outcome is taken when the test ends");
+            result.setAsync(false);
+        }
+
+        // the events issued by a listener are delivered inline
+        {
+            TestResult result;
+            MyListener listener(result);
+            listener.reentrant = true;
+            result.addListener(&listener);
+            result.setAsync(true, 2);
+            for (int i = 0; i < 10; i++) {
+                result.startTest(&test);
+            }
+            result.setAsync(false);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(!result.isAsync(), "Checking the asynchronous mode is disabled");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.startTests == 10 && listener.reports.size() == 10, "Checking the reentrant events are delivered");
+        }
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(AsyncDispatch)
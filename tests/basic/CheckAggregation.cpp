@@ -0,0 +1,133 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestEventListener.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <string>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class Recorder : public TestEventListener
+{
+public:
+    unsigned int getInterests() const override
+    {
+        return TestEvent::mask(TestEvent::Kind::Report) | TestEvent::mask(TestEvent::Kind::Failure);
+    }
+
+    void handleEvent(const TestEvent& event) override
+    {
+        events.push_back(event);
+    }
+
+    std::vector<TestEvent> events;
+};
+
+
+class ControlLoop : public TestCase
+{
+public:
+    ControlLoop() :
+            TestCase("ControlLoop"),
+            built(0)
+    {
+    }
+
+    using TestCase::run;
+
+    std::string detail(int cycle)
+    {
+        built++;
+        return Asserter::compose("cycle ", cycle);
+    }
+
+    void run() override
+    {
+        for (int cycle = 1; cycle <= 1000; cycle++) {
+            bool failing = (cycle == 512 || cycle == 600 || cycle == 700);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(!failing, detail(cycle));
+        }
+        for (int cycle = 1; cycle <= 10; cycle++) {
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK_AGGREGATED(cycle > 0, Asserter::compose("site ", cycle));
+        }
+    }
+
+    // the number of the details which have been built
+    int built;
+};
+
+
+class CheckAggregation : public TestCase
+{
+public:
+    CheckAggregation() :
+            TestCase("CheckAggregation")
+    {
+    }
+
+    static std::vector<std::string> details(const std::vector<TestEvent>& events, TestEvent::Kind kind)
+    {
+        std::vector<std::string> found;
+        for (const auto& event : events) {
+            if (event.getKind() == kind) {
+                found.push_back(event.getMessage().getDetail());
+            }
+        }
+        return found;
+    }
+
+    void run() override
+    {
+        // all the checks of the test are aggregated
+        ControlLoop loop;
+        loop.setCheckAggregation(true, 2);
+        Recorder recorder;
+        TestResult result;
+        result.addListener(&recorder);
+        loop.run(result);
+        std::vector<std::string> reports = details(recorder.events, TestEvent::Kind::Report);
+        std::vector<std::string> failures = details(recorder.events, TestEvent::Kind::Failure);
+        std::vector<std::string> expected{ "cycle 1", "cycle 2", "site 1", "site 2",
+                                           "passed at iteration 999", "passed at iteration 1000", "checked 1000 times, 3 failures, first at iteration 512",
+                                           "passed at iteration 9", "passed at iteration 10", "checked 10 times, 0 failures" };
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(reports == expected, "Checking the first, the last and the summary are reported");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(failures.size() == 3, "Checking all the failures are reported");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(loop.built == 2 + 3, "Checking only the details of the reported checks are built");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!loop.succeeded(), "Checking the test failed");
+
+        // only the aggregated call sites
+        ControlLoop plain;
+        Recorder all;
+        TestResult plainResult;
+        plainResult.addListener(&all);
+        plain.run(plainResult);
+        reports = details(all.events, TestEvent::Kind::Report);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(reports.size() == 997 + 1 + 1 + 1, "Checking only the aggregated call site is summarized");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!reports.empty() && reports.back() == "checked 10 times, 0 failures", "Checking the summary of the aggregated call site");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(CheckAggregation)
@@ -0,0 +1,217 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestEventListener.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest() :
+            TestCase("MyTest")
+    {
+    }
+
+    void run() override
+    {
+    }
+};
+
+
+class MyListener : public TestEventListener
+{
+public:
+    MyListener(unsigned int interests, BatchMode mode = BatchMode::None, double period = 0.1) :
+            interests(interests),
+            mode(mode),
+            period(period),
+            delivered(0)
+    {
+    }
+
+    unsigned int getInterests() const override
+    {
+        return interests;
+    }
+
+    BatchMode getBatchMode() const override
+    {
+        return mode;
+    }
+
+    double getBatchPeriod() const override
+    {
+        return period;
+    }
+
+    void handleEvent(const TestEvent& event) override
+    {
+        events.push_back(event);
+    }
+
+    void handleEvents(const TestEvent* events, std::size_t count) override
+    {
+        batches.push_back(count);
+        TestEventListener::handleEvents(events, count);
+        delivered.fetch_add(1);
+    }
+
+    unsigned int interests;
+    BatchMode mode;
+    double period;
+    std::vector<TestEvent> events;
+    std::vector<std::size_t> batches;
+    // the number of the delivered batches, which can be read by any thread
+    std::atomic<std::size_t> delivered;
+};
+
+
+class EventListener : public TestCase
+{
+public:
+    EventListener() :
+            TestCase("EventListener")
+    {
+    }
+
+    void issue(TestResult& result, MyTest& test)
+    {
+        result.startTestRunner();
+        for (int i = 0; i < 3; i++) {
+            result.startTest(&test);
+            result.addReport(&test, TestMessage("report", std::to_string(i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            result.addFailure(&test, TestMessage("failure", std::to_string(i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            result.endTest(&test);
+        }
+        result.endTestRunner();
+    }
+
+    void run() override
+    {
+        MyTest test;
+
+        // only the events of the given kinds are delivered
+        {
+            TestResult result;
+            MyListener listener(TestEvent::mask(TestEvent::Kind::Failure));
+            result.addListener(&listener);
+            issue(result, test);
+            bool failures = (listener.events.size() == 3);
+            for (const auto& event : listener.events) {
+                failures &= (event.getKind() == TestEvent::Kind::Failure && event.getTest() == &test);
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(failures, "Checking only the failures are delivered");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events[2].getMessage().getDetail() == "2", "Checking the message of the event");
+        }
+
+        // the events are delivered in batches ending with each test
+        {
+            TestResult result;
+            MyListener listener(TestEvent::AllKinds, TestEventListener::BatchMode::PerTest);
+            result.addListener(&listener);
+            issue(result, test);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.size() == 14, "Checking all the events are delivered");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK((listener.batches == std::vector<std::size_t>{ 1, 4, 4, 4, 1 }), "Checking the batches end with the tests");
+        }
+
+        // the events are delivered once the batch period has elapsed
+        {
+            TestResult result;
+            MyListener listener(TestEvent::AllKinds, TestEventListener::BatchMode::Period, 3600);
+            result.addListener(&listener);
+            result.startTest(&test);
+            result.addReport(&test, TestMessage("report", "pending", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.empty(), "Checking the batch is pending");
+            result.flush();
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.size() == 2 && listener.batches.size() == 1, "Checking the batch is delivered by flush()");
+            result.endTest(&test);
+            result.endTestRunner();
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.size() == 4 && listener.batches.size() == 2, "Checking the batch is delivered at the end of the runner");
+        }
+
+        // a batch is held for at least the period, until the next event
+        {
+            TestResult result;
+            MyListener listener(TestEvent::AllKinds, TestEventListener::BatchMode::Period, 0.01);
+            result.addListener(&listener);
+            result.startTest(&test);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.empty(), "Checking the batch waits for the next event");
+            result.addReport(&test, TestMessage("report", "late", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.events.size() == 2 && listener.batches.size() == 1, "Checking the batch is delivered with the next event");
+            result.endTestRunner();
+        }
+
+        // the dispatcher thread delivers a batch once the period has elapsed
+        {
+            TestResult result;
+            MyListener listener(TestEvent::AllKinds, TestEventListener::BatchMode::Period, 0.05);
+            result.addListener(&listener);
+            result.setAsync(true);
+            result.startTest(&test);
+            result.addReport(&test, TestMessage("report", "timed", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            for (int i = 0; i < 200 && listener.delivered.load() == 0; i++) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(listener.delivered.load() == 1 && listener.events.size() == 2, "Checking the batch is delivered without a further event");
+            result.endTestRunner();
+            result.setAsync(false);
+        }
+
+        // the TestListener are delivered the same events, in order, also
+        // when they are issued again with their original time
+        {
+            TestResult result;
+            TestResultCollector collector;
+            MyListener listener(TestEvent::AllKinds);
+            result.addListener(&collector);
+            result.addListener(&listener);
+            issue(result, test);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.testCount() == 3 && collector.getResults().size() == 12, "Checking the collector gets the events");
+
+            TestResult replay;
+            MyListener copy(TestEvent::AllKinds);
+            replay.addListener(&copy);
+            for (const auto& event : listener.events) {
+                replay.addEvent(event);
+            }
+            bool same = (copy.events.size() == listener.events.size());
+            for (size_t i = 0; same && i < copy.events.size(); i++) {
+                same &= (copy.events[i].getKind() == listener.events[i].getKind() && copy.events[i].getTime() == listener.events[i].getTime());
+            }
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(same, "Checking the events are issued again with their time");
+        }
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(EventListener)
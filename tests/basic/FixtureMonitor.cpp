@@ -0,0 +1,148 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/TestRunner.h>
+#include <robottestingframework/TestSuite.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace robottestingframework;
+
+
+class MyFixture : public FixtureManager
+{
+public:
+    MyFixture() :
+            setups(0),
+            checks(0),
+            broken(false)
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        setups++;
+        broken = false;
+        return true;
+    }
+
+    bool check() override
+    {
+        checks++;
+        return !broken;
+    }
+
+    void tearDown() override
+    {
+    }
+
+public:
+    std::atomic<unsigned int> setups;
+    std::atomic<unsigned int> checks;
+    std::atomic<bool> broken;
+};
+
+
+class BreakingTest : public TestCase
+{
+public:
+    BreakingTest(MyFixture& fixture) :
+            TestCase("BreakingTest"),
+            fixture(fixture),
+            elapsed(0)
+    {
+    }
+
+    void run() override
+    {
+        // break the fixture and wait to be interrupted
+        auto start = std::chrono::steady_clock::now();
+        fixture.broken = true;
+        while (!isInterrupted() && elapsed < 5) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+public:
+    MyFixture& fixture;
+    double elapsed;
+};
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest() :
+            TestCase("MyTest")
+    {
+    }
+
+    void run() override
+    {
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(3 < 5, "smaller");
+    }
+};
+
+
+class MyFixtureMonitor : public TestCase
+{
+public:
+    MyFixtureMonitor() :
+            TestCase("FixtureMonitor")
+    {
+    }
+
+    void run() override
+    {
+        TestResultCollector collector;
+        TestResult result;
+        result.addListener(&collector);
+
+        MyFixture fixture;
+        BreakingTest test1(fixture);
+        MyTest test2;
+
+        TestSuite suite("MyTestSuite");
+        suite.setMonitorPeriod(0.01);
+        suite.addFixtureManager(&fixture);
+        suite.addTest(&test1);
+        suite.addTest(&test2);
+
+        TestRunner runner;
+        runner.addTest(&suite);
+        runner.run(result);
+
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(test1.isInterrupted(), "Checking the test is interrupted on collapse");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(test1.elapsed < 5, "Checking the test is interrupted promptly");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(fixture.setups == 2, "Checking the fixture is restarted");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(test2.succeeded(), "Checking the next test is run");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.failedSuiteCount() == 1, "Checking failed suite count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.testCount() == 2, "Checking tests count");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(MyFixtureMonitor)
@@ -0,0 +1,140 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestEventListener.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <string>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class Counter : public TestEventListener
+{
+public:
+    Counter(unsigned int interests) :
+            interests(interests)
+    {
+    }
+
+    unsigned int getInterests() const override
+    {
+        return interests;
+    }
+
+    void handleEvent(const TestEvent& event) override
+    {
+        events.push_back(event);
+    }
+
+    unsigned int interests;
+    std::vector<TestEvent> events;
+};
+
+
+class Checker : public TestCase
+{
+public:
+    Checker() :
+            TestCase("Checker"),
+            built(0)
+    {
+    }
+
+    using TestCase::run;
+
+    std::string detail()
+    {
+        built++;
+        return "detail";
+    }
+
+    void run() override
+    {
+        int value = 1;
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(value == 1, detail());
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_TRUE(value == 0 || value == 2, detail());
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(value == 1, detail());
+        ROBOTTESTINGFRAMEWORK_TEST_REPORT(detail());
+        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(value == 1, detail());
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR_IF_TRUE(value == 0 || value == 2, detail());
+        ROBOTTESTINGFRAMEWORK_TEST_FAIL_IF_FALSE(value == 2, detail());
+    }
+
+    int built;
+};
+
+
+class LazyAssert : public TestCase
+{
+public:
+    LazyAssert() :
+            TestCase("LazyAssert")
+    {
+    }
+
+    void run() override
+    {
+        // the messages of the passing checks are not built if nobody wants the reports
+        Checker quiet;
+        Counter failures(TestEvent::mask(TestEvent::Kind::Failure));
+        TestResult quietResult;
+        quietResult.addListener(&failures);
+        quiet.run(quietResult);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(quiet.built == 1, "Checking only the failure message is built");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(failures.events.size() == 1, "Checking the failure is reported");
+        if (!failures.events.empty()) {
+            const TestMessage& msg = failures.events[0].getMessage();
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(msg.getMessage() == "checking (value == 2)", "Checking the failure message");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(msg.getDetail() == "detail", "Checking the failure detail");
+        }
+
+        // the reports are built when they are wanted
+        Checker verbose;
+        Counter all(TestEvent::AllKinds);
+        TestResult verboseResult;
+        verboseResult.addListener(&all);
+        verbose.run(verboseResult);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(verbose.built == 3, "Checking the reports and the failure messages are built");
+
+        // the failing assertions throw the message
+        bool thrown = false;
+        try {
+            ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_TRUE(1 == 0 || 1 == 1, "expected");
+        } catch (TestFailureException& e) {
+            thrown = (e.message().getMessage() == "asserts failure on (1 == 0 || 1 == 1) with exception");
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(thrown, "Checking the failing assertion throws");
+
+        // the formatted messages are not truncated
+        std::string text(1000, 'x');
+        std::string formatted = Asserter::format("%s:%d", text.c_str(), 42);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(formatted == text + ":42", "Checking a long message is formatted");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(Asserter::format("%d", 7) == "7", "Checking a short message is formatted");
+        std::string composed = Asserter::compose("value ", 3.5, " of ", 4, ' ', text);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(composed == "value 3.5 of 4 " + text, "Checking a message is composed");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(LazyAssert)
@@ -0,0 +1,150 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/TestRunner.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace robottestingframework;
+
+
+// reports through the test which is running on the calling thread
+static void step(int i)
+{
+    Asserter::report(TestMessage("step " + std::to_string(i)), TestContext::currentTest());
+}
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest(std::string name, bool pass) :
+            TestCase(name),
+            pass(pass)
+    {
+    }
+
+    void run() override
+    {
+        for (int i = 0; i < 5; i++) {
+            step(i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(pass, "checking the result");
+    }
+
+private:
+    bool pass;
+};
+
+
+class GroupChecker : public TestListener
+{
+public:
+    GroupChecker() :
+            current(nullptr),
+            grouped(true)
+    {
+    }
+
+    void addReport(const Test* test, TestMessage msg) override
+    {
+        check(test);
+    }
+
+    void addFailure(const Test* test, TestMessage msg) override
+    {
+        check(test);
+    }
+
+    void startTest(const Test* test) override
+    {
+        grouped = grouped && (current == nullptr);
+        current = test;
+    }
+
+    void endTest(const Test* test) override
+    {
+        check(test);
+        current = nullptr;
+    }
+
+    bool isGrouped() const
+    {
+        return grouped;
+    }
+
+private:
+    void check(const Test* test)
+    {
+        grouped = grouped && (current == test);
+    }
+
+private:
+    const Test* current;
+    bool grouped;
+};
+
+
+class ParallelRunner : public TestCase
+{
+public:
+    ParallelRunner() :
+            TestCase("ParallelRunner")
+    {
+    }
+
+    void run() override
+    {
+        TestResultCollector collector;
+        GroupChecker checker;
+
+        // create a test result and add the listeners
+        TestResult result;
+        result.addListener(&collector);
+        result.addListener(&checker);
+
+        // create a test runner with a pool of workers
+        TestRunner runner;
+        runner.setJobs(4);
+        std::vector<MyTest*> tests;
+        for (int i = 0; i < 8; i++) {
+            tests.push_back(new MyTest("MyTest" + std::to_string(i), i % 2 == 0));
+            runner.addTest(tests.back());
+        }
+        runner.run(result);
+        for (auto test : tests) {
+            delete test;
+        }
+
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(runner.getJobs() == 4, "Checking jobs count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.testCount() == 8, "Checking tests count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.passedCount() == 4, "Checking passed count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.failedCount() == 4, "Checking failed count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(checker.isGrouped(), "Checking events are grouped per test");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(ParallelRunner)
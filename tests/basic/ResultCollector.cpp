@@ -0,0 +1,157 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest() :
+            TestCase("MyTest")
+    {
+    }
+
+    void run() override
+    {
+    }
+};
+
+
+class ResultCollector : public TestCase
+{
+public:
+    ResultCollector() :
+            TestCase("ResultCollector")
+    {
+    }
+
+    void run() override
+    {
+        MyTest test;
+        TestResultCollector collector;
+        TestResult result;
+        result.addListener(&collector);
+
+        // more events than a single chunk of the collector
+        const unsigned int reports = 3000;
+        result.startTestSuite(&test);
+        result.startTest(&test);
+        for (unsigned int i = 0; i < reports; i++) {
+            result.addReport(&test, TestMessage("report", Asserter::format("%u", i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+        }
+        result.addFailure(&test, TestMessage("failure"));
+        result.addError(&test, TestMessage("error"));
+        result.addTimeout(&test, TestMessage("timeout"), 1.5);
+        result.endTest(&test);
+        result.endTestSuite(&test);
+
+        std::vector<ResultEvent::Kind> expected;
+        expected.push_back(ResultEvent::Kind::StartSuite);
+        expected.push_back(ResultEvent::Kind::StartTest);
+        expected.insert(expected.end(), reports, ResultEvent::Kind::Report);
+        expected.push_back(ResultEvent::Kind::Failure);
+        expected.push_back(ResultEvent::Kind::Error);
+        expected.push_back(ResultEvent::Kind::Timeout);
+        expected.push_back(ResultEvent::Kind::EndTest);
+        expected.push_back(ResultEvent::Kind::EndSuite);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.eventCount() == expected.size(), "Checking the number of events");
+
+        // the events are visited in order
+        std::vector<ResultEvent::Kind> kinds;
+        bool inOrder = true;
+        collector.visit([&](const ResultEvent& event) {
+            if (event.getKind() == ResultEvent::Kind::Report) {
+                inOrder &= (event.getMessage().getDetail() == Asserter::format("%u", static_cast<unsigned int>(kinds.size() - 2)));
+            }
+            if (event.getKind() == ResultEvent::Kind::Timeout) {
+                inOrder &= (static_cast<const ResultEventTimeout&>(event).getElapsed() == 1.5);
+            }
+            kinds.push_back(event.getKind());
+        });
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(kinds == expected, "Checking the kinds of the visited events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(inOrder, "Checking the content of the visited events");
+
+        // the compatibility view holds the same events
+        TestResultCollector::EventResultContainer& events = collector.getResults();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(events.size() == expected.size(), "Checking the size of the results");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(dynamic_cast<ResultEventStartSuite*>(events.front()) != nullptr, "Checking the type of the first result");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(dynamic_cast<ResultEventError*>(events[reports + 4]) != nullptr, "Checking a timeout is an error");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(dynamic_cast<ResultEventEndSuite*>(events.back()) != nullptr, "Checking the type of the last result");
+
+        result.addReport(&test, TestMessage("late report"));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.getResults().size() == expected.size() + 1, "Checking the results are updated");
+
+        collector.reset();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.eventCount() == 0, "Checking the events are cleared");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.getResults().empty(), "Checking the results are cleared");
+
+        // the oldest events are spilled when the memory budget is exceeded
+        TestResultCollector limited;
+        limited.setMemoryBudget(1);
+        result.removeListener(&collector);
+        result.addListener(&limited);
+        result.startTest(&test);
+        for (unsigned int i = 0; i < reports; i++) {
+            if (i % 100 == 0) {
+                result.addFailure(&test, TestMessage("failure", Asserter::format("%u", i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            } else {
+                result.addReport(&test, TestMessage("report", Asserter::format("%u", i), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            }
+        }
+        result.addTimeout(&test, TestMessage("timeout"), 2.5);
+        result.endTest(&test);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(limited.spilledCount() > 0, "Checking some events are spilled");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(limited.eventCount() == reports + 3, "Checking the number of events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(limited.testCount() == 1, "Checking the counters are kept");
+
+        // the spilled events are read back in order
+        std::size_t index = 0;
+        inOrder = true;
+        limited.visit([&](const ResultEvent& event) {
+            if (index >= 1 && index <= reports) {
+                auto kind = ((index - 1) % 100 == 0) ? ResultEvent::Kind::Failure : ResultEvent::Kind::Report;
+                inOrder &= (event.getKind() == kind);
+                inOrder &= (event.getTest() == &test);
+                inOrder &= (event.getMessage().getDetail() == Asserter::format("%u", static_cast<unsigned int>(index - 1)));
+                inOrder &= (event.getMessage().getSourceLineNumber() != 0);
+            }
+            index++;
+        });
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(index == limited.eventCount(), "Checking all the events are visited");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(inOrder, "Checking the content of the spilled events");
+
+        TestResultCollector::EventResultContainer& spilled = limited.getResults();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(spilled.size() == limited.eventCount(), "Checking the size of the results");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(spilled[1]->getKind() == ResultEvent::Kind::Failure, "Checking a spilled failure");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(static_cast<ResultEventTimeout*>(spilled[reports + 1])->getElapsed() == 2.5, "Checking the timeout");
+        limited.reset();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(limited.spilledCount() == 0, "Checking the spilled events are cleared");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(ResultCollector)
@@ -0,0 +1,172 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/SharedFixture.h>
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/TestRunner.h>
+#include <robottestingframework/TestSuite.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <thread>
+
+using namespace robottestingframework;
+
+
+class MyTest1 : public TestCase
+{
+public:
+    MyTest1() :
+            TestCase("MyTest1")
+    {
+    }
+
+    void run() override
+    {
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(3 < 5, "smaller");
+    }
+};
+
+
+class CountingFixture : public FixtureManager
+{
+public:
+    CountingFixture(unsigned int failingCheck = 0) :
+            setups(0),
+            tearDowns(0),
+            checks(0),
+            failingCheck(failingCheck)
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        setups++;
+        return true;
+    }
+
+    bool check() override
+    {
+        return (++checks != failingCheck);
+    }
+
+    void tearDown() override
+    {
+        tearDowns++;
+    }
+
+public:
+    unsigned int setups;
+    unsigned int tearDowns;
+    unsigned int checks;
+    unsigned int failingCheck;
+};
+
+
+// checks the shared fixture from another thread while it is being set up
+class CheckingFixture : public FixtureManager
+{
+public:
+    CheckingFixture() :
+            other(nullptr),
+            checked(true)
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        std::thread checker([this]() { checked = other->check(); });
+        checker.join();
+        return true;
+    }
+
+public:
+    FixtureManager* other;
+    bool checked;
+};
+
+
+class MySharedFixture : public TestCase
+{
+public:
+    MySharedFixture() :
+            TestCase("SharedFixture")
+    {
+    }
+
+    void runSuites(CountingFixture& fixture, TestResultCollector& collector)
+    {
+        TestResult result;
+        result.addListener(&collector);
+
+        MyTest1 test1;
+        MyTest1 test2;
+        SharedFixture shared(&fixture);
+
+        TestSuite suite1("MyTestSuite1");
+        suite1.addFixtureManager(shared.share());
+        suite1.addTest(&test1);
+        suite1.addTest(&test2);
+
+        TestSuite suite2("MyTestSuite2");
+        suite2.addFixtureManager(shared.share());
+        suite2.addTest(&test1);
+        suite2.addTest(&test2);
+
+        TestRunner runner;
+        runner.addTest(&suite1);
+        runner.addTest(&suite2);
+        runner.run(result);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!shared.isSetup(), "Checking the shared fixture is torn down");
+    }
+
+    void run() override
+    {
+        // the fixture is set up once for both the suites
+        CountingFixture fixture;
+        TestResultCollector collector;
+        runSuites(fixture, collector);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(fixture.setups == 1, "Checking setup count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(fixture.tearDowns == 1, "Checking tearDown count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.passedSuiteCount() == 2, "Checking passed suite count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.passedCount() == 4, "Checking passed test count");
+
+        // the fixture collapses in the second suite and it is restarted
+        CountingFixture collapsing(3);
+        TestResultCollector collector2;
+        runSuites(collapsing, collector2);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collapsing.setups == 2, "Checking setup count after collapsing");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collapsing.tearDowns == 2, "Checking tearDown count after collapsing");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector2.passedSuiteCount() == 1, "Checking passed suite count after collapsing");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector2.testCount() == 4, "Checking test count after collapsing");
+
+        // the fixture can be checked while it is being set up
+        CheckingFixture checking;
+        SharedFixture shared(&checking);
+        FixtureManager* user = shared.share();
+        checking.other = shared.share();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(user->setup(), "Checking setup of the shared fixture");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!checking.checked, "Checking the fixture is not ready during its setup");
+        user->tearDown();
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(MySharedFixture)
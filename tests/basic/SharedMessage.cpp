@@ -0,0 +1,100 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace robottestingframework;
+
+
+class SharedMessage : public TestCase
+{
+public:
+    SharedMessage() :
+            TestCase("SharedMessage")
+    {
+    }
+
+    void run() override
+    {
+        // the copies share the same content
+        TestMessage msg("checks", "value in range", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), 42);
+        TestMessage copy(msg);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(&copy.getDetail() == &msg.getDetail(), "Checking the copies share the content");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(copy.getSourceLineNumber() == 42, "Checking the line number is copied");
+
+        // the file names and the repeated strings are interned
+        TestMessage other("checks", "value in range", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), 43);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(&other.getSourceFileName() == &msg.getSourceFileName(), "Checking the file name is interned");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(&other.getDetail() == &msg.getDetail(), "Checking the detail is interned");
+        std::string name(ROBOTTESTINGFRAMEWORK_SOURCEFILE());
+        TestMessage fromString("checks", "", name, 44);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(&fromString.getSourceFileName() == &msg.getSourceFileName(), "Checking a copied file name is interned");
+
+        // the content is copied on write
+        copy.setDetail("value out of range");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(msg.getDetail() == "value in range", "Checking the original is not modified");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(copy.getDetail() == "value out of range", "Checking the copy is modified");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(copy.getMessage() == "checks" && copy.getSourceLineNumber() == 42, "Checking the other fields are kept");
+
+        // a moved message is left empty
+        TestMessage moved(std::move(copy));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(moved.getDetail() == "value out of range", "Checking the content is moved");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(copy.getDetail().empty() && copy.getSourceLineNumber() == 0, "Checking the moved message is empty");
+        moved.clear();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(moved.getMessage().empty(), "Checking the message is cleared");
+
+        // the long strings are not interned but kept by each message
+        std::string longDetail(1000, 'x');
+        TestMessage first("checks", longDetail, ROBOTTESTINGFRAMEWORK_SOURCEFILE(), 45);
+        TestMessage second("checks", longDetail, ROBOTTESTINGFRAMEWORK_SOURCEFILE(), 46);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(&first.getDetail() != &second.getDetail(), "Checking the long detail is not interned");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(first.getDetail() == longDetail && second.getDetail() == longDetail, "Checking the long detail is kept");
+
+        // the messages can be copied and released by many threads
+        std::vector<std::thread> threads;
+        std::vector<size_t> sizes(4, 0);
+        for (size_t i = 0; i < sizes.size(); i++) {
+            threads.emplace_back([&msg, &sizes, i]() {
+                for (int j = 0; j < 10000; j++) {
+                    TestMessage local(msg);
+                    TestMessage created("checks", std::to_string(j % 10), ROBOTTESTINGFRAMEWORK_SOURCEFILE(), j);
+                    sizes[i] += local.getDetail().size() + created.getDetail().size();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        bool consistent = true;
+        for (size_t size : sizes) {
+            consistent &= (size == 10000 * (msg.getDetail().size() + 1));
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(consistent, "Checking the messages are shared by the threads");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(SharedMessage)
@@ -0,0 +1,163 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResult.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/TextOutputter.h>
+#include <robottestingframework/TextStreamOutputter.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace robottestingframework;
+
+
+class MyTest : public TestCase
+{
+public:
+    MyTest() :
+            TestCase("MyTest")
+    {
+    }
+
+    void run() override
+    {
+    }
+};
+
+
+// writes the names of the finished tests as a list and their number ahead;
+// the trailer gets shorter after the first test
+class ListOutputter : public StreamOutputter
+{
+public:
+    ~ListOutputter() override
+    {
+        close();
+    }
+
+protected:
+    void begin() override
+    {
+        append("count:0\n[", false);
+        countOffset = position() - 3;
+    }
+
+    void handle(ResultEvent::Kind kind,
+                const Test* test,
+                const TestMessage& msg,
+                double elapsed) override
+    {
+        if (kind == ResultEvent::Kind::EndTest) {
+            replace(countOffset, std::to_string(nTests - 1).size(), std::to_string(nTests));
+            append(test->getName() + ",");
+        }
+    }
+
+    std::string trailer() const override
+    {
+        return (nTests == 1) ? "] (one)" : "]";
+    }
+
+private:
+    std::streamoff countOffset;
+};
+
+
+static std::string read(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+
+class StreamOutputterTest : public TestCase
+{
+public:
+    StreamOutputterTest() :
+            TestCase("StreamOutputter")
+    {
+    }
+
+    void run() override
+    {
+        MyTest test;
+        const std::string filename = "stream-outputter-test.txt";
+
+        // the file is a complete document after each record
+        {
+            TestResult result;
+            ListOutputter outputter;
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(outputter.open(filename), "Checking the file is opened");
+            result.addListener(&outputter);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(read(filename) == "count:0\n[]", "Checking the empty document");
+            result.startTest(&test);
+            result.endTest(&test);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(read(filename) == "count:1\n[MyTest,] (one)", "Checking the document after a test");
+            result.startTest(&test);
+            result.endTest(&test);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(read(filename) == "count:2\n[MyTest,MyTest,]", "Checking the document is cut to its size");
+            std::string names = "MyTest,MyTest,";
+            for (int i = 0; i < 8; i++) {
+                result.startTest(&test);
+                result.endTest(&test);
+                names += "MyTest,";
+            }
+            result.endTestRunner();
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(!outputter.isOpen(), "Checking the file is closed");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(read(filename) == "count:10\n[" + names + "]", "Checking the complete document");
+        }
+
+        // the streamed text is the same as the one written from a collector
+        {
+            TestResultCollector collector;
+            TextStreamOutputter outputter(true);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(outputter.open(filename), "Checking the file is opened");
+            TestResult result;
+            result.addListener(&collector);
+            result.addListener(&outputter);
+            result.startTestSuite(&test);
+            result.startTest(&test);
+            result.addReport(&test, TestMessage("report", "detail", ROBOTTESTINGFRAMEWORK_SOURCEFILE(), ROBOTTESTINGFRAMEWORK_SOURCELINE()));
+            result.addFailure(&test, TestMessage("failure"));
+            result.endTest(&test);
+            result.endTestSuite(&test);
+            result.endTestRunner();
+            std::string streamed = read(filename);
+
+            TextOutputter textOutputter(collector, true);
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(textOutputter.write(filename, true), "Checking the collected results are written");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(streamed == read(filename), "Checking the streamed results");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(streamed.find("Total number of test cases   : 1") != std::string::npos, "Checking the summary");
+        }
+
+        std::remove(filename.c_str());
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(!TextStreamOutputter().open(""), "Checking an empty file name is refused");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(StreamOutputterTest)
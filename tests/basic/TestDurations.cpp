@@ -0,0 +1,142 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/TestResultCollector.h>
+#include <robottestingframework/TestRunner.h>
+#include <robottestingframework/TestSuite.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace robottestingframework;
+
+
+static void sleep_ms(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+
+class SlowTest : public TestCase
+{
+public:
+    SlowTest(std::string name) :
+            TestCase(name)
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        sleep_ms(5);
+        return true;
+    }
+
+    void run() override
+    {
+        sleep_ms(10);
+    }
+
+    void tearDown() override
+    {
+        sleep_ms(5);
+    }
+};
+
+
+class TestDurations : public TestCase
+{
+public:
+    TestDurations() :
+            TestCase("TestDurations")
+    {
+    }
+
+    void run() override
+    {
+        TestResultCollector collector;
+        TestResult result;
+        result.addListener(&collector);
+
+        // the events of the tests run by the workers are replayed later
+        SlowTest test1("SlowTest1");
+        SlowTest test2("SlowTest2");
+        test2.setRepetition(1);
+        TestRunner runner;
+        runner.setJobs(2);
+        runner.addTest(&test1);
+        runner.addTest(&test2);
+        runner.run(result);
+
+        const Test::DurationContainer& phases = test2.getDurations();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(phases.size() == 4, "Checking the number of phases");
+        if (phases.size() == 4) {
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(phases[0].first == "setup" && phases[0].second >= 0.005, "Checking the setup duration");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(phases[1].first == "run #1" && phases[1].second >= 0.010, "Checking the first run duration");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(phases[2].first == "run #2" && phases[2].second >= 0.010, "Checking the second run duration");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(phases[3].first == "tearDown" && phases[3].second >= 0.005, "Checking the tearDown duration");
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(test1.getDuration() >= 0.020, "Checking the test duration");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(test2.getDuration() >= 0.030, "Checking the repeated test duration");
+
+        // the events keep the time at which they have been issued
+        double start = 0;
+        bool timed = true;
+        for (auto event : collector.getResults()) {
+            timed &= (event->getTimestamp() > 0);
+            if (dynamic_cast<ResultEventStartTest*>(event) != nullptr) {
+                start = event->getTimestamp();
+            } else if (dynamic_cast<ResultEventEndTest*>(event) != nullptr) {
+                double elapsed = event->getTimestamp() - start;
+                timed &= (elapsed >= event->getTest()->getDuration());
+            }
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(timed, "Checking the event timestamps");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(collector.duration() >= test2.getDuration(), "Checking the collector duration");
+
+        // the fixture phases of a suite
+        TestSuite suite("MySuite");
+        SlowTest test3("SlowTest3");
+        suite.addTest(&test3);
+        TestResult suiteResult;
+        suite.run(suiteResult);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(suite.getDurations().size() == 3, "Checking the number of suite phases");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(suite.getDuration() >= test3.getDuration(), "Checking the suite duration");
+
+        // the latency statistics of a benchmark
+        SlowTest bench("SlowBench");
+        bench.setRepetition(9);
+        bench.setBenchmark(true, 2);
+        TestResult benchResult;
+        bench.TestCase::run(benchResult);
+        Test::StatisticContainer statistics = bench.getStatistics();
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(statistics.size() == 8, "Checking the number of statistics");
+        if (statistics.size() == 8) {
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(statistics[0].first == "iterations" && statistics[0].second == 10, "Checking the number of iterations");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(statistics[1].first == "min" && statistics[1].second >= 0.010, "Checking the minimum latency");
+            ROBOTTESTINGFRAMEWORK_TEST_CHECK(statistics[2].second >= statistics[1].second && statistics[6].second >= statistics[5].second, "Checking the latency ordering");
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(bench.getDurations().size() == 4 && bench.getDurations()[1].first == "warmup", "Checking the benchmark phases");
+    }
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(TestDurations)
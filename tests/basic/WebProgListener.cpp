@@ -25,6 +25,8 @@
 #include <robottestingframework/WebProgressListener.h>
 #include <robottestingframework/dll/Plugin.h>
 
+#include <chrono>
+#include <cstdlib>
 #include <sstream>
 
 #ifndef _WIN32
@@ -46,6 +48,8 @@ public:
     {
     }
 
+    using TestCase::run;
+
     void run() override
     {
         ROBOTTESTINGFRAMEWORK_TEST_CHECK(3 < 5, "smaller");
@@ -66,6 +70,20 @@ public:
     }
 };
 
+class MyTest3 : public TestCase
+{
+public:
+    MyTest3() :
+            TestCase("MyTest3")
+    {
+    }
+
+    void run() override
+    {
+        ROBOTTESTINGFRAMEWORK_ASSERT_ERROR("broken");
+    }
+};
+
 class WebProgListener : public TestCase
 {
 public:
@@ -84,6 +102,7 @@ public:
         // create a test result and add the listeners
         TestResult result;
         result.addListener(&web);
+        web.setTestResult(&result);
 
         // create a test suite and the test cases
         TestSuite suite("MyTestSuite");
@@ -97,7 +116,138 @@ public:
         runner.addTest(&suite);
         runner.run(result);
 
-        // checking the web socket
+        std::string response = get("/status");
+        std::stringstream ssbuff(response);
+        std::string line;
+        while (std::getline(ssbuff, line, '\n')) {
+            if (line.size() && line[0] == '{') {
+                break;
+            }
+        }
+
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(line.size() > 2, "Cheking the json result size returned by web listener");
+        line = line.substr(0, line.find('}') + 1);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(line == "{\"name\":\"MyTestSuite\",\"testStatus\":[3,2]}",
+                                         "Cheking the json result returned by web listener");
+        std::size_t version = header(response, "X-Status-Version");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(header(get("/status"), "X-Status-Version") == version, "Checking that the status version is unchanged");
+
+        // checking the incremental updates
+        response = get("/update?since=0");
+        std::size_t count = header(response, "X-Sequence-Count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(count > 2, "Checking the number of events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(header(response, "X-Next-Sequence") == count, "Checking the next sequence number of all the events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("Starting test runner") != std::string::npos, "Checking the first event");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("Ending test runner") != std::string::npos, "Checking the last event");
+
+        response = get(Asserter::format("/update?since=%zu", count - 1));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(header(response, "X-Next-Sequence") == count, "Checking the next sequence number of the last event");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("Starting test runner") == std::string::npos, "Checking that only the new events are sent");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("Ending test runner") != std::string::npos, "Checking the new event");
+
+        response = get(Asserter::format("/update?since=%zu", count));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(header(response, "X-Next-Sequence") == count, "Checking the next sequence number without new events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("test runner") == std::string::npos, "Checking that no event is sent");
+
+        // checking the event stream
+        int sockfd = request("/events");
+        response = readUntil(sockfd, "\"kind\":\"runnerEnded\"");
+        close(sockfd);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("text/event-stream") != std::string::npos, "Checking the stream content type");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("id: 0\ndata: {\"kind\":\"runnerStarted\"}\n\n") != std::string::npos, "Checking the first streamed event");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("data: {\"kind\":\"failure\",\"test\":\"MyTest2\",\"message\":\"checks\",\"detail\":\"equal\"}") != std::string::npos, "Checking the streamed failure");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find(Asserter::format("id: %zu\n", count - 1)) != std::string::npos, "Checking the last streamed event");
+
+        sockfd = request("/events", Asserter::format("Last-Event-ID: %zu\r\n", count - 2));
+        response = readUntil(sockfd, "\"kind\":\"runnerEnded\"");
+        close(sockfd);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find(Asserter::format("id: %zu\n", count - 2)) == std::string::npos, "Checking that the stream resumes after the last event");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find(Asserter::format("id: %zu\n", count - 1)) != std::string::npos, "Checking the resumed stream");
+
+        // checking that the new events are pushed without waiting for a poll
+        sockfd = request(Asserter::format("/events?since=%zu", count));
+        readUntil(sockfd, "retry:");
+        auto start = std::chrono::steady_clock::now();
+        MyTest3 test3;
+        TestRunner again;
+        again.addTest(&test1);
+        again.addTest(&test3);
+        again.run(result);
+        response = readUntil(sockfd, "\"kind\":\"runnerEnded\"");
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        close(sockfd);
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find(Asserter::format("id: %zu\ndata: {\"kind\":\"runnerStarted\"}", count)) != std::string::npos, "Checking the pushed events");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(elapsed < 500, Asserter::format("Checking the push latency (%d ms)", (int)elapsed));
+
+        // checking the new status snapshot
+        response = get("/status");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(header(response, "X-Status-Version") == version + 4, "Checking the new status version");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("{\"name\":\"MyTestSuite\",\"testStatus\":[3,2,3,2]}") != std::string::npos, "Checking the new status");
+
+        // checking the metrics
+        response = get("/metrics");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("text/plain; version=0.0.4") != std::string::npos, "Checking the metrics content type");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("# TYPE rtf_tests_started_total counter\nrtf_tests_started_total 4\n") != std::string::npos, "Checking the started tests");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_tests_passed_total 2\n") != std::string::npos, "Checking the passed tests");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_tests_failed_total 1\n") != std::string::npos, "Checking the failed tests");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_tests_errored_total 1\n") != std::string::npos, "Checking the errored tests");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_suites_started_total 1\n") != std::string::npos, "Checking the started suites");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_suites_failed_total 1\n") != std::string::npos, "Checking the failed suites");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_messages_total{kind=\"error\"} 1\n") != std::string::npos, "Checking the errors");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_test_duration_seconds_bucket{le=\"+Inf\"} 4\n") != std::string::npos, "Checking the test duration histogram");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_test_duration_seconds_count 4\n") != std::string::npos, "Checking the test duration count");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_phase_duration_seconds_count{phase=\"run\"} 4\n") != std::string::npos, "Checking the phase duration histogram");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_event_queue_depth 0\n") != std::string::npos, "Checking the event queue depth");
+#ifdef __linux__
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nprocess_resident_memory_bytes ") != std::string::npos, "Checking the resident memory");
+#endif
+        web.setTestResult(nullptr);
+
+        // checking the runs of a multi-run dashboard
+        WebProgressListener shard0("shard 0", 6543);
+        WebProgressListener shard1("shard 1", 6543);
+        shard0.setPlan({{"MyTest1", 10}, {"MyTest3", 20}});
+        shard1.setPlan({{"MyTest2", 5}});
+        TestResult result0;
+        TestResult result1;
+        result0.addListener(&shard0);
+        result1.addListener(&shard1);
+        response = get("/status");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\"eta\":5.0}],\"eta\":30.0}") != std::string::npos, "Checking the time left of the planned runs");
+
+        result0.startTestRunner();
+        test1.run(result0);
+        TestRunner runner1;
+        runner1.addTest(&test2);
+        runner1.run(result1);
+        response = get("/status");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find(",\"runs\":[{\"name\":\"shard 0\",\"finished\":false,\"passed\":1,\"failed\":0,\"planned\":2,\"done\":1,\"current\":\"\",\"eta\":20.0},"
+                                                       "{\"name\":\"shard 1\",\"finished\":true,\"passed\":0,\"failed\":1,\"planned\":1,\"done\":1,\"current\":\"\",\"eta\":0.0}],\"eta\":20.0}")
+                                             != std::string::npos,
+                                         "Checking the progress of the runs");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("{\"name\":\"MyTestSuite\",\"testStatus\":[3,2,3,2,3,2],") != std::string::npos, "Checking the merged status");
+        result0.endTestRunner();
+        response = get("/status");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("],\"eta\":0.0}") != std::string::npos, "Checking the time left of the finished runs");
+
+        response = get(Asserter::format("/update?since=%zu", count));
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("[shard 1] ") != std::string::npos, "Checking the tagged events");
+        sockfd = request(Asserter::format("/events?since=%zu", count));
+        response = readUntil(sockfd, "{\"kind\":\"failure\",\"run\":\"shard 1\",\"test\":\"MyTest2\"");
+        close(sockfd);
+
+        // checking that the repetitions of a test share the "run" phase
+        MyTest1 repeated;
+        repeated.setRepetition(20);
+        repeated.run(result);
+        response = get("/metrics");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("phase=\"run #") == std::string::npos, "Checking the repetition phases");
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(response.find("\nrtf_phase_duration_seconds_count{phase=\"other\"} 0\n") != std::string::npos, "Checking the phase slots");
+    }
+
+private:
+    int request(const std::string& path, const std::string& headers = "")
+    {
         struct sockaddr_in serv_addr;
         struct hostent* server;
 
@@ -121,26 +271,47 @@ public:
         ROBOTTESTINGFRAMEWORK_TEST_REPORT("Conneting to the web listener server");
         ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(connect(sockfd, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) >= 0, "connecting");
 
-        char buffer[256] = "GET /status HTTP/1.0\r\n\r\n";
+        std::string request = "GET " + path + " HTTP/1.1\r\n" + headers + "\r\n";
         ROBOTTESTINGFRAMEWORK_TEST_REPORT("Writing to web listener server");
-        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(write(sockfd, buffer, strlen(buffer)) >= 0, "writing to socket");
-        bzero(buffer, 256);
+        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(write(sockfd, request.c_str(), request.size()) >= 0, "writing to socket");
+        return sockfd;
+    }
+
+    std::string get(const std::string& path)
+    {
+        int sockfd = request(path, "Connection: close\r\n");
         ROBOTTESTINGFRAMEWORK_TEST_REPORT("Reading from web listener server");
-        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(read(sockfd, buffer, 255) > 0, "reading from socket");
+        std::string response;
+        char buffer[256];
+        ssize_t size;
+        while ((size = read(sockfd, buffer, sizeof(buffer))) > 0) {
+            response.append(buffer, size);
+        }
+        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(!response.empty(), "reading from socket");
+        close(sockfd);
+        return response;
+    }
 
-        std::stringstream ssbuff(buffer);
-        std::string line;
-        while (std::getline(ssbuff, line, '\n')) {
-            if (line.size() && line[0] == '{') {
-                break;
-            }
+    std::string readUntil(int sockfd, const std::string& text)
+    {
+        std::string response;
+        char buffer[256];
+        ssize_t size;
+        while (response.find(text) == std::string::npos && (size = read(sockfd, buffer, sizeof(buffer))) > 0) {
+            response.append(buffer, size);
         }
+        ROBOTTESTINGFRAMEWORK_ASSERT_FAIL_IF_FALSE(response.find(text) != std::string::npos, "reading " + text + " from socket");
+        return response;
+    }
 
-        ROBOTTESTINGFRAMEWORK_TEST_CHECK(line.size() > 2, "Cheking the json result size returned by web listener");
-        line = line.substr(0, line.size() - 1);
-        ROBOTTESTINGFRAMEWORK_TEST_CHECK(line == "{\"name\":\"MyTestSuite\",\"testStatus\":[3,2]}",
-                                         "Cheking the json result returned by web listener");
-        close(sockfd);
+    static std::size_t header(const std::string& response,
+                              const std::string& name)
+    {
+        std::size_t pos = response.find(name + ": ");
+        if (pos == std::string::npos) {
+            return 0;
+        }
+        return strtoull(response.c_str() + pos + name.size() + 2, nullptr, 10);
     }
 };
 
@@ -30,6 +30,11 @@
 -- robottestingframework.testReport(msg)            : reports a informative message
 -- robottestingframework.testCheck(condition, msg)  : reports the test message and marks the test as failed if condition is false
 -- robottestingframework.testFailIf(condition, msg) : marks the test as failed and reports failure message (the reason) if condition is false
+-- robottestingframework.testCheckArrayNear(actual, expected, abs_tol, rel_tol, msg) : checks that the arrays are close
+-- robottestingframework.testCheckArrayUlp(actual, expected, max_ulps, msg)         : checks the ULP distance of the arrays
+-- robottestingframework.testCheckArrayNorm(values, min_norm, max_norm, msg)        : checks the euclidean norm of the array
+-- robottestingframework.testCheckArrayDistance(actual, expected, max_norm, msg)    : checks the euclidean distance of the arrays
+-- robottestingframework.testCheckArrayFinite(values, msg)                          : checks that all the values are finite
 -- robottestingframework.assertError(msg)           : throws an error exception with message
 -- robottestingframework.asserFail(msg)             : throws a failure exception with message
 -- robottestingframework.getEnvironment()           : returns the test environment params
@@ -52,6 +57,11 @@ TestCase.run = function()
     robottestingframework.testCheck(5>3, "Cheking robottestingframework.testCheck")
     robottestingframework.testReport("Cheking robottestingframework.testFailIf")
     robottestingframework.testFailIf(true, "testFailIf")
+    robottestingframework.testCheckArrayNear({0.1, 0.2, 0.3}, {0.1, 0.2, 0.3001}, 1e-3, 0.0, "Checking robottestingframework.testCheckArrayNear")
+    robottestingframework.testCheckArrayUlp({1.0, 2.0}, {1.0, 2.0}, 1, "Checking robottestingframework.testCheckArrayUlp")
+    robottestingframework.testCheckArrayNorm({3.0, 4.0}, 4.9, 5.1, "Checking robottestingframework.testCheckArrayNorm")
+    robottestingframework.testCheckArrayDistance({3.0, 4.0}, {0.0, 0.0}, 5.0, "Checking robottestingframework.testCheckArrayDistance")
+    robottestingframework.testCheckArrayFinite({0.1, 0.2, 0.3}, "Checking robottestingframework.testCheckArrayFinite")
 end
 
 
@@ -18,6 +18,9 @@
 # License along with this library; if not, write to the Free Software
 # Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
+import array
+import math
+
 import robottestingframework
 
 
@@ -29,6 +32,12 @@ class TestCase:
     def run(self) -> None:
         robottestingframework.testCheck(5>3, "Checking robottestingframework.testCheck")
         robottestingframework.testReport("Checking robottestingframework.testReport")
+        positions = array.array("d", [0.1, 0.2, 0.3])
+        robottestingframework.testCheckArrayNear(positions, [0.1, 0.2, 0.3001], 1e-3, 0.0, "Checking robottestingframework.testCheckArrayNear")
+        robottestingframework.testCheckArrayUlp(array.array("f", [1.0, 2.0]), array.array("f", [1.0, 2.0]), 1, "Checking robottestingframework.testCheckArrayUlp")
+        robottestingframework.testCheckArrayNorm([3.0, 4.0], 4.9, 5.1, "Checking robottestingframework.testCheckArrayNorm")
+        robottestingframework.testCheckArrayDistance(positions, [0.0, 0.0, 0.0], math.sqrt(0.14) + 1e-9, "Checking robottestingframework.testCheckArrayDistance")
+        robottestingframework.testCheckArrayFinite(positions, "Checking robottestingframework.testCheckArrayFinite")
 
     def tearDown(self) -> None:
         pass
@@ -0,0 +1,67 @@
+/*
+ * Robot Testing Framework
+ *
+ * Copyright (C) 2015-2019 Istituto Italiano di Tecnologia (IIT)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#include <robottestingframework/TestAssert.h>
+#include <robottestingframework/dll/Plugin.h>
+
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+using namespace robottestingframework;
+
+
+/**
+ * A test case which crashes when it is run with the "crash" param,
+ * waits until it is interrupted with the "wait" param and never stops
+ * with the "hang" param.
+ */
+class CrashingTest : public TestCase
+{
+public:
+    CrashingTest() :
+            TestCase("CrashingTest"),
+            mode("")
+    {
+    }
+
+    bool setup(int argc, char** argv) override
+    {
+        mode = (argc > 1) ? argv[1] : "";
+        return true;
+    }
+
+    void run() override
+    {
+        if (mode == "crash") {
+            std::raise(SIGSEGV);
+        }
+        while (mode == "hang" || (mode == "wait" && !isInterrupted())) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ROBOTTESTINGFRAMEWORK_TEST_CHECK(true, "the test has not crashed");
+    }
+
+private:
+    std::string mode;
+};
+
+ROBOTTESTINGFRAMEWORK_PREPARE_PLUGIN(CrashingTest)
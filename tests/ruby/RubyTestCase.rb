@@ -39,6 +39,11 @@
 # RobotTestingFramework::setName(name)             : sets the test name (defualt is the test filename)
 # RobotTestingFramework::testReport(msg)           : reports a informative message
 # RobotTestingFramework::testCheck(condition, msg) : reports the test message and marks the test as failed if condition is false
+# RobotTestingFramework::testCheckArrayNear(actual, expected, abs_tol, rel_tol, msg) : checks that the arrays are close
+# RobotTestingFramework::testCheckArrayUlp(actual, expected, max_ulps, msg)         : checks the ULP distance of the arrays
+# RobotTestingFramework::testCheckArrayNorm(values, min_norm, max_norm, msg)        : checks the euclidean norm of the array
+# RobotTestingFramework::testCheckArrayDistance(actual, expected, max_norm, msg)    : checks the euclidean distance of the arrays
+# RobotTestingFramework::testCheckArrayFinite(values, msg)                          : checks that all the values are finite
 # RobotTestingFramework::assertError(msg)          : throws an error exception with message
 # RobotTestingFramework::asserFail(msg)            : throws a failure exception with message
 #
@@ -56,6 +61,11 @@ class TestCase
     def run
         RobotTestingFramework::testCheck(5>3, "Cheking RobotTestingFramework.testCheck")
         RobotTestingFramework.testReport("Cheking RobotTestingFramework.testReport")
+        RobotTestingFramework::testCheckArrayNear([0.1, 0.2, 0.3], [0.1, 0.2, 0.3001], 1e-3, 0.0, "Checking RobotTestingFramework.testCheckArrayNear")
+        RobotTestingFramework::testCheckArrayUlp([1.0, 2.0], [1.0, 2.0], 1, "Checking RobotTestingFramework.testCheckArrayUlp")
+        RobotTestingFramework::testCheckArrayNorm([3.0, 4.0], 4.9, 5.1, "Checking RobotTestingFramework.testCheckArrayNorm")
+        RobotTestingFramework::testCheckArrayDistance([3.0, 4.0], [0.0, 0.0], 5.0, "Checking RobotTestingFramework.testCheckArrayDistance")
+        RobotTestingFramework::testCheckArrayFinite([0.1, 0.2, 0.3], "Checking RobotTestingFramework.testCheckArrayFinite")
         #RobotTestingFramework.testFailIf(, "testFailIf")
     end
 